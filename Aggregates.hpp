@@ -0,0 +1,324 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Parallel.hpp"
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Running totals over a changing collection of figures.
+ *
+ * Keeps the total area, total perimeter and the number of figures of every
+ * type. The area and perimeter of every figure are cached; when a figure
+ * changes it is marked dirty, and commit() recomputes only the dirty figures
+ * and adds the difference to the cached values to the totals. A single change
+ * therefore costs O(1) instead of a pass over the whole collection, and many
+ * changes can be collected and committed at once, recomputing the dirty
+ * figures in parallel.
+ *
+ * The totals are kept with compensated (Neumaier) summation, so millions of
+ * small deltas do not drift away from the true sums.
+ *
+ * Figures are referred to by the proxy id returned from insert(). The
+ * collection keeps pointers to the figures, so they must outlive it. Moving a
+ * figure with setCenter() changes none of the totals and needs no commit.
+ */
+    class FigureAggregates {
+        private:
+            /**
+             * \brief Marks a missing slot or a clean figure.
+             */
+            static constexpr int null = -1;
+
+            /**
+             * \brief Sum of doubles with a running compensation of the rounding error.
+             */
+            struct Sum {
+                double sum = 0;
+                double compensation = 0;
+
+                void add(double x) {
+                    double t = sum + x;
+                    if (std::abs(sum) >= std::abs(x)) {
+                        compensation += (sum - t) + x;
+                    }
+                    else {
+                        compensation += (x - t) + sum;
+                    }
+                    sum = t;
+                }
+
+                double value() const {
+                    return sum + compensation;
+                }
+            };
+
+            /**
+             * \brief One figure with its cached values; free slots are chained through dirty.
+             */
+            struct Slot {
+                Figure *figure;
+                double area;
+                double perimeter;
+                int dirty;
+            };
+
+            /**
+             * \brief All slots.
+             */
+            std::vector<Slot> m_slot;
+
+            /**
+             * \brief Ids of the dirty figures; a dirty slot stores its position here.
+             */
+            std::vector<int> m_dirty;
+
+            /**
+             * \brief First free slot or null.
+             */
+            int m_free = null;
+
+            /**
+             * \brief Number of figures.
+             */
+            std::size_t m_size = 0;
+
+            /**
+             * \brief Total area of all figures as of the last commit.
+             */
+            Sum m_area;
+
+            /**
+             * \brief Total perimeter of all figures as of the last commit.
+             */
+            Sum m_perimeter;
+
+            /**
+             * \brief Number of figures of every type.
+             */
+            std::array<std::size_t, 5> m_count {};
+
+            /**
+             * \brief Precision used to compute the figure values.
+             */
+            Precision m_precision;
+
+            /**
+             * \brief Removes a figure from the dirty list.
+             */
+            void clean(int id) {
+                int position = m_slot[id].dirty;
+                int last = m_dirty.back();
+                m_dirty[position] = last;
+                m_slot[last].dirty = position;
+                m_dirty.pop_back();
+                m_slot[id].dirty = null;
+            }
+
+        public:
+            /**
+             * \brief Creates an empty collection.
+             *
+             * \param precision Precision used to compute areas and perimeters.
+             */
+            FigureAggregates(Precision precision = Precision::Exact) : m_precision(precision) {}
+
+            /**
+             * \brief Adds a figure and its values to the totals.
+             *
+             * \param figure Figure to add.
+             * \return Proxy id of the figure.
+             */
+            int insert(Figure &figure) {
+                int id = m_free;
+                if (id == null) {
+                    m_slot.push_back(Slot {});
+                    id = static_cast<int>(m_slot.size()) - 1;
+                }
+                else {
+                    m_free = m_slot[id].dirty;
+                }
+                Slot &s = m_slot[id];
+                s = {&figure, figure.area(m_precision), figure.perimeter(m_precision), null};
+                m_area.add(s.area);
+                m_perimeter.add(s.perimeter);
+                ++m_count[static_cast<int>(figure.type())];
+                ++m_size;
+                return id;
+            }
+
+            /**
+             * \brief Removes a figure and its values from the totals.
+             *
+             * Pending changes of the figure are dropped with it.
+             *
+             * \param id Proxy id returned by insert().
+             */
+            void remove(int id) {
+                Slot &s = m_slot[id];
+                if (s.dirty != null) {
+                    clean(id);
+                }
+                m_area.add(-s.area);
+                m_perimeter.add(-s.perimeter);
+                --m_count[static_cast<int>(s.figure->type())];
+                --m_size;
+                s.figure = nullptr;
+                s.dirty = m_free;
+                m_free = id;
+            }
+
+            /**
+             * \brief Records that a figure changed.
+             *
+             * Call after changing the size or shape of a figure, for example
+             * with setRadius(), setA(), setB(), setAngle() or setCorners(). The
+             * totals include the change after the next commit().
+             *
+             * \param id Proxy id of the changed figure.
+             */
+            void markDirty(int id) {
+                if (m_slot[id].dirty == null) {
+                    m_slot[id].dirty = static_cast<int>(m_dirty.size());
+                    m_dirty.push_back(id);
+                }
+            }
+
+            /**
+             * \brief Changes a figure and records the change.
+             *
+             * \param id Proxy id of the figure.
+             * \param fn Function called with the figure.
+             */
+            template <typename Fn>
+            void modify(int id, Fn fn) {
+                fn(*m_slot[id].figure);
+                markDirty(id);
+            }
+
+            /**
+             * \brief Applies all recorded changes to the totals.
+             *
+             * The dirty figures are recomputed in parallel; the deltas are then
+             * added in order, so the result does not depend on the thread count.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Number of committed figures.
+             */
+            std::size_t commit(unsigned threads = 0) {
+                const std::size_t n = m_dirty.size();
+                std::vector<double> area(n), perimeter(n);
+                parallelFor(n, 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const Figure &figure = *m_slot[m_dirty[i]].figure;
+                        area[i] = figure.area(m_precision);
+                        perimeter[i] = figure.perimeter(m_precision);
+                    }
+                }, threads);
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    Slot &s = m_slot[m_dirty[i]];
+                    m_area.add(area[i] - s.area);
+                    m_perimeter.add(perimeter[i] - s.perimeter);
+                    s.area = area[i];
+                    s.perimeter = perimeter[i];
+                    s.dirty = null;
+                }
+                m_dirty.clear();
+                return n;
+            }
+
+            /**
+             * \brief Recomputes every figure and the totals from scratch.
+             *
+             * Not needed for correctness; useful after figures were changed
+             * without markDirty().
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             */
+            void recompute(unsigned threads = 0) {
+                for (int id : m_dirty) {
+                    m_slot[id].dirty = null;
+                }
+                m_dirty.clear();
+                parallelFor(m_slot.size(), 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        Slot &s = m_slot[i];
+                        if (s.figure != nullptr) {
+                            s.area = s.figure->area(m_precision);
+                            s.perimeter = s.figure->perimeter(m_precision);
+                        }
+                    }
+                }, threads);
+
+                m_area = Sum {};
+                m_perimeter = Sum {};
+                for (const Slot &s : m_slot) {
+                    if (s.figure != nullptr) {
+                        m_area.add(s.area);
+                        m_perimeter.add(s.perimeter);
+                    }
+                }
+            }
+
+            /**
+             * \brief Returns the total area as of the last commit.
+             *
+             * \return Sum of the areas of all figures.
+             */
+            double totalArea() const {
+                return m_area.value();
+            }
+
+            /**
+             * \brief Returns the total perimeter as of the last commit.
+             *
+             * \return Sum of the perimeters of all figures.
+             */
+            double totalPerimeter() const {
+                return m_perimeter.value();
+            }
+
+            /**
+             * \brief Returns the number of figures of one type.
+             *
+             * \param type Type to count.
+             * \return Number of figures of that type.
+             */
+            std::size_t count(ShapeType type) const {
+                return m_count[static_cast<int>(type)];
+            }
+
+            /**
+             * \brief Returns the number of figures.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_size;
+            }
+
+            /**
+             * \brief Returns the number of changed figures waiting for commit().
+             *
+             * \return Number of dirty figures.
+             */
+            std::size_t dirtyCount() const {
+                return m_dirty.size();
+            }
+
+            /**
+             * \brief Returns a figure by its proxy id.
+             *
+             * \param id Proxy id of the figure.
+             * \return Reference to the figure.
+             */
+            Figure &get(int id) const {
+                return *m_slot[id].figure;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "Geometry.hpp"
+#include "Point.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Axis-aligned rectangle stored as its minimum and maximum corners.
+ *
+ * Most rectangles and squares have sides parallel to the axes, and for those
+ * the two extreme corners are all there is to know: sides, bounds,
+ * containment and overlap are subtractions and comparisons, and recognizing
+ * such corners needs only equality tests, no square roots. The type is a
+ * plain value of four coordinates, so arrays of it take a fraction of the
+ * memory of Rectangle objects.
+ *
+ * \tparam Coord Coordinate type.
+ */
+    template <typename Coord>
+    struct BasicAxisRect {
+        /**
+         * \brief Smallest X coordinate.
+         */
+        Coord minX;
+
+        /**
+         * \brief Smallest Y coordinate.
+         */
+        Coord minY;
+
+        /**
+         * \brief Largest X coordinate.
+         */
+        Coord maxX;
+
+        /**
+         * \brief Largest Y coordinate.
+         */
+        Coord maxY;
+
+        /**
+         * \brief Recognizes four corners of an axis-aligned rectangle.
+         *
+         * The corners may come in any order. Only coordinate comparisons are
+         * used, so the test is exact for every coordinate type.
+         *
+         * \param corners Corner points.
+         * \param out Receives the rectangle if the corners form one.
+         * \return True if the corners are the four distinct corners of an axis-aligned rectangle with positive sides.
+         */
+        static bool fromCorners(const std::array<BasicPoint<Coord>, 4> &corners, BasicAxisRect &out) {
+            BasicAxisRect r {corners[0].getX(), corners[0].getY(), corners[0].getX(), corners[0].getY()};
+            for (const BasicPoint<Coord> &p : corners) {
+                r.minX = std::min(r.minX, p.getX());
+                r.minY = std::min(r.minY, p.getY());
+                r.maxX = std::max(r.maxX, p.getX());
+                r.maxY = std::max(r.maxY, p.getY());
+            }
+            if (!(r.minX < r.maxX && r.minY < r.maxY)) {
+                return false;
+            }
+
+            // Every corner must be one of the four extremes and every extreme must be hit once
+            unsigned seen = 0;
+            for (const BasicPoint<Coord> &p : corners) {
+                bool right = p.getX() == r.maxX, top = p.getY() == r.maxY;
+                if ((!right && p.getX() != r.minX) || (!top && p.getY() != r.minY)) {
+                    return false;
+                }
+                seen |= 1u << (2 * right + top);
+            }
+            if (seen != 15) {
+                return false;
+            }
+            out = r;
+            return true;
+        }
+
+        /**
+         * \brief Returns the side along the X axis.
+         *
+         * \return maxX - minX.
+         */
+        Coord width() const {
+            return maxX - minX;
+        }
+
+        /**
+         * \brief Returns the side along the Y axis.
+         *
+         * \return maxY - minY.
+         */
+        Coord height() const {
+            return maxY - minY;
+        }
+
+        /**
+         * \brief Calculates the area of the rectangle.
+         *
+         * \return The area of the rectangle.
+         */
+        double area() const {
+            return double(width()) * double(height());
+        }
+
+        /**
+         * \brief Calculates the perimeter of the rectangle.
+         *
+         * \return The perimeter of the rectangle.
+         */
+        double perimeter() const {
+            return 2 * (double(width()) + double(height()));
+        }
+
+        /**
+         * \brief Checks whether a point lies inside the rectangle.
+         *
+         * \param p Point to test.
+         * \return True if the point is inside or on the border.
+         */
+        bool contains(const BasicPoint<Coord> &p) const {
+            return p.getX() >= minX && p.getX() <= maxX && p.getY() >= minY && p.getY() <= maxY;
+        }
+
+        /**
+         * \brief Checks whether another rectangle lies completely inside this one.
+         *
+         * \param other Rectangle to test.
+         * \return True if the other rectangle is inside or on the border.
+         */
+        bool contains(const BasicAxisRect &other) const {
+            return other.minX >= minX && other.maxX <= maxX && other.minY >= minY && other.maxY <= maxY;
+        }
+
+        /**
+         * \brief Checks whether two rectangles share at least one point.
+         *
+         * \param other Rectangle to test against.
+         * \return True if the rectangles overlap or touch.
+         */
+        bool overlaps(const BasicAxisRect &other) const {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+
+        /**
+         * \brief Returns the rectangle as a bounding box.
+         *
+         * \return The same rectangle in double coordinates.
+         */
+        BoundingBox bounds() const {
+            return {double(minX), double(minY), double(maxX), double(maxY)};
+        }
+
+        /**
+         * \brief Returns the outline of the rectangle.
+         *
+         * The vertices are already in counter-clockwise order, so no sorting is needed.
+         *
+         * \return Polygon outline starting at the minimum corner.
+         */
+        Outline outline() const {
+            Outline o;
+            o.size = 4;
+            o.vertex = {Vec2{double(minX), double(minY)}, Vec2{double(maxX), double(minY)},
+                        Vec2{double(maxX), double(maxY)}, Vec2{double(minX), double(maxY)}};
+            o.center = {(double(minX) + double(maxX)) / 2, (double(minY) + double(maxY)) / 2};
+            return o;
+        }
+    };
+
+/**
+ * \brief Axis-aligned rectangle with integer corners, matching Rectangle.
+ */
+    using AxisRect = BasicAxisRect<int>;
+
+/**
+ * \brief Axis-aligned rectangle with float corners, matching RectangleF.
+ */
+    using AxisRectF = BasicAxisRect<float>;
+
+/**
+ * \brief Axis-aligned rectangles stored as separate coordinate arrays.
+ *
+ * The structure-of-arrays layout lets the batch kernels run over contiguous
+ * integers, which compilers turn into SIMD loops.
+ */
+    struct AxisRectBlock {
+        /**
+         * \brief Smallest X coordinates.
+         */
+        std::vector<int> minX;
+
+        /**
+         * \brief Smallest Y coordinates.
+         */
+        std::vector<int> minY;
+
+        /**
+         * \brief Largest X coordinates.
+         */
+        std::vector<int> maxX;
+
+        /**
+         * \brief Largest Y coordinates.
+         */
+        std::vector<int> maxY;
+
+        /**
+         * \brief Creates an empty block.
+         */
+        AxisRectBlock() = default;
+
+        /**
+         * \brief Creates a block from rectangles.
+         *
+         * \param rects Rectangles to copy.
+         */
+        AxisRectBlock(const std::vector<AxisRect> &rects) {
+            reserve(rects.size());
+            for (const AxisRect &r : rects) {
+                add(r);
+            }
+        }
+
+        /**
+         * \brief Reserves room for rectangles.
+         *
+         * \param n Number of rectangles.
+         */
+        void reserve(std::size_t n) {
+            minX.reserve(n);
+            minY.reserve(n);
+            maxX.reserve(n);
+            maxY.reserve(n);
+        }
+
+        /**
+         * \brief Appends a rectangle.
+         *
+         * \param r Rectangle to append.
+         */
+        void add(const AxisRect &r) {
+            minX.push_back(r.minX);
+            minY.push_back(r.minY);
+            maxX.push_back(r.maxX);
+            maxY.push_back(r.maxY);
+        }
+
+        /**
+         * \brief Returns the number of rectangles.
+         *
+         * \return Number of rectangles.
+         */
+        std::size_t size() const {
+            return minX.size();
+        }
+    };
+
+/**
+ * \brief Tests which rectangles of a range contain a point.
+ *
+ * Uses only integer comparisons and has no branches in the loop, so it is
+ * vectorized by the compiler.
+ *
+ * \param block Rectangles to test.
+ * \param begin First rectangle of the range.
+ * \param end One past the last rectangle of the range.
+ * \param x X coordinate of the point.
+ * \param y Y coordinate of the point.
+ * \param out Receives 1 for every containing rectangle and 0 otherwise, end - begin values.
+ */
+    inline void containing(const AxisRectBlock &block, std::size_t begin, std::size_t end,
+                           int x, int y, std::uint8_t *out) {
+        const int *__restrict x0 = block.minX.data();
+        const int *__restrict y0 = block.minY.data();
+        const int *__restrict x1 = block.maxX.data();
+        const int *__restrict y1 = block.maxY.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i - begin] = (x0[i] <= x) & (x <= x1[i]) & (y0[i] <= y) & (y <= y1[i]);
+        }
+    }
+
+/**
+ * \brief Tests which rectangles of a range overlap a window.
+ *
+ * \param block Rectangles to test.
+ * \param begin First rectangle of the range.
+ * \param end One past the last rectangle of the range.
+ * \param window Window to test against.
+ * \param out Receives 1 for every rectangle sharing a point with the window and 0 otherwise, end - begin values.
+ */
+    inline void overlapping(const AxisRectBlock &block, std::size_t begin, std::size_t end,
+                            const AxisRect &window, std::uint8_t *out) {
+        const int *__restrict x0 = block.minX.data();
+        const int *__restrict y0 = block.minY.data();
+        const int *__restrict x1 = block.maxX.data();
+        const int *__restrict y1 = block.maxY.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i - begin] = (x0[i] <= window.maxX) & (window.minX <= x1[i]) & (y0[i] <= window.maxY) & (window.minY <= y1[i]);
+        }
+    }
+
+/**
+ * \brief Sums the areas of a range of rectangles exactly.
+ *
+ * \param block Rectangles to sum.
+ * \param begin First rectangle of the range.
+ * \param end One past the last rectangle of the range.
+ * \return Total area; exact while it fits into 64 bits.
+ */
+    inline std::int64_t area(const AxisRectBlock &block, std::size_t begin, std::size_t end) {
+        const int *__restrict x0 = block.minX.data();
+        const int *__restrict y0 = block.minY.data();
+        const int *__restrict x1 = block.maxX.data();
+        const int *__restrict y1 = block.maxY.data();
+        std::int64_t sum = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            sum += std::int64_t(x1[i] - x0[i]) * (y1[i] - y0[i]);
+        }
+        return sum;
+    }
+
+/**
+ * \brief Tests which rectangles of a block contain a point.
+ *
+ * \param block Rectangles to test.
+ * \param p Query point.
+ * \return 1 for every rectangle of the block containing p and 0 otherwise.
+ */
+    inline std::vector<std::uint8_t> containing(const AxisRectBlock &block, const Point &p) {
+        std::vector<std::uint8_t> out(block.size());
+        containing(block, 0, block.size(), p.getX(), p.getY(), out.data());
+        return out;
+    }
+
+/**
+ * \brief Tests which rectangles of a block overlap a window.
+ *
+ * \param block Rectangles to test.
+ * \param window Window to test against.
+ * \return 1 for every rectangle of the block sharing a point with the window and 0 otherwise.
+ */
+    inline std::vector<std::uint8_t> overlapping(const AxisRectBlock &block, const AxisRect &window) {
+        std::vector<std::uint8_t> out(block.size());
+        overlapping(block, 0, block.size(), window, out.data());
+        return out;
+    }
+
+} // namespace mw
\ No newline at end of file
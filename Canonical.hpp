@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace mw{
+
+/**
+ * \brief Order-independent description of a figure's geometry.
+ *
+ * Two figures have equal canonical forms if they are of the same type and
+ * cover exactly the same region, no matter in which order their corners were
+ * given or whether they were built from corners or from side lengths. Circles
+ * are described by center and radius, polygons by their vertices sorted
+ * lexicographically.
+ */
+    struct CanonicalForm {
+        /**
+         * \brief Type of the figure.
+         */
+        ShapeType type = ShapeType::Circle;
+
+        /**
+         * \brief Number of used entries in value.
+         */
+        int size = 0;
+
+        /**
+         * \brief Normalized parameters (cx, cy, r for circles, x0, y0, x1, y1, ... for polygons).
+         */
+        std::array<double, 8> value {};
+
+        /**
+         * \brief Compares two canonical forms.
+         *
+         * \param other Form to compare with.
+         * \return True if both describe the same figure.
+         */
+        bool operator==(const CanonicalForm &other) const {
+            if (type != other.type || size != other.size) {
+                return false;
+            }
+            for (int i = 0; i < size; ++i) {
+                if (value[i] != other.value[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * \brief Compares two canonical forms.
+         *
+         * \param other Form to compare with.
+         * \return True if the forms describe different figures.
+         */
+        bool operator!=(const CanonicalForm &other) const {
+            return !(*this == other);
+        }
+
+        /**
+         * \brief Returns a 64-bit hash of the form.
+         *
+         * \return Hash value; equal forms have equal hashes.
+         */
+        std::uint64_t hash() const {
+            std::uint64_t h = 0x9e3779b97f4a7c15ULL * (static_cast<std::uint64_t>(type) + 1);
+            for (int i = 0; i < size; ++i) {
+                std::uint64_t bits;
+                std::memcpy(&bits, &value[i], sizeof bits);
+                h ^= bits + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
+/**
+ * \brief Computes the canonical form of a figure.
+ *
+ * \param figure Figure to describe.
+ * \return Canonical form of the figure.
+ */
+    inline CanonicalForm canonical(const Figure &figure) {
+        CanonicalForm form;
+        form.type = figure.type();
+        Outline o = figure.outline();
+
+        if (o.isCircle) {
+            form.size = 3;
+            form.value = {o.center.x, o.center.y, o.radius};
+        }
+        else {
+            // At most four vertices: an insertion sort, so no code path indexes past the outline
+            int size = std::min(o.size, 4);
+            for (int i = 1; i < size; ++i) {
+                Vec2 v = o.vertex[i];
+                int j = i;
+                for (; j > 0 && (v.x < o.vertex[j - 1].x || (v.x == o.vertex[j - 1].x && v.y < o.vertex[j - 1].y)); --j) {
+                    o.vertex[j] = o.vertex[j - 1];
+                }
+                o.vertex[j] = v;
+            }
+            form.size = 2 * size;
+            for (int i = 0; i < size; ++i) {
+                form.value[2 * i] = o.vertex[i].x;
+                form.value[2 * i + 1] = o.vertex[i].y;
+            }
+        }
+
+        // -0.0 and 0.0 compare equal but hash differently
+        for (int i = 0; i < form.size; ++i) {
+            form.value[i] += 0.0;
+        }
+        return form;
+    }
+
+} // namespace mw
+
+namespace std{
+
+/**
+ * \brief Hash function for CanonicalForm, so forms can be used in unordered containers.
+ */
+    template <>
+    struct hash<mw::CanonicalForm> {
+        size_t operator()(const mw::CanonicalForm &form) const {
+            return static_cast<size_t>(form.hash());
+        }
+    };
+
+} // namespace std
\ No newline at end of file
@@ -11,17 +11,27 @@ namespace mw{
  * This class models a geometric circle defined by its center point and radius.
  * It provides methods to compute the circle's area and perimeter, as well as
  * accessors and mutators for the radius.
+ *
+ * \tparam Coord Coordinate type of the center point.
+ * \tparam Scalar Type of the radius and computed values.
  */ 
-    class Circle : public Figure {
+    template <typename Coord, typename Scalar>
+    class BasicCircle : public BasicFigure<Coord, Scalar> {
         private:
             /**
              * \brief The radius of the circle.
              *
              * Stores the radius value of the circle. The radius must be non-negative.
              */
-            double m_radius;
+            Scalar m_radius;
         
         public:
+            /**
+             * \brief Makes the precision overloads of area() and perimeter() visible.
+             */
+            using BasicFigure<Coord, Scalar>::area;
+            using BasicFigure<Coord, Scalar>::perimeter;
+
             /**
              * \brief Creates a new Circle with a given radius and center.
              *
@@ -31,7 +41,7 @@ namespace mw{
              * \param r Radius of the circle.
              * \param center Center point of the circle.
              */
-            Circle(double r, const Point &center): m_radius(r), Figure(center, "Circle"){
+            BasicCircle(Scalar r, const BasicPoint<Coord> &center): m_radius(r), BasicFigure<Coord, Scalar>(center, "Circle"){
                 setRadius(r);
             }
 
@@ -40,14 +50,14 @@ namespace mw{
              *
              * Creates a circle with default-initialized values.
              */
-            Circle() = default;
+            BasicCircle() = default;
 
             /**
              * \brief Destructor.
              *
              * Default destructor for the Circle class.
              */
-            ~Circle() = default;
+            ~BasicCircle() = default;
 
             /**
              * \brief Calculates the area of the circle.
@@ -56,8 +66,8 @@ namespace mw{
              *
              * \return The area of the circle.
              */
-            double area() const override{
-                return M_PI * m_radius * m_radius;
+            Scalar area() const override{
+                return Scalar(M_PI) * m_radius * m_radius;
             }
 
             /**
@@ -67,8 +77,26 @@ namespace mw{
              *
              * \return The perimeter (circumference) of the circle.
              */
-            double perimeter() const override{
-                return 2 * M_PI * m_radius;
+            Scalar perimeter() const override{
+                return 2 * Scalar(M_PI) * m_radius;
+            }
+
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return ShapeType::Circle.
+             */
+            ShapeType type() const override{
+                return ShapeType::Circle;
+            }
+
+            /**
+             * \brief Returns the outline of the circle.
+             *
+             * \return Circular outline with the circle's center and radius.
+             */
+            Outline outline() const override{
+                return Outline::circle({double(this->getCenter().getX()), double(this->getCenter().getY())}, m_radius);
             }
 
             /**
@@ -80,7 +108,7 @@ namespace mw{
              *
              * \throws const char* If the radius is less than zero.
              */
-            void setRadius(const double &r){
+            void setRadius(const Scalar &r){
                 if (r < 0) {
                     throw "Radius cannot be less than 0";
                 }
@@ -92,9 +120,19 @@ namespace mw{
              *
              * \return The current radius of the circle.
              */
-            double getRadius() const {
+            Scalar getRadius() const {
                 return m_radius;
             }
 
     };
+
+/**
+ * \brief Circle with integer center and double radius, the default used across the library.
+ */
+    using Circle = BasicCircle<int, double>;
+
+/**
+ * \brief Circle with float center and radius for bulk work.
+ */
+    using CircleF = BasicCircle<float, float>;
 }// namespace mw
\ No newline at end of file
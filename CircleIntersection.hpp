@@ -0,0 +1,297 @@
+#pragma once
+
+#include "Circle.hpp"
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Checks whether two circles touch or overlap.
+ *
+ * \param a First circle.
+ * \param b Second circle.
+ * \return True if the circles share at least one point.
+ */
+    inline bool intersects(const Circle &a, const Circle &b) {
+        double dx = a.getCenter().getX() - b.getCenter().getX();
+        double dy = a.getCenter().getY() - b.getCenter().getY();
+        double r = a.getRadius() + b.getRadius();
+        return dx * dx + dy * dy <= r * r;
+    }
+
+/**
+ * \brief Checks whether a circle lies completely inside another circle.
+ *
+ * \param outer Containing circle.
+ * \param inner Contained circle.
+ * \return True if every point of inner is inside outer.
+ */
+    inline bool contains(const Circle &outer, const Circle &inner) {
+        double dx = outer.getCenter().getX() - inner.getCenter().getX();
+        double dy = outer.getCenter().getY() - inner.getCenter().getY();
+        double r = outer.getRadius() - inner.getRadius();
+        return r >= 0 && dx * dx + dy * dy <= r * r;
+    }
+
+/**
+ * \brief Checks whether a circle touches or overlaps any figure.
+ *
+ * \param circle Circle to test.
+ * \param figure Figure to test against.
+ * \return True if the circle and the figure share at least one point.
+ */
+    inline bool intersects(const Circle &circle, const Figure &figure) {
+        Outline o = figure.outline();
+        Vec2 c {double(circle.getCenter().getX()), double(circle.getCenter().getY())};
+        return o.distanceTo(c) <= circle.getRadius();
+    }
+
+/**
+ * \brief Checks whether a figure lies completely inside a circle.
+ *
+ * \param circle Containing circle.
+ * \param figure Contained figure.
+ * \return True if every point of the figure is inside the circle.
+ */
+    inline bool contains(const Circle &circle, const Figure &figure) {
+        Vec2 c {double(circle.getCenter().getX()), double(circle.getCenter().getY())};
+        return figure.outline().extentFrom(c) <= circle.getRadius();
+    }
+
+/**
+ * \brief Checks whether a circle lies completely inside a figure.
+ *
+ * \param figure Containing figure.
+ * \param circle Contained circle.
+ * \return True if every point of the circle is inside the figure.
+ */
+    inline bool contains(const Figure &figure, const Circle &circle) {
+        Outline o = figure.outline();
+        Vec2 c {double(circle.getCenter().getX()), double(circle.getCenter().getY())};
+        double r = circle.getRadius();
+        if (o.isCircle) {
+            double d = std::sqrt(Outline::squaredDistance(o.center, c));
+            return d + r <= o.radius;
+        }
+        if (!o.contains(c)) {
+            return false;
+        }
+        for (int i = 0; i < o.size; ++i) {
+            if (Outline::segmentSquaredDistance(c, o.vertex[i], o.vertex[(i + 1) % o.size]) < r * r) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+/**
+ * \brief Circles stored as separate coordinate and radius arrays.
+ *
+ * The structure-of-arrays layout lets the batch kernels run over contiguous
+ * doubles, which compilers turn into SIMD loops.
+ */
+    struct CircleBlock {
+        /**
+         * \brief X coordinates of the centers.
+         */
+        std::vector<double> x;
+
+        /**
+         * \brief Y coordinates of the centers.
+         */
+        std::vector<double> y;
+
+        /**
+         * \brief Radii.
+         */
+        std::vector<double> r;
+
+        /**
+         * \brief Creates an empty block.
+         */
+        CircleBlock() = default;
+
+        /**
+         * \brief Creates a block from circles.
+         *
+         * \param circles Circles to copy.
+         */
+        CircleBlock(const std::vector<Circle> &circles) {
+            reserve(circles.size());
+            for (const Circle &c : circles) {
+                add(c);
+            }
+        }
+
+        /**
+         * \brief Reserves room for circles.
+         *
+         * \param n Number of circles.
+         */
+        void reserve(std::size_t n) {
+            x.reserve(n);
+            y.reserve(n);
+            r.reserve(n);
+        }
+
+        /**
+         * \brief Appends a circle.
+         *
+         * \param c Circle to append.
+         */
+        void add(const Circle &c) {
+            x.push_back(c.getCenter().getX());
+            y.push_back(c.getCenter().getY());
+            r.push_back(c.getRadius());
+        }
+
+        /**
+         * \brief Returns the number of circles.
+         *
+         * \return Number of circles.
+         */
+        std::size_t size() const {
+            return r.size();
+        }
+    };
+
+/**
+ * \brief Tests one circle against a range of circles in a block.
+ *
+ * Uses squared distances only and has no branches in the loop, so it is
+ * vectorized by the compiler.
+ *
+ * \param block Circles to test against.
+ * \param begin First circle of the range.
+ * \param end One past the last circle of the range.
+ * \param cx X coordinate of the query circle.
+ * \param cy Y coordinate of the query circle.
+ * \param cr Radius of the query circle.
+ * \param out Receives 1 for every touching circle and 0 otherwise, end - begin values.
+ */
+    inline void touching(const CircleBlock &block, std::size_t begin, std::size_t end,
+                         double cx, double cy, double cr, std::uint8_t *out) {
+        const double *__restrict x = block.x.data();
+        const double *__restrict y = block.y.data();
+        const double *__restrict r = block.r.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            double dx = x[i] - cx;
+            double dy = y[i] - cy;
+            double s = r[i] + cr;
+            out[i - begin] = dx * dx + dy * dy <= s * s;
+        }
+    }
+
+/**
+ * \brief Tests one circle against every circle in a block.
+ *
+ * \param block Circles to test against.
+ * \param c Query circle.
+ * \return 1 for every circle of the block touching c and 0 otherwise.
+ */
+    inline std::vector<std::uint8_t> touching(const CircleBlock &block, const Circle &c) {
+        std::vector<std::uint8_t> out(block.size());
+        touching(block, 0, block.size(), c.getCenter().getX(), c.getCenter().getY(), c.getRadius(), out.data());
+        return out;
+    }
+
+/**
+ * \brief Finds all pairs of touching circles.
+ *
+ * Circles are sorted into a uniform grid whose cell size is the largest
+ * diameter, so touching circles are always in the same or adjacent cells.
+ * Cells are ordered row by row, so the cells a circle has to check (rest of
+ * its own row segment and three cells of the next row) are two contiguous
+ * ranges of a sorted CircleBlock, which are tested with the batch kernel.
+ * Circles are processed in parallel.
+ *
+ * \param circles Circles to test.
+ * \param threads Number of threads, 0 means one per hardware thread.
+ * \return Index pairs (i, j) with i < j of all touching circles, sorted.
+ */
+    inline std::vector<std::pair<std::size_t, std::size_t>> touchingPairs(const CircleBlock &circles, unsigned threads = 0) {
+        const std::size_t n = circles.size();
+        std::vector<std::pair<std::size_t, std::size_t>> pairs;
+        if (n < 2) {
+            return pairs;
+        }
+
+        double cell = 0;
+        for (double r : circles.r) {
+            cell = std::max(cell, 2 * r);
+        }
+        if (cell == 0) {
+            cell = 1;
+        }
+
+        // Row-major cell key; the offset keeps negative cells in order
+        auto cellKey = [](std::int64_t cx, std::int64_t cy) {
+            return (static_cast<std::uint64_t>(cy + 0x80000000LL) << 32) | static_cast<std::uint64_t>(cx + 0x80000000LL);
+        };
+        std::vector<std::pair<std::uint64_t, std::size_t>> order(n);
+        parallelFor(n, 16384, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                std::int64_t cx = static_cast<std::int64_t>(std::floor(circles.x[i] / cell));
+                std::int64_t cy = static_cast<std::int64_t>(std::floor(circles.y[i] / cell));
+                order[i] = {cellKey(cx, cy), i};
+            }
+        }, threads);
+        std::sort(order.begin(), order.end());
+
+        CircleBlock sorted;
+        sorted.reserve(n);
+        std::vector<std::uint64_t> key(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t c = order[i].second;
+            key[i] = order[i].first;
+            sorted.x.push_back(circles.x[c]);
+            sorted.y.push_back(circles.y[c]);
+            sorted.r.push_back(circles.r[c]);
+        }
+
+        std::vector<std::vector<std::pair<std::size_t, std::size_t>>> found((n + 4095) / 4096);
+        parallelFor(n, 4096, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::pair<std::size_t, std::size_t>> &local = found[begin / 4096];
+            std::vector<std::uint8_t> hit;
+            auto test = [&](std::size_t i, std::size_t from, std::size_t to) {
+                if (from >= to) {
+                    return;
+                }
+                hit.resize(to - from);
+                touching(sorted, from, to, sorted.x[i], sorted.y[i], sorted.r[i], hit.data());
+                for (std::size_t j = from; j < to; ++j) {
+                    if (hit[j - from]) {
+                        std::size_t a = order[i].second, b = order[j].second;
+                        local.emplace_back(std::min(a, b), std::max(a, b));
+                    }
+                }
+            };
+
+            for (std::size_t i = begin; i < end; ++i) {
+                // Pairs with earlier cells of the row or with the previous row are found from the other circle
+                std::uint64_t k = key[i];
+                std::size_t rowEnd = std::upper_bound(key.begin() + i, key.end(), k + 1) - key.begin();
+                test(i, i + 1, rowEnd);
+
+                std::uint64_t below = k + (1ULL << 32);
+                std::size_t from = std::lower_bound(key.begin() + rowEnd, key.end(), below - 1) - key.begin();
+                std::size_t to = std::upper_bound(key.begin() + from, key.end(), below + 1) - key.begin();
+                test(i, from, to);
+            }
+        }, threads);
+
+        for (const auto &local : found) {
+            pairs.insert(pairs.end(), local.begin(), local.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+} // namespace mw
\ No newline at end of file
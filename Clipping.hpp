@@ -0,0 +1,318 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Convex polygon produced by clipping.
+ *
+ * Clipping a convex polygon of at most four vertices against a convex window
+ * of at most four edges adds at most one vertex per window edge. Rounding can
+ * make an intermediate polygon slightly non-convex, and outlines passed in
+ * directly need not be convex at all; then one window edge turns n vertices
+ * into at most 3n / 2 (every vertex inside plus two crossings per run of
+ * inside vertices), so four edges give at most 4, 6, 9, 13, 19 vertices.
+ * The buffer holds that worst case and the result still lives on the stack.
+ */
+    struct ClippedPolygon {
+        /**
+         * \brief Number of vertices, 0 if the intersection is empty.
+         */
+        int size = 0;
+
+        /**
+         * \brief Vertices in counter-clockwise order.
+         */
+        std::array<Vec2, 19> vertex {};
+
+        /**
+         * \brief Calculates the area of the polygon.
+         *
+         * \return The area of the polygon.
+         */
+        double area() const {
+            double sum = 0;
+            for (int i = 0; i < size; ++i) {
+                const Vec2 &a = vertex[i];
+                const Vec2 &b = vertex[(i + 1) % size];
+                sum += a.x * b.y - a.y * b.x;
+            }
+            return std::abs(sum) / 2;
+        }
+    };
+
+/**
+ * \brief Convex clipping and intersection areas of polygonal figures.
+ *
+ * Single shapes are clipped with the Sutherland-Hodgman algorithm and give
+ * the clipped polygon. Batch area queries against one axis-aligned window use
+ * a separate kernel that needs no polygon at all: by Green's theorem the area
+ * of the intersection is the sum of cross(p, q) / 2 over its boundary, which
+ * consists of the parts of the shape's edges inside the window and the parts
+ * of the window's edges inside the shape. Both are found by clipping single
+ * segments to parameter intervals (Liang-Barsky and Cyrus-Beck), which is
+ * only min/max arithmetic. The shapes are stored as vertex columns and the
+ * kernel has no branches, so the compiler vectorizes it across shapes.
+ * Circles are not polygons and are rejected.
+ */
+    class Clipping {
+        private:
+            /**
+             * \brief Returns the outline of a figure, rejecting circles.
+             */
+            static Outline polygonOf(const Figure &figure) {
+                Outline o = figure.outline();
+                if (o.isCircle) {
+                    throw "Cannot clip a circle";
+                }
+                return o;
+            }
+
+            /**
+             * \brief Intersection of the segment a-b with the line through the window edge p-q.
+             */
+            static Vec2 intersection(const Vec2 &a, const Vec2 &b, const Vec2 &p, const Vec2 &q) {
+                double da = Outline::cross(p, q, a);
+                double db = Outline::cross(p, q, b);
+                double t = da / (da - db);
+                return {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)};
+            }
+
+            /**
+             * \brief Shapes stored as vertex columns, translated to the window center.
+             *
+             * Triangles repeat their last vertex, which adds an edge of length zero.
+             */
+            struct Columns {
+                std::vector<double> x[4];
+                std::vector<double> y[4];
+            };
+
+            /**
+             * \brief Computes intersection areas of shapes [begin, end) with the window [-hw, hw] x [-hh, hh].
+             */
+            static void areaKernel(const Columns &c, std::size_t begin, std::size_t end,
+                                   double hw, double hh, double *out) {
+                const double *__restrict x0 = c.x[0].data();
+                const double *__restrict x1 = c.x[1].data();
+                const double *__restrict x2 = c.x[2].data();
+                const double *__restrict x3 = c.x[3].data();
+                const double *__restrict y0 = c.y[0].data();
+                const double *__restrict y1 = c.y[1].data();
+                const double *__restrict y2 = c.y[2].data();
+                const double *__restrict y3 = c.y[3].data();
+                const double wx[4] = {-hw, hw, hw, -hw};
+                const double wy[4] = {-hh, -hh, hh, hh};
+
+                for (std::size_t i = begin; i < end; ++i) {
+                    const double px[4] = {x0[i], x1[i], x2[i], x3[i]};
+                    const double py[4] = {y0[i], y1[i], y2[i], y3[i]};
+                    double sum = 0;
+
+                    // Shape edges clipped to the closed window. An edge lying on a
+                    // window edge counts only if both interiors are on the same side.
+                    for (int k = 0; k < 4; ++k) {
+                        double ax = px[k], ay = py[k];
+                        double dx = px[(k + 1) & 3] - ax, dy = py[(k + 1) & 3] - ay;
+                        double num[4] = {ax + hw, hw - ax, ay + hh, hh - ay};
+                        double den[4] = {dx, -dx, dy, -dy};
+                        bool tie[4] = {dy < 0, dy > 0, dx > 0, dx < 0};
+                        double lo = 0, hi = 1;
+                        bool ok = true;
+                        for (int j = 0; j < 4; ++j) {
+                            double r = -num[j] / (den[j] == 0 ? 1.0 : den[j]);
+                            lo = den[j] > 0 ? std::max(lo, r) : lo;
+                            hi = den[j] < 0 ? std::min(hi, r) : hi;
+                            ok &= (den[j] != 0) | (num[j] > 0) | ((num[j] == 0) & tie[j]);
+                        }
+                        double span = ok ? std::max(0.0, hi - lo) : 0.0;
+                        sum += span * (ax * dy - ay * dx);
+                    }
+
+                    // Window edges clipped to the open interior of the shape
+                    for (int k = 0; k < 4; ++k) {
+                        double ax = wx[k], ay = wy[k];
+                        double dx = wx[(k + 1) & 3] - ax, dy = wy[(k + 1) & 3] - ay;
+                        double lo = 0, hi = 1;
+                        bool ok = true;
+                        for (int j = 0; j < 4; ++j) {
+                            double ex = px[(j + 1) & 3] - px[j], ey = py[(j + 1) & 3] - py[j];
+                            double num = ex * (ay - py[j]) - ey * (ax - px[j]);
+                            double den = ex * dy - ey * dx;
+                            double r = -num / (den == 0 ? 1.0 : den);
+                            lo = den > 0 ? std::max(lo, r) : lo;
+                            hi = den < 0 ? std::min(hi, r) : hi;
+                            ok &= (den != 0) | (num > 0) | ((ex == 0) & (ey == 0));
+                        }
+                        double span = ok ? std::max(0.0, hi - lo) : 0.0;
+                        sum += span * (ax * dy - ay * dx);
+                    }
+                    out[i] = std::max(0.0, sum / 2);
+                }
+            }
+
+        public:
+            /**
+             * \brief Clips a convex polygon against a convex window.
+             *
+             * \param subject Polygon to clip.
+             * \param window Convex window.
+             * \return Part of subject inside window.
+             *
+             * \throws const char* If either outline is a circle.
+             */
+            static ClippedPolygon clip(const Outline &subject, const Outline &window) {
+                if (subject.isCircle || window.isCircle) {
+                    throw "Cannot clip a circle";
+                }
+                ClippedPolygon out;
+                out.size = subject.size;
+                for (int i = 0; i < subject.size; ++i) {
+                    out.vertex[i] = subject.vertex[i];
+                }
+
+                for (int e = 0; e < window.size && out.size > 0; ++e) {
+                    const Vec2 &p = window.vertex[e];
+                    const Vec2 &q = window.vertex[(e + 1) % window.size];
+                    ClippedPolygon in = out;
+                    out.size = 0;
+                    for (int i = 0; i < in.size; ++i) {
+                        const Vec2 &a = in.vertex[i];
+                        const Vec2 &b = in.vertex[(i + 1) % in.size];
+                        bool aIn = Outline::cross(p, q, a) >= 0;
+                        bool bIn = Outline::cross(p, q, b) >= 0;
+                        if (aIn) {
+                            out.vertex[out.size++] = a;
+                        }
+                        if (aIn != bIn) {
+                            out.vertex[out.size++] = intersection(a, b, p, q);
+                        }
+                    }
+                }
+                return out;
+            }
+
+            /**
+             * \brief Clips a figure against an axis-aligned window.
+             *
+             * A window without area, a point or a line, clips every figure to an
+             * empty polygon, like areas() does; its edges would be degenerate.
+             *
+             * \param figure Polygonal figure to clip.
+             * \param window Clip window.
+             * \return Part of the figure inside the window.
+             *
+             * \throws const char* If the figure is a circle.
+             */
+            static ClippedPolygon clip(const Figure &figure, const BoundingBox &window) {
+                const Outline subject = polygonOf(figure);
+                if (!(window.minX < window.maxX && window.minY < window.maxY)) {
+                    return ClippedPolygon {};
+                }
+                std::array<Vec2, 4> corners {Vec2{window.minX, window.minY}, Vec2{window.maxX, window.minY},
+                                             Vec2{window.maxX, window.maxY}, Vec2{window.minX, window.maxY}};
+                Outline w;
+                w.size = 4;
+                w.vertex = corners;
+                return clip(subject, w);
+            }
+
+            /**
+             * \brief Clips a figure against another figure.
+             *
+             * \param figure Polygonal figure to clip.
+             * \param window Polygonal figure used as the window.
+             * \return Part of figure inside window.
+             *
+             * \throws const char* If either figure is a circle.
+             */
+            static ClippedPolygon clip(const Figure &figure, const Figure &window) {
+                return clip(polygonOf(figure), polygonOf(window));
+            }
+
+            /**
+             * \brief Calculates the overlap area of two figures.
+             *
+             * \param a First polygonal figure.
+             * \param b Second polygonal figure.
+             * \return Area of the intersection.
+             *
+             * \throws const char* If either figure is a circle.
+             */
+            static double intersectionArea(const Figure &a, const Figure &b) {
+                return clip(a, b).area();
+            }
+
+            /**
+             * \brief Clips many figures against one window in parallel.
+             *
+             * \param figures Polygonal figures to clip.
+             * \param window Clip window.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Clipped polygon of every figure, indexed like the figures.
+             *
+             * \throws const char* If a figure is a circle.
+             */
+            static std::vector<ClippedPolygon> clipAll(const std::vector<const Figure*> &figures, const BoundingBox &window,
+                                                       unsigned threads = 0) {
+                std::vector<ClippedPolygon> out(figures.size());
+                parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        out[i] = clip(*figures[i], window);
+                    }
+                }, threads);
+                return out;
+            }
+
+            /**
+             * \brief Calculates the overlap areas of many figures with one window in parallel.
+             *
+             * Uses the vectorized area kernel and never builds the clipped polygons.
+             *
+             * \param figures Polygonal figures to clip.
+             * \param window Clip window.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Area of every figure inside the window, indexed like the figures.
+             *
+             * \throws const char* If a figure is a circle.
+             */
+            static std::vector<double> areas(const std::vector<const Figure*> &figures, const BoundingBox &window,
+                                             unsigned threads = 0) {
+                const std::size_t n = figures.size();
+                const double cx = (window.minX + window.maxX) / 2;
+                const double cy = (window.minY + window.maxY) / 2;
+                const double hw = (window.maxX - window.minX) / 2;
+                const double hh = (window.maxY - window.minY) / 2;
+                std::vector<double> out(n);
+                if (hw < 0 || hh < 0) {
+                    return out;
+                }
+
+                Columns c;
+                for (int k = 0; k < 4; ++k) {
+                    c.x[k].resize(n);
+                    c.y[k].resize(n);
+                }
+                parallelFor(n, 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        Outline o = polygonOf(*figures[i]);
+                        for (int k = 0; k < 4; ++k) {
+                            const Vec2 &v = o.vertex[std::min(k, o.size - 1)];
+                            c.x[k][i] = v.x - cx;
+                            c.y[k][i] = v.y - cy;
+                        }
+                    }
+                    areaKernel(c, begin, end, hw, hh, out.data());
+                }, threads);
+                return out;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
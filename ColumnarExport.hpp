@@ -0,0 +1,456 @@
+#pragma once
+
+#include "Circle.hpp"
+#include "Figure.hpp"
+#include "Parallel.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mw{
+
+/**
+ * \brief Physical type of an exported column.
+ */
+    enum class ColumnType : std::uint32_t {
+        UInt8 = 1,
+        Float64 = 2
+    };
+
+/**
+ * \brief Description of one column in an exported file, 64 bytes.
+ */
+    struct ColumnDescriptor {
+        /**
+         * \brief Column name, zero-padded.
+         */
+        char name[16];
+
+        /**
+         * \brief Physical type of the values.
+         */
+        ColumnType type;
+
+        /**
+         * \brief Size of one value in bytes.
+         */
+        std::uint32_t width;
+
+        /**
+         * \brief Number of null values.
+         */
+        std::uint64_t nullCount;
+
+        /**
+         * \brief File offset of the validity bitmap.
+         */
+        std::uint64_t validityOffset;
+
+        /**
+         * \brief File offset of the values.
+         */
+        std::uint64_t valuesOffset;
+
+        /**
+         * \brief Size of the values in bytes, without padding.
+         */
+        std::uint64_t valuesBytes;
+
+        /**
+         * \brief Zero, reserved for later versions.
+         */
+        std::uint64_t reserved;
+    };
+
+/**
+ * \brief Columnar export of computed figure metrics.
+ *
+ * The file holds one column per metric: type (ShapeType as uint8), x and y of
+ * the center, area, perimeter, and radius, which is null for figures that are
+ * not circles. Every column is a contiguous array of fixed-width values plus
+ * a validity bitmap, with the same buffer layout Arrow uses for primitive
+ * arrays: bit i of the bitmap is bit i % 8 of byte i / 8 and set for valid
+ * values, and every buffer starts at a 64-byte boundary and is padded to a
+ * multiple of 64 bytes. Arrow readers can therefore wrap the buffers without
+ * copying; only the small fixed header and the column descriptors in front of
+ * them replace Arrow's flatbuffer metadata.
+ *
+ * The file size follows from the row count alone, so write() maps the whole
+ * file and fills it in parallel chunks, every chunk writing its own slice of
+ * every column. ColumnarFile maps a file read-only and hands out pointers into
+ * the mapping without parsing any values.
+ */
+    class ColumnarExport {
+        public:
+            /**
+             * \brief File header, 64 bytes.
+             */
+            struct Header {
+                std::uint64_t magic;
+                std::uint32_t version;
+                std::uint32_t columns;
+                std::uint64_t rows;
+                std::uint64_t fileBytes;
+                std::uint64_t reserved[4];
+            };
+
+            /**
+             * \brief Marks a complete export file ("MWCOLUMN").
+             */
+            static constexpr std::uint64_t magic = 0x4e4d554c4f43574dULL;
+
+            /**
+             * \brief Number of exported columns.
+             */
+            static constexpr std::uint32_t columnCount = 6;
+
+            /**
+             * \brief Rows written by one parallel chunk; a multiple of 8, so no two chunks share a bitmap byte.
+             */
+            static constexpr std::size_t chunkRows = 1 << 16;
+
+            static_assert(chunkRows % 8 == 0, "Chunks must cover whole bitmap bytes");
+            static_assert(sizeof(Header) == 64, "Header must be 64 bytes");
+            static_assert(sizeof(ColumnDescriptor) == 64, "Column descriptors must be 64 bytes");
+
+            /**
+             * \brief Rounds a size up to a multiple of 64 bytes.
+             *
+             * \param bytes Size in bytes.
+             * \return Padded size.
+             */
+            static constexpr std::uint64_t pad(std::uint64_t bytes) {
+                return (bytes + 63) / 64 * 64;
+            }
+
+            /**
+             * \brief Writes the metrics of figures to a file.
+             *
+             * \param path File to create or overwrite.
+             * \param figures Figures to export, one row each.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Size of the file in bytes.
+             *
+             * \throws const char* If the file cannot be created or mapped.
+             */
+            static std::uint64_t write(const std::string &path, const std::vector<const Figure*> &figures, unsigned threads = 0) {
+                const std::uint64_t rows = figures.size();
+                const char *names[columnCount] = {"type", "x", "y", "area", "perimeter", "radius"};
+                ColumnDescriptor column[columnCount];
+                std::uint64_t offset = sizeof(Header) + sizeof(column);
+                for (std::uint32_t c = 0; c < columnCount; ++c) {
+                    ColumnDescriptor &d = column[c];
+                    std::memset(&d, 0, sizeof(d));
+                    std::strncpy(d.name, names[c], sizeof(d.name) - 1);
+                    d.type = c == 0 ? ColumnType::UInt8 : ColumnType::Float64;
+                    d.width = c == 0 ? 1 : 8;
+                    d.validityOffset = offset;
+                    offset += pad((rows + 7) / 8);
+                    d.valuesOffset = offset;
+                    d.valuesBytes = rows * d.width;
+                    offset += pad(d.valuesBytes);
+                }
+                const std::uint64_t bytes = offset;
+
+                int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+                if (fd < 0) {
+                    throw "Cannot create export file";
+                }
+                if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                    close(fd);
+                    throw "Cannot resize export file";
+                }
+                void *base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (base == MAP_FAILED) {
+                    throw "Cannot map export file";
+                }
+                char *file = static_cast<char*>(base);
+
+                std::atomic<std::uint64_t> nulls {0};
+                parallelFor(rows, chunkRows, [&](std::size_t begin, std::size_t end) {
+                    std::uint8_t *type = reinterpret_cast<std::uint8_t*>(file + column[0].valuesOffset);
+                    double *value[columnCount];
+                    for (std::uint32_t c = 1; c < columnCount; ++c) {
+                        value[c] = reinterpret_cast<double*>(file + column[c].valuesOffset);
+                    }
+                    std::uint8_t *radiusValid = reinterpret_cast<std::uint8_t*>(file + column[5].validityOffset);
+                    std::uint64_t missing = 0;
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const Figure &f = *figures[i];
+                        type[i] = static_cast<std::uint8_t>(f.type());
+                        value[1][i] = f.getCenter().getX();
+                        value[2][i] = f.getCenter().getY();
+                        value[3][i] = f.area();
+                        value[4][i] = f.perimeter();
+                        bool circle = f.type() == ShapeType::Circle;
+                        value[5][i] = circle ? static_cast<const Circle&>(f).getRadius() : 0;
+                        if (circle) {
+                            radiusValid[i / 8] |= std::uint8_t(1 << (i % 8));
+                        }
+                        missing += !circle;
+                    }
+                    for (std::uint32_t c = 0; c + 1 < columnCount; ++c) {
+                        std::uint8_t *valid = reinterpret_cast<std::uint8_t*>(file + column[c].validityOffset);
+                        std::memset(valid + begin / 8, 0xff, end / 8 - begin / 8);
+                        if (end % 8 != 0) {
+                            valid[end / 8] = std::uint8_t((1 << (end % 8)) - 1);
+                        }
+                    }
+                    nulls += missing;
+                }, threads);
+                column[5].nullCount = nulls;
+
+                std::memcpy(file + sizeof(Header), column, sizeof(column));
+                Header header {0, 1, columnCount, rows, bytes, {0, 0, 0, 0}};
+                std::memcpy(file, &header, sizeof(header));
+                // The magic goes in after everything else is on disk, so a torn file is never taken for a complete one
+                msync(base, bytes, MS_SYNC);
+                std::memcpy(file, &magic, sizeof(magic));
+                msync(base, sizeof(Header), MS_SYNC);
+                munmap(base, bytes);
+                return bytes;
+            }
+    };
+
+/**
+ * \brief Read-only column of a mapped export file.
+ */
+    class ColumnView {
+        private:
+            friend class ColumnarFile;
+
+            /**
+             * \brief Description of the column.
+             */
+            const ColumnDescriptor *m_descriptor;
+
+            /**
+             * \brief Validity bitmap.
+             */
+            const std::uint8_t *m_validity;
+
+            /**
+             * \brief Values.
+             */
+            const void *m_values;
+
+            /**
+             * \brief Number of rows.
+             */
+            std::size_t m_size;
+
+            ColumnView(const ColumnDescriptor *d, const char *file, std::size_t rows)
+                : m_descriptor(d), m_validity(reinterpret_cast<const std::uint8_t*>(file + d->validityOffset)),
+                  m_values(file + d->valuesOffset), m_size(rows) {}
+
+        public:
+            /**
+             * \brief Returns the column name.
+             *
+             * \return Name of the column.
+             */
+            std::string name() const {
+                return std::string(m_descriptor->name, strnlen(m_descriptor->name, sizeof(m_descriptor->name)));
+            }
+
+            /**
+             * \brief Returns the physical type.
+             *
+             * \return Type of the values.
+             */
+            ColumnType type() const {
+                return m_descriptor->type;
+            }
+
+            /**
+             * \brief Returns the number of values.
+             *
+             * \return Number of rows.
+             */
+            std::size_t size() const {
+                return m_size;
+            }
+
+            /**
+             * \brief Returns the number of null values.
+             *
+             * \return Number of rows without a value.
+             */
+            std::size_t nullCount() const {
+                return m_descriptor->nullCount;
+            }
+
+            /**
+             * \brief Returns whether a row has a value.
+             *
+             * \param i Row index.
+             * \return True if the value is not null.
+             */
+            bool valid(std::size_t i) const {
+                return (m_validity[i / 8] >> (i % 8)) & 1;
+            }
+
+            /**
+             * \brief Returns the validity bitmap.
+             *
+             * \return Pointer into the mapping, bit i set if row i is valid.
+             */
+            const std::uint8_t *validity() const {
+                return m_validity;
+            }
+
+            /**
+             * \brief Returns the values as an array.
+             *
+             * \tparam T std::uint8_t for UInt8 columns, double for Float64 columns.
+             * \return Pointer into the mapping; null rows hold unspecified values.
+             *
+             * \throws const char* If T does not match the column type.
+             */
+            template <typename T>
+            const T *values() const {
+                bool match = (std::is_same<T, std::uint8_t>::value && type() == ColumnType::UInt8)
+                    || (std::is_same<T, double>::value && type() == ColumnType::Float64);
+                if (!match) {
+                    throw "Column has a different type";
+                }
+                return static_cast<const T*>(m_values);
+            }
+    };
+
+/**
+ * \brief Export file mapped read-only.
+ */
+    class ColumnarFile {
+        private:
+            /**
+             * \brief Mapped file.
+             */
+            void *m_base = nullptr;
+
+            /**
+             * \brief Size of the mapping in bytes.
+             */
+            std::size_t m_bytes = 0;
+
+            /**
+             * \brief Returns the file header.
+             */
+            const ColumnarExport::Header &header() const {
+                return *static_cast<const ColumnarExport::Header*>(m_base);
+            }
+
+            /**
+             * \brief Returns the column descriptors.
+             */
+            const ColumnDescriptor *descriptors() const {
+                return reinterpret_cast<const ColumnDescriptor*>(static_cast<const char*>(m_base) + sizeof(ColumnarExport::Header));
+            }
+
+        public:
+            /**
+             * \brief Maps an export file.
+             *
+             * \param path File written by ColumnarExport::write().
+             *
+             * \throws const char* If the file cannot be opened or is not a complete export.
+             */
+            explicit ColumnarFile(const std::string &path) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw "Cannot open export file";
+                }
+                struct stat info;
+                if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(ColumnarExport::Header)) {
+                    close(fd);
+                    throw "Not an export file";
+                }
+                m_bytes = static_cast<std::size_t>(info.st_size);
+                m_base = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if (m_base == MAP_FAILED) {
+                    m_base = nullptr;
+                    throw "Cannot map export file";
+                }
+                const ColumnarExport::Header &h = header();
+                bool complete = h.magic == ColumnarExport::magic && h.fileBytes == m_bytes
+                    && sizeof(ColumnarExport::Header) + h.columns * sizeof(ColumnDescriptor) <= m_bytes;
+                for (std::uint32_t c = 0; complete && c < h.columns; ++c) {
+                    const ColumnDescriptor &d = descriptors()[c];
+                    complete = d.validityOffset + (h.rows + 7) / 8 <= m_bytes && d.valuesOffset + d.valuesBytes <= m_bytes
+                        && d.valuesBytes == h.rows * d.width;
+                }
+                if (!complete) {
+                    munmap(m_base, m_bytes);
+                    m_base = nullptr;
+                    throw "Not an export file";
+                }
+            }
+
+            ColumnarFile(const ColumnarFile&) = delete;
+            ColumnarFile &operator=(const ColumnarFile&) = delete;
+
+            /**
+             * \brief Unmaps the file.
+             */
+            ~ColumnarFile() {
+                if (m_base != nullptr) {
+                    munmap(m_base, m_bytes);
+                }
+            }
+
+            /**
+             * \brief Returns the number of rows.
+             *
+             * \return Number of exported figures.
+             */
+            std::size_t rows() const {
+                return header().rows;
+            }
+
+            /**
+             * \brief Returns the number of columns.
+             *
+             * \return Number of columns.
+             */
+            std::size_t columns() const {
+                return header().columns;
+            }
+
+            /**
+             * \brief Returns a column by position.
+             *
+             * \param c Column index.
+             * \return View into the mapping.
+             */
+            ColumnView column(std::size_t c) const {
+                return ColumnView(&descriptors()[c], static_cast<const char*>(m_base), rows());
+            }
+
+            /**
+             * \brief Returns a column by name.
+             *
+             * \param name Column name.
+             * \return View into the mapping.
+             *
+             * \throws const char* If there is no such column.
+             */
+            ColumnView column(const std::string &name) const {
+                for (std::size_t c = 0; c < columns(); ++c) {
+                    if (column(c).name() == name) {
+                        return column(c);
+                    }
+                }
+                throw "No column with this name";
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
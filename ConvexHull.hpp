@@ -0,0 +1,352 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Point with integer coordinates for exact hull predicates.
+ *
+ * Coordinates must lie within +-2^62, so that differences fit into 64 bits
+ * and cross products into 128 bits.
+ */
+    struct HullPoint {
+        std::int64_t x;
+        std::int64_t y;
+
+        bool operator==(const HullPoint &other) const {
+            return x == other.x && y == other.y;
+        }
+
+        bool operator<(const HullPoint &other) const {
+            return x < other.x || (x == other.x && y < other.y);
+        }
+    };
+
+/**
+ * \brief Convex polygon returned by ConvexHull.
+ */
+    struct HullPolygon {
+        /**
+         * \brief Vertices in counter-clockwise order, starting with the lowest x (and lowest y among those).
+         *
+         * No three consecutive vertices are collinear. A hull of one point has one
+         * vertex and a hull of collinear points has the two end points.
+         */
+        std::vector<HullPoint> vertex;
+
+        /**
+         * \brief Calculates the area of the polygon exactly and rounds it once.
+         *
+         * \return The area of the polygon.
+         */
+        double area() const {
+            __int128 twice = 0;
+            for (std::size_t i = 0; i < vertex.size(); ++i) {
+                const HullPoint &a = vertex[i];
+                const HullPoint &b = vertex[(i + 1) % vertex.size()];
+                twice += static_cast<__int128>(a.x) * b.y - static_cast<__int128>(a.y) * b.x;
+            }
+            return static_cast<double>(twice) / 2;
+        }
+
+        /**
+         * \brief Calculates the perimeter of the polygon.
+         *
+         * \return The length of the boundary; twice the length for a segment.
+         */
+        double perimeter() const {
+            double sum = 0;
+            for (std::size_t i = 0; vertex.size() > 1 && i < vertex.size(); ++i) {
+                const HullPoint &a = vertex[i];
+                const HullPoint &b = vertex[(i + 1) % vertex.size()];
+                sum += std::hypot(double(b.x - a.x), double(b.y - a.y));
+            }
+            return sum;
+        }
+
+        /**
+         * \brief Checks whether a point lies inside or on the boundary.
+         *
+         * \param p Point to test.
+         * \return True if the polygon contains the point.
+         */
+        bool contains(const HullPoint &p) const {
+            if (vertex.size() < 3) {
+                if (vertex.size() == 1) {
+                    return p == vertex[0];
+                }
+                const HullPoint &a = vertex[0], &b = vertex[1];
+                return !vertex.empty() && cross(a, b, p) == 0 && std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x)
+                    && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+            }
+            for (std::size_t i = 0; i < vertex.size(); ++i) {
+                if (cross(vertex[i], vertex[(i + 1) % vertex.size()], p) < 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * \brief Returns the cross product of (a - o) and (b - o) exactly.
+         *
+         * \param o Common origin.
+         * \param a End of the first vector.
+         * \param b End of the second vector.
+         * \return Positive if o, a, b turn counter-clockwise, negative if clockwise, zero if collinear.
+         */
+        static __int128 cross(const HullPoint &o, const HullPoint &a, const HullPoint &b) {
+            return static_cast<__int128>(a.x - o.x) * (b.y - o.y) - static_cast<__int128>(a.y - o.y) * (b.x - o.x);
+        }
+    };
+
+/**
+ * \brief Exact convex hull of point sets and figure collections.
+ *
+ * The hull is computed with Andrew's monotone chain on integer points; every
+ * orientation test is an exact 128-bit cross product, so the result has no
+ * rounding errors whatever the input.
+ *
+ * Large inputs first go through the Akl-Toussaint filter: the points extreme
+ * in x, y, x + y and x - y span an octagon inside the hull, and every point
+ * strictly inside it is dropped, which for most inputs leaves only a small
+ * fraction. The remaining points are split into one part per thread, the
+ * hull of every part is computed in parallel, and the hull of the part hulls
+ * is the result.
+ *
+ * For figures, the hull covers the corners of every polygon and of the
+ * octagon circumscribed around every circle; a corner that is not on the
+ * integer grid contributes the grid points around it, so every figure lies
+ * inside the hull.
+ */
+    class ConvexHull {
+        private:
+            /**
+             * \brief Points per chunk of the parallel passes.
+             */
+            static constexpr std::size_t grain = 1 << 16;
+
+            /**
+             * \brief Index of every Akl-Toussaint extreme: min/max of x, y, x + y and x - y.
+             */
+            using Extremes = std::array<HullPoint, 8>;
+
+            /**
+             * \brief Updates the extremes with a point; ties keep the first point in (x, y) order.
+             */
+            static void extend(Extremes &e, const HullPoint &p) {
+                auto better = [&](int k, std::int64_t key, std::int64_t current, bool max) {
+                    if ((max ? key > current : key < current) || (key == current && p < e[k])) {
+                        e[k] = p;
+                    }
+                };
+                better(0, p.x, e[0].x, false);
+                better(1, p.x, e[1].x, true);
+                better(2, p.y, e[2].y, false);
+                better(3, p.y, e[3].y, true);
+                better(4, p.x + p.y, e[4].x + e[4].y, false);
+                better(5, p.x + p.y, e[5].x + e[5].y, true);
+                better(6, p.x - p.y, e[6].x - e[6].y, false);
+                better(7, p.x - p.y, e[7].x - e[7].y, true);
+            }
+
+        public:
+            /**
+             * \brief Computes the hull of points with a single monotone chain.
+             *
+             * \param points Points; sorted and deduplicated in place.
+             * \return The hull.
+             */
+            static HullPolygon chain(std::vector<HullPoint> &points) {
+                std::sort(points.begin(), points.end());
+                points.erase(std::unique(points.begin(), points.end()), points.end());
+                HullPolygon hull;
+                const std::size_t n = points.size();
+                if (n <= 2) {
+                    hull.vertex = points;
+                    return hull;
+                }
+                std::vector<HullPoint> &h = hull.vertex;
+                h.resize(2 * n);
+                std::size_t k = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    while (k >= 2 && HullPolygon::cross(h[k - 2], h[k - 1], points[i]) <= 0) {
+                        --k;
+                    }
+                    h[k++] = points[i];
+                }
+                for (std::size_t i = n - 1, lower = k + 1; i-- > 0;) {
+                    while (k >= lower && HullPolygon::cross(h[k - 2], h[k - 1], points[i]) <= 0) {
+                        --k;
+                    }
+                    h[k++] = points[i];
+                }
+                h.resize(k - 1);
+                return hull;
+            }
+
+            /**
+             * \brief Drops the points strictly inside the Akl-Toussaint octagon.
+             *
+             * \param points Points; the survivors are moved to the front and the rest erased.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Number of dropped points.
+             */
+            static std::size_t filter(std::vector<HullPoint> &points, unsigned threads = 0) {
+                const std::size_t n = points.size();
+                if (n < 16) {
+                    return 0;
+                }
+                const std::size_t chunks = (n + grain - 1) / grain;
+                std::vector<Extremes> partial(chunks);
+                parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t c = first; c < last; ++c) {
+                        Extremes e;
+                        e.fill(points[c * grain]);
+                        for (std::size_t i = c * grain; i < std::min(n, (c + 1) * grain); ++i) {
+                            extend(e, points[i]);
+                        }
+                        partial[c] = e;
+                    }
+                }, threads);
+                Extremes extremes = partial[0];
+                for (const Extremes &e : partial) {
+                    for (const HullPoint &p : e) {
+                        extend(extremes, p);
+                    }
+                }
+                std::vector<HullPoint> corners(extremes.begin(), extremes.end());
+                const HullPolygon octagon = chain(corners);
+                if (octagon.vertex.size() < 3) {
+                    return 0;
+                }
+
+                // Every chunk compacts its own range, then the ranges are joined
+                std::vector<std::size_t> kept(chunks);
+                parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+                    const std::vector<HullPoint> &v = octagon.vertex;
+                    for (std::size_t c = first; c < last; ++c) {
+                        std::size_t out = c * grain;
+                        for (std::size_t i = c * grain; i < std::min(n, (c + 1) * grain); ++i) {
+                            bool inside = true;
+                            for (std::size_t k = 0; k < v.size(); ++k) {
+                                inside &= HullPolygon::cross(v[k], v[(k + 1) % v.size()], points[i]) > 0;
+                            }
+                            if (!inside) {
+                                points[out++] = points[i];
+                            }
+                        }
+                        kept[c] = out - c * grain;
+                    }
+                }, threads);
+                std::size_t size = kept[0];
+                for (std::size_t c = 1; c < chunks; ++c) {
+                    std::copy(points.begin() + c * grain, points.begin() + c * grain + kept[c], points.begin() + size);
+                    size += kept[c];
+                }
+                points.resize(size);
+                return n - size;
+            }
+
+            /**
+             * \brief Computes the hull of points in parallel.
+             *
+             * \param points Points; reordered and filtered.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return The hull.
+             */
+            static HullPolygon of(std::vector<HullPoint> &points, unsigned threads = 0) {
+                filter(points, threads);
+                const std::size_t parts = std::min<std::size_t>(threadCount(threads), (points.size() + grain - 1) / grain);
+                if (parts <= 1) {
+                    return chain(points);
+                }
+                std::vector<std::vector<HullPoint>> hull(parts);
+                parallelFor(parts, 1, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t p = first; p < last; ++p) {
+                        std::vector<HullPoint> part(points.begin() + p * points.size() / parts, points.begin() + (p + 1) * points.size() / parts);
+                        hull[p] = chain(part).vertex;
+                    }
+                }, threads);
+                std::vector<HullPoint> merged;
+                for (const std::vector<HullPoint> &h : hull) {
+                    merged.insert(merged.end(), h.begin(), h.end());
+                }
+                return chain(merged);
+            }
+
+            /**
+             * \brief Returns the points a figure contributes to a hull.
+             *
+             * A circle is replaced by its circumscribed octagon, which is at most 8%
+             * wider than the circle; the axis extremes alone would cut off its arcs.
+             * A corner that is not on the integer grid is replaced by the up to four
+             * grid points around it; rounding each coordinate on its own would cut
+             * slanted edges.
+             *
+             * \param figure Figure.
+             * \param out Receives the grid points around the corners of a polygon or of the octagon around a circle.
+             */
+            static void vertices(const Figure &figure, std::vector<HullPoint> &out) {
+                const Outline o = figure.outline();
+                auto cover = [&out](double x, double y) {
+                    const std::int64_t x0 = static_cast<std::int64_t>(std::floor(x)), x1 = static_cast<std::int64_t>(std::ceil(x));
+                    const std::int64_t y0 = static_cast<std::int64_t>(std::floor(y)), y1 = static_cast<std::int64_t>(std::ceil(y));
+                    out.push_back({x0, y0});
+                    if (x1 != x0) {
+                        out.push_back({x1, y0});
+                    }
+                    if (y1 != y0) {
+                        out.push_back({x0, y1});
+                        if (x1 != x0) {
+                            out.push_back({x1, y1});
+                        }
+                    }
+                };
+                if (o.isCircle) {
+                    const double r = o.radius, t = (std::sqrt(2.0) - 1) * o.radius;
+                    const double dx[8] = {r, t, -t, -r, -r, -t, t, r};
+                    const double dy[8] = {t, r, r, t, -t, -r, -r, -t};
+                    for (int k = 0; k < 8; ++k) {
+                        cover(o.center.x + dx[k], o.center.y + dy[k]);
+                    }
+                    return;
+                }
+                for (int i = 0; i < o.size; ++i) {
+                    cover(o.vertex[i].x, o.vertex[i].y);
+                }
+            }
+
+            /**
+             * \brief Computes the convex envelope of a figure collection in parallel.
+             *
+             * \param figures Figures to enclose.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return The hull of all corners and circle octagons; it encloses every figure.
+             */
+            static HullPolygon of(const std::vector<const Figure*> &figures, unsigned threads = 0) {
+                std::vector<std::vector<HullPoint>> chunk((figures.size() + 4095) / 4096);
+                parallelFor(chunk.size(), 1, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t c = first; c < last; ++c) {
+                        for (std::size_t i = c * 4096; i < std::min(figures.size(), (c + 1) * 4096); ++i) {
+                            vertices(*figures[i], chunk[c]);
+                        }
+                    }
+                }, threads);
+                std::vector<HullPoint> points;
+                for (const std::vector<HullPoint> &c : chunk) {
+                    points.insert(points.end(), c.begin(), c.end());
+                }
+                return of(points, threads);
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Canonical.hpp"
+#include "Figure.hpp"
+#include "Parallel.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Lock-free hash set of element indices.
+ *
+ * The set stores indices into an external array and uses open addressing with
+ * linear probing on a fixed-size table, so any number of threads can insert at
+ * the same time. When two equal elements are inserted the set keeps the one
+ * with the smaller index, which makes the final contents independent of thread
+ * scheduling.
+ */
+    class ConcurrentIndexSet {
+        private:
+            /**
+             * \brief Table slots, 0 when empty, index + 1 otherwise.
+             */
+            std::unique_ptr<std::atomic<std::uint64_t>[]> m_slot;
+
+            /**
+             * \brief Number of slots.
+             */
+            std::size_t m_capacity;
+
+        public:
+            /**
+             * \brief Creates a set able to hold the given number of elements.
+             *
+             * The table is sized to at least twice the expected count, which keeps
+             * probe sequences short.
+             *
+             * \param expected Largest number of distinct elements.
+             */
+            explicit ConcurrentIndexSet(std::size_t expected) : m_capacity(16) {
+                while (m_capacity < 2 * expected) {
+                    m_capacity *= 2;
+                }
+                m_slot.reset(new std::atomic<std::uint64_t>[m_capacity]);
+                parallelFor(m_capacity, 1 << 16, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        m_slot[i].store(0, std::memory_order_relaxed);
+                    }
+                });
+            }
+
+            /**
+             * \brief Inserts an element.
+             *
+             * \param hash Hash of the element.
+             * \param index Index of the element.
+             * \param equal Function called as equal(a, b) to compare the elements with indices a and b.
+             * \return True if no equal element with a smaller index was in the set.
+             */
+            template <typename Equal>
+            bool insert(std::uint64_t hash, std::size_t index, Equal equal) {
+                std::size_t mask = m_capacity - 1;
+                std::uint64_t mine = static_cast<std::uint64_t>(index) + 1;
+                for (std::size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+                    std::uint64_t current = m_slot[pos].load(std::memory_order_acquire);
+                    if (current == 0) {
+                        if (m_slot[pos].compare_exchange_strong(current, mine, std::memory_order_acq_rel)) {
+                            return true;
+                        }
+                    }
+                    // A slot is only ever replaced by an equal element, so one comparison is enough
+                    if (!equal(static_cast<std::size_t>(current - 1), index)) {
+                        continue;
+                    }
+                    while (mine < current) {
+                        if (m_slot[pos].compare_exchange_weak(current, mine, std::memory_order_acq_rel)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+            }
+
+            /**
+             * \brief Calls a function for every stored index.
+             *
+             * Must not run concurrently with insert().
+             *
+             * \param fn Function called as fn(index).
+             */
+            template <typename Fn>
+            void forEach(Fn fn) const {
+                for (std::size_t i = 0; i < m_capacity; ++i) {
+                    std::uint64_t v = m_slot[i].load(std::memory_order_relaxed);
+                    if (v != 0) {
+                        fn(static_cast<std::size_t>(v - 1));
+                    }
+                }
+            }
+    };
+
+/**
+ * \brief Removes duplicate figures from a collection.
+ *
+ * Figures are duplicates if they have equal canonical forms, i.e. same type
+ * and same geometry regardless of corner order. Hashes are computed in
+ * parallel and the figures are then inserted into a ConcurrentIndexSet by all
+ * threads at once. Only hashes are kept in memory; canonical forms of stored
+ * figures are recomputed when hashes match.
+ *
+ * \param figures Figures to deduplicate.
+ * \param threads Number of threads, 0 means one per hardware thread.
+ * \return Indices of the first occurrence of every distinct figure, in input order.
+ */
+    inline std::vector<std::size_t> deduplicate(const std::vector<const Figure*> &figures, unsigned threads = 0) {
+        std::vector<std::uint64_t> hash(figures.size());
+        parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                hash[i] = canonical(*figures[i]).hash();
+            }
+        }, threads);
+
+        ConcurrentIndexSet set(figures.size());
+        parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                CanonicalForm form = canonical(*figures[i]);
+                set.insert(hash[i], i, [&](std::size_t other, std::size_t) {
+                    return hash[other] == hash[i] && canonical(*figures[other]) == form;
+                });
+            }
+        }, threads);
+
+        std::vector<std::uint8_t> keep(figures.size(), 0);
+        set.forEach([&](std::size_t i) { keep[i] = 1; });
+
+        std::vector<std::size_t> unique;
+        for (std::size_t i = 0; i < keep.size(); ++i) {
+            if (keep[i]) {
+                unique.push_back(i);
+            }
+        }
+        return unique;
+    }
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "Parallel.hpp"
+#include "Point.hpp"
+#include "TriangleMesh.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Delaunay triangulation of lattice points.
+ *
+ * Implements the divide-and-conquer algorithm of Guibas and Stolfi on a
+ * quad-edge structure. Points are sorted once, both halves of the top levels
+ * of the recursion are triangulated on separate threads, and the halves are
+ * then merged. The orientation and in-circle predicates are evaluated exactly
+ * in integer arithmetic, so the result is correct for any input inside the
+ * supported coordinate range, including collinear and cocircular points.
+ */
+    class Delaunay {
+        private:
+            /**
+             * \brief One directed edge of a quad-edge.
+             */
+            struct Edge {
+                Edge *next;
+                std::uint32_t origin;
+                std::uint8_t num;
+                bool mark;
+                bool alive;
+
+                Edge *rot() { return this + (num < 3 ? 1 : -3); }
+                Edge *sym() { return this + (num < 2 ? 2 : -2); }
+                Edge *invRot() { return this + (num > 0 ? -1 : 3); }
+                Edge *onext() { return next; }
+                Edge *oprev() { return rot()->onext()->rot(); }
+                Edge *lnext() { return invRot()->onext()->rot(); }
+                Edge *rprev() { return sym()->onext(); }
+                std::uint32_t org() { return origin; }
+                std::uint32_t dest() { return sym()->origin; }
+            };
+
+            /**
+             * \brief Four directed edges forming one undirected edge and its dual.
+             */
+            struct QuadEdge {
+                Edge e[4];
+            };
+
+            /**
+             * \brief Edge storage of one worker, with a free list of deleted edges.
+             */
+            struct Pool {
+                std::deque<QuadEdge> edges;
+                std::vector<QuadEdge*> unused;
+            };
+
+            /**
+             * \brief X coordinates of the sorted unique points, widened to 64 bits.
+             */
+            std::vector<std::int64_t> m_x;
+
+            /**
+             * \brief Y coordinates of the sorted unique points, widened to 64 bits.
+             */
+            std::vector<std::int64_t> m_y;
+
+            /**
+             * \brief Edge pools of all workers.
+             */
+            std::deque<Pool> m_pools;
+
+            /**
+             * \brief Guards m_pools while workers are started.
+             */
+            std::mutex m_poolMutex;
+
+            /**
+             * \brief Creates the edge pool of a new worker.
+             */
+            Pool *newPool() {
+                std::lock_guard<std::mutex> lock(m_poolMutex);
+                m_pools.emplace_back();
+                return &m_pools.back();
+            }
+
+            /**
+             * \brief Exact orientation test.
+             *
+             * \return True if a, b, c turn counter-clockwise.
+             */
+            bool ccw(std::uint32_t a, std::uint32_t b, std::uint32_t c) const {
+                return (m_x[b] - m_x[a]) * (m_y[c] - m_y[a]) - (m_y[b] - m_y[a]) * (m_x[c] - m_x[a]) > 0;
+            }
+
+            /**
+             * \brief Exact in-circle test.
+             *
+             * \return True if d lies strictly inside the circle through a, b, c (given counter-clockwise).
+             */
+            bool inCircle(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d) const {
+                __int128 adx = m_x[a] - m_x[d], ady = m_y[a] - m_y[d];
+                __int128 bdx = m_x[b] - m_x[d], bdy = m_y[b] - m_y[d];
+                __int128 cdx = m_x[c] - m_x[d], cdy = m_y[c] - m_y[d];
+                __int128 alift = adx * adx + ady * ady;
+                __int128 blift = bdx * bdx + bdy * bdy;
+                __int128 clift = cdx * cdx + cdy * cdy;
+                __int128 det = alift * (bdx * cdy - cdx * bdy)
+                             + blift * (cdx * ady - adx * cdy)
+                             + clift * (adx * bdy - bdx * ady);
+                return det > 0;
+            }
+
+            /**
+             * \brief Returns true if p lies strictly right of the directed edge e.
+             */
+            bool rightOf(std::uint32_t p, Edge *e) const {
+                return ccw(p, e->dest(), e->org());
+            }
+
+            /**
+             * \brief Returns true if p lies strictly left of the directed edge e.
+             */
+            bool leftOf(std::uint32_t p, Edge *e) const {
+                return ccw(p, e->org(), e->dest());
+            }
+
+            /**
+             * \brief Creates an isolated edge from org to dest.
+             */
+            static Edge *makeEdge(Pool &pool, std::uint32_t org, std::uint32_t dest) {
+                QuadEdge *q;
+                if (!pool.unused.empty()) {
+                    q = pool.unused.back();
+                    pool.unused.pop_back();
+                }
+                else {
+                    pool.edges.emplace_back();
+                    q = &pool.edges.back();
+                }
+                for (std::uint8_t i = 0; i < 4; ++i) {
+                    q->e[i].num = i;
+                    q->e[i].mark = false;
+                    q->e[i].alive = true;
+                }
+                q->e[0].next = &q->e[0];
+                q->e[1].next = &q->e[3];
+                q->e[2].next = &q->e[2];
+                q->e[3].next = &q->e[1];
+                q->e[0].origin = org;
+                q->e[2].origin = dest;
+                return &q->e[0];
+            }
+
+            /**
+             * \brief Joins or separates the edge rings of a and b.
+             */
+            static void splice(Edge *a, Edge *b) {
+                Edge *alpha = a->onext()->rot();
+                Edge *beta = b->onext()->rot();
+                std::swap(a->next, b->next);
+                std::swap(alpha->next, beta->next);
+            }
+
+            /**
+             * \brief Adds an edge from the destination of a to the origin of b, keeping the faces consistent.
+             */
+            static Edge *connect(Pool &pool, Edge *a, Edge *b) {
+                Edge *e = makeEdge(pool, a->dest(), b->org());
+                splice(e, a->lnext());
+                splice(e->sym(), b);
+                return e;
+            }
+
+            /**
+             * \brief Removes an edge from the subdivision and returns it to the pool.
+             */
+            static void deleteEdge(Pool &pool, Edge *e) {
+                splice(e, e->oprev());
+                splice(e->sym(), e->sym()->oprev());
+                QuadEdge *q = reinterpret_cast<QuadEdge*>(e - e->num);
+                for (Edge &d : q->e) {
+                    d.alive = false;
+                }
+                pool.unused.push_back(q);
+            }
+
+            /**
+             * \brief Triangulates the sorted points [lo, hi).
+             *
+             * \return Counter-clockwise convex hull edge out of the leftmost point
+             *         and clockwise hull edge out of the rightmost point.
+             */
+            std::pair<Edge*, Edge*> build(std::uint32_t lo, std::uint32_t hi, Pool &pool, int spawn) {
+                std::uint32_t n = hi - lo;
+                if (n == 2) {
+                    Edge *a = makeEdge(pool, lo, lo + 1);
+                    return {a, a->sym()};
+                }
+                if (n == 3) {
+                    Edge *a = makeEdge(pool, lo, lo + 1);
+                    Edge *b = makeEdge(pool, lo + 1, lo + 2);
+                    splice(a->sym(), b);
+                    if (ccw(lo, lo + 1, lo + 2)) {
+                        connect(pool, b, a);
+                        return {a, b->sym()};
+                    }
+                    if (ccw(lo, lo + 2, lo + 1)) {
+                        Edge *c = connect(pool, b, a);
+                        return {c->sym(), c};
+                    }
+                    return {a, b->sym()};
+                }
+
+                std::uint32_t mid = lo + n / 2;
+                std::pair<Edge*, Edge*> left, right;
+                if (spawn > 0 && n > 100000) {
+                    Pool *leftPool = newPool();
+                    std::thread worker([&]() { left = build(lo, mid, *leftPool, spawn - 1); });
+                    right = build(mid, hi, pool, spawn - 1);
+                    worker.join();
+                }
+                else {
+                    left = build(lo, mid, pool, 0);
+                    right = build(mid, hi, pool, 0);
+                }
+                Edge *ldo = left.first, *ldi = left.second;
+                Edge *rdi = right.first, *rdo = right.second;
+
+                // Lower common tangent of the two hulls
+                while (true) {
+                    if (leftOf(rdi->org(), ldi)) {
+                        ldi = ldi->lnext();
+                    }
+                    else if (rightOf(ldi->org(), rdi)) {
+                        rdi = rdi->rprev();
+                    }
+                    else {
+                        break;
+                    }
+                }
+
+                Edge *basel = connect(pool, rdi->sym(), ldi);
+                if (ldi->org() == ldo->org()) {
+                    ldo = basel->sym();
+                }
+                if (rdi->org() == rdo->org()) {
+                    rdo = basel;
+                }
+
+                // Zip the halves together from the bottom up
+                while (true) {
+                    Edge *lcand = basel->sym()->onext();
+                    bool lvalid = rightOf(lcand->dest(), basel);
+                    if (lvalid) {
+                        while (inCircle(basel->dest(), basel->org(), lcand->dest(), lcand->onext()->dest())) {
+                            Edge *t = lcand->onext();
+                            deleteEdge(pool, lcand);
+                            lcand = t;
+                        }
+                    }
+                    Edge *rcand = basel->oprev();
+                    bool rvalid = rightOf(rcand->dest(), basel);
+                    if (rvalid) {
+                        while (inCircle(basel->dest(), basel->org(), rcand->dest(), rcand->oprev()->dest())) {
+                            Edge *t = rcand->oprev();
+                            deleteEdge(pool, rcand);
+                            rcand = t;
+                        }
+                    }
+                    lvalid = rightOf(lcand->dest(), basel);
+                    rvalid = rightOf(rcand->dest(), basel);
+                    if (!lvalid && !rvalid) {
+                        break;
+                    }
+                    if (!lvalid || (rvalid && inCircle(lcand->dest(), lcand->org(), rcand->org(), rcand->dest()))) {
+                        basel = connect(pool, rcand, basel->sym());
+                    }
+                    else {
+                        basel = connect(pool, basel->sym(), lcand->sym());
+                    }
+                }
+                return {ldo, rdo};
+            }
+
+        public:
+            /**
+             * \brief Largest supported coordinate (exclusive).
+             *
+             * Keeps the in-circle determinant within 128-bit integers.
+             */
+            static constexpr int maxCoordinate = 1 << 30;
+
+            /**
+             * \brief Triangulates a set of points.
+             *
+             * Duplicate points are merged. If all points lie on one line the
+             * result has vertices but no triangles.
+             *
+             * \param points Points to triangulate.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Mesh of the Delaunay triangles over the unique input points.
+             *
+             * \throws const char* If a coordinate is not less than maxCoordinate.
+             */
+            static TriangleMesh triangulate(const std::vector<Point> &points, unsigned threads = 0) {
+                std::vector<Point> sorted(points);
+                for (const Point &p : sorted) {
+                    if (p.getX() >= maxCoordinate || p.getY() >= maxCoordinate) {
+                        throw "Coordinate too large for triangulation";
+                    }
+                }
+                std::sort(sorted.begin(), sorted.end(), [](const Point &a, const Point &b) {
+                    return a.getX() < b.getX() || (a.getX() == b.getX() && a.getY() < b.getY());
+                });
+                sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+                if (sorted.size() < 3) {
+                    return TriangleMesh(sorted, {});
+                }
+
+                Delaunay d;
+                d.m_x.resize(sorted.size());
+                d.m_y.resize(sorted.size());
+                for (std::size_t i = 0; i < sorted.size(); ++i) {
+                    d.m_x[i] = sorted[i].getX();
+                    d.m_y[i] = sorted[i].getY();
+                }
+
+                int spawn = 0;
+                for (unsigned t = threadCount(threads); t > 1; t /= 2) {
+                    ++spawn;
+                }
+                d.build(0, static_cast<std::uint32_t>(sorted.size()), *d.newPool(), spawn);
+
+                // Every bounded face is a triangle; the unbounded face is clockwise
+                std::vector<std::array<std::uint32_t, 3>> triangles;
+                for (Pool &pool : d.m_pools) {
+                    for (QuadEdge &q : pool.edges) {
+                        for (int i = 0; i < 4; i += 2) {
+                            Edge *e = &q.e[i];
+                            if (!e->alive || e->mark) {
+                                continue;
+                            }
+                            Edge *b = e->lnext();
+                            Edge *c = b->lnext();
+                            e->mark = b->mark = c->mark = true;
+                            if (c->lnext() == e && d.ccw(e->org(), b->org(), c->org())) {
+                                triangles.push_back({e->org(), b->org(), c->org()});
+                            }
+                        }
+                    }
+                }
+                return TriangleMesh(std::move(sorted), std::move(triangles));
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "KDTree.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Returns the distance between two boxes.
+ *
+ * \param a First box.
+ * \param b Second box.
+ * \return 0 if the boxes overlap, otherwise the length of the shortest gap; a lower bound of the distance of everything inside them.
+ */
+    inline double distance(const BoundingBox &a, const BoundingBox &b) {
+        double dx = std::max({0.0, a.minX - b.maxX, b.minX - a.maxX});
+        double dy = std::max({0.0, a.minY - b.maxY, b.minY - a.maxY});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+/**
+ * \brief Returns the squared distance between the segments [a, b] and [c, d].
+ *
+ * \return 0 if the segments cross or touch.
+ */
+    inline double segmentSquaredDistance(const Vec2 &a, const Vec2 &b, const Vec2 &c, const Vec2 &d) {
+        double abc = Outline::cross(a, b, c), abd = Outline::cross(a, b, d);
+        double cda = Outline::cross(c, d, a), cdb = Outline::cross(c, d, b);
+        if (((abc > 0 && abd < 0) || (abc < 0 && abd > 0)) && ((cda > 0 && cdb < 0) || (cda < 0 && cdb > 0))) {
+            return 0;
+        }
+        return std::min({Outline::segmentSquaredDistance(a, c, d), Outline::segmentSquaredDistance(b, c, d),
+                         Outline::segmentSquaredDistance(c, a, b), Outline::segmentSquaredDistance(d, a, b)});
+    }
+
+/**
+ * \brief Returns the distance between two outlines.
+ *
+ * Circles are measured between centers, a circle and a polygon from the
+ * center to the nearest edge, and two polygons by testing every pair of
+ * edges. Shapes that overlap or contain each other have distance 0.
+ *
+ * \param a First outline.
+ * \param b Second outline.
+ * \return Length of the shortest segment between the shapes.
+ */
+    inline double distance(const Outline &a, const Outline &b) {
+        if (a.isCircle && b.isCircle) {
+            return std::max(0.0, std::sqrt(Outline::squaredDistance(a.center, b.center)) - a.radius - b.radius);
+        }
+        if (a.isCircle || b.isCircle) {
+            const Outline &circle = a.isCircle ? a : b;
+            const Outline &polygon = a.isCircle ? b : a;
+            return std::max(0.0, polygon.distanceTo(circle.center) - circle.radius);
+        }
+        if (a.contains(b.vertex[0]) || b.contains(a.vertex[0])) {
+            return 0;
+        }
+        double best = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < a.size; ++i) {
+            for (int j = 0; j < b.size; ++j) {
+                best = std::min(best, segmentSquaredDistance(a.vertex[i], a.vertex[(i + 1) % a.size],
+                                                             b.vertex[j], b.vertex[(j + 1) % b.size]));
+            }
+        }
+        return std::sqrt(best);
+    }
+
+/**
+ * \brief Returns the distance between two figures.
+ *
+ * \param a First figure.
+ * \param b Second figure.
+ * \return 0 if the figures share a point, otherwise the length of the shortest segment between them.
+ */
+    inline double distance(const Figure &a, const Figure &b) {
+        return distance(a.outline(), b.outline());
+    }
+
+/**
+ * \brief Uniform grid for nearest-figure queries by boundary distance.
+ *
+ * The cells are a UniformGrid, as in QueryScene. A query starts with the
+ * cells covering the bounds of the query figure and adds rings of cells
+ * around them until the gap to the next ring is at least the best distance
+ * found; figures are first compared by bounds and only measured exactly if
+ * their bounds could beat the best so far. Every figure is measured at most
+ * once per query, in the first cell where it overlaps the searched region.
+ */
+    class ProximityGrid {
+        private:
+            /**
+             * \brief One figure of the grid.
+             */
+            struct Record {
+                BoundingBox bounds;
+                Outline outline;
+            };
+
+            /**
+             * \brief Range of grid cells, inclusive.
+             */
+            struct CellRange {
+                int x0;
+                int y0;
+                int x1;
+                int y1;
+
+                bool overlaps(const CellRange &other) const {
+                    return x0 <= other.x1 && other.x0 <= x1 && y0 <= other.y1 && other.y0 <= y1;
+                }
+            };
+
+            /**
+             * \brief Figures the grid was built from.
+             */
+            std::vector<const Figure*> m_figures;
+
+            /**
+             * \brief Bounds and outline of every figure, indexed like m_figures.
+             */
+            std::vector<Record> m_record;
+
+            /**
+             * \brief Grid over the figure bounds.
+             */
+            UniformGrid m_grid;
+
+            /**
+             * \brief Returns the cells covered by a box.
+             */
+            CellRange cells(const BoundingBox &b) const {
+                return {m_grid.column(b.minX), m_grid.row(b.minY), m_grid.column(b.maxX), m_grid.row(b.maxY)};
+            }
+
+            /**
+             * \brief Finds the figure closest to an outline.
+             *
+             * \param outline Outline to measure from.
+             * \param bounds Bounds of the outline.
+             * \param skip Index of a figure to ignore, or size() to ignore none.
+             */
+            Neighbor search(const Outline &outline, const BoundingBox &bounds, std::size_t skip) const {
+                Neighbor best {m_record.size(), nullptr, std::numeric_limits<double>::infinity()};
+                const CellRange home = cells(bounds);
+                // Cells of the previous ring; the first ring has none, and no cell range overlaps {0, 0, -1, -1}
+                CellRange previous {0, 0, -1, -1};
+                auto visit = [&](int x, int y, const CellRange &region) {
+                    const std::size_t cell = m_grid.index(x, y);
+                    for (std::uint32_t e = m_grid.cellStart[cell]; e < m_grid.cellStart[cell + 1]; ++e) {
+                        const std::uint32_t j = m_grid.item[e];
+                        const Record &r = m_record[j];
+                        if (j == skip || distance(r.bounds, bounds) >= best.distance) {
+                            continue;
+                        }
+                        // Measured in the first cell of its overlap with the region, unless seen in an earlier ring
+                        const CellRange c = cells(r.bounds);
+                        if (c.overlaps(previous) || x != std::max(c.x0, region.x0) || y != std::max(c.y0, region.y0)) {
+                            continue;
+                        }
+                        const double d = distance(r.outline, outline);
+                        if (d < best.distance) {
+                            best = {j, m_figures[j], d};
+                        }
+                    }
+                };
+                for (int k = 0;; ++k) {
+                    const CellRange region {home.x0 - k, home.y0 - k, home.x1 + k, home.y1 + k};
+                    const int x0 = std::max(0, region.x0), x1 = std::min(m_grid.columns - 1, region.x1);
+                    for (int y = std::max(0, region.y0); y <= std::min(m_grid.rows - 1, region.y1); ++y) {
+                        if (k == 0 || y == region.y0 || y == region.y1) {
+                            for (int x = x0; x <= x1; ++x) {
+                                visit(x, y, region);
+                            }
+                            continue;
+                        }
+                        // Only the cells on the ring are new
+                        if (region.x0 >= 0) {
+                            visit(region.x0, y, region);
+                        }
+                        if (region.x1 < m_grid.columns) {
+                            visit(region.x1, y, region);
+                        }
+                    }
+                    previous = region;
+                    const bool everything = region.x0 <= 0 && region.y0 <= 0 && region.x1 >= m_grid.columns - 1 && region.y1 >= m_grid.rows - 1;
+                    if (everything || best.distance <= k * m_grid.cell) {
+                        return best;
+                    }
+                }
+            }
+
+        public:
+            /**
+             * \brief Builds the grid over figures.
+             *
+             * \param figures Figures to index; they must outlive the grid.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             *
+             * \throws const char* If there are more than 2^32 - 1 figures.
+             */
+            ProximityGrid(const std::vector<const Figure*> &figures, unsigned threads = 0) : m_figures(figures) {
+                if (figures.size() >= 0xffffffffULL) {
+                    throw "Too many figures for a grid";
+                }
+                const std::size_t n = figures.size();
+                m_record.resize(n);
+                parallelFor(n, 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        m_record[i].outline = figures[i]->outline();
+                        m_record[i].bounds = m_record[i].outline.bounds();
+                    }
+                }, threads);
+                m_grid.build(n, [this](std::size_t i) { return m_record[i].bounds; });
+            }
+
+            /**
+             * \brief Returns the number of indexed figures.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_record.size();
+            }
+
+            /**
+             * \brief Finds the indexed figure closest to any figure.
+             *
+             * \param figure Figure to measure from.
+             * \return The closest figure; index size() and an infinite distance if the grid is empty.
+             */
+            Neighbor nearest(const Figure &figure) const {
+                const Outline o = figure.outline();
+                return search(o, o.bounds(), m_record.size());
+            }
+
+            /**
+             * \brief Finds the figure closest to an indexed figure, ignoring the figure itself.
+             *
+             * \param index Index of the figure.
+             * \return The closest other figure; index size() and an infinite distance if there is none.
+             *
+             * \throws const char* If the index is out of range.
+             */
+            Neighbor nearestOther(std::size_t index) const {
+                if (index >= m_record.size()) {
+                    throw "Figure index out of range";
+                }
+                return search(m_record[index].outline, m_record[index].bounds, index);
+            }
+
+            /**
+             * \brief Finds the closest other figure of every indexed figure in parallel.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return One neighbor per figure, indexed like the input.
+             */
+            std::vector<Neighbor> allNearest(unsigned threads = 0) const {
+                std::vector<Neighbor> out(m_record.size());
+                parallelFor(m_record.size(), 256, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        out[i] = search(m_record[i].outline, m_record[i].bounds, i);
+                    }
+                }, threads);
+                return out;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,611 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Dynamic bounding volume hierarchy over moving figures.
+ *
+ * Each figure is a leaf holding a fattened bounding box: the tight box of the
+ * figure grown by a margin and, when a displacement is known, stretched in
+ * the direction of movement. As long as a moved figure stays inside its fat
+ * box nothing in the tree changes; otherwise the leaf is removed and
+ * reinserted at the cheapest place. Tree rotations after every insertion and
+ * removal keep the tree balanced, and rebuild() restores tree quality when
+ * many reinsertions degraded it.
+ *
+ * Figures are referred to by the proxy id returned from insert(). The tree
+ * keeps pointers to the figures, so they must outlive it.
+ */
+    class DynamicBVH {
+        private:
+            /**
+             * \brief Marks a missing node.
+             */
+            static constexpr int null = -1;
+
+            /**
+             * \brief Tree node, either a leaf with a figure or an internal node with two children.
+             */
+            struct Node {
+                BoundingBox box;
+                int parent;
+                int left;
+                int right;
+                int height;
+                Figure *figure;
+
+                bool isLeaf() const {
+                    return left == null;
+                }
+            };
+
+            /**
+             * \brief All nodes; free nodes are chained through parent.
+             */
+            std::vector<Node> m_node;
+
+            /**
+             * \brief Root node or null for an empty tree.
+             */
+            int m_root = null;
+
+            /**
+             * \brief First free node or null.
+             */
+            int m_free = null;
+
+            /**
+             * \brief Number of figures in the tree.
+             */
+            std::size_t m_count = 0;
+
+            /**
+             * \brief Margin added around tight boxes.
+             */
+            double m_margin;
+
+            /**
+             * \brief How far ahead of a known displacement the fat box reaches.
+             */
+            double m_predict;
+
+            /**
+             * \brief Area ratio above which updateAll() rebuilds the tree, 0 disables it.
+             */
+            double m_rebuildRatio;
+
+            /**
+             * \brief Takes a node from the free list, growing the node array if needed.
+             */
+            int allocate() {
+                if (m_free == null) {
+                    m_node.push_back(Node {});
+                    m_free = static_cast<int>(m_node.size()) - 1;
+                    m_node[m_free].parent = null;
+                }
+                int id = m_free;
+                m_free = m_node[id].parent;
+                m_node[id] = {BoundingBox {0, 0, 0, 0}, null, null, null, 0, nullptr};
+                return id;
+            }
+
+            /**
+             * \brief Returns a node to the free list.
+             */
+            void release(int id) {
+                m_node[id].height = -1;
+                m_node[id].figure = nullptr;
+                m_node[id].parent = m_free;
+                m_free = id;
+            }
+
+            /**
+             * \brief Grows a tight box by the margin and stretches it along the displacement.
+             */
+            BoundingBox fatBox(const BoundingBox &tight, const Vec2 &displacement) const {
+                BoundingBox fat {tight.minX - m_margin, tight.minY - m_margin, tight.maxX + m_margin, tight.maxY + m_margin};
+                double dx = m_predict * displacement.x;
+                double dy = m_predict * displacement.y;
+                (dx < 0 ? fat.minX : fat.maxX) += dx;
+                (dy < 0 ? fat.minY : fat.maxY) += dy;
+                return fat;
+            }
+
+            /**
+             * \brief Returns the smallest box covering both boxes.
+             */
+            static BoundingBox merged(const BoundingBox &a, const BoundingBox &b) {
+                BoundingBox box = a;
+                box.merge(b);
+                return box;
+            }
+
+            /**
+             * \brief Recomputes box and height of an internal node from its children.
+             */
+            void refit(int id) {
+                Node &n = m_node[id];
+                n.box = merged(m_node[n.left].box, m_node[n.right].box);
+                n.height = 1 + std::max(m_node[n.left].height, m_node[n.right].height);
+            }
+
+            /**
+             * \brief Rotates the subtree at a node if it is out of balance.
+             *
+             * \param a Subtree root.
+             * \return New subtree root.
+             */
+            int balance(int a) {
+                Node &A = m_node[a];
+                if (A.isLeaf() || A.height < 2) {
+                    return a;
+                }
+                int b = A.left;
+                int c = A.right;
+                int diff = m_node[c].height - m_node[b].height;
+
+                if (diff > 1) {
+                    return rotateUp(a, c, b, false);
+                }
+                if (diff < -1) {
+                    return rotateUp(a, b, c, true);
+                }
+                return a;
+            }
+
+            /**
+             * \brief Promotes the taller child of a node.
+             *
+             * \param a Node to rotate.
+             * \param up Taller child, becomes the new subtree root.
+             * \param other Other child of a.
+             * \param upIsLeft True if up is the left child of a.
+             * \return New subtree root.
+             */
+            int rotateUp(int a, int up, int other, bool upIsLeft) {
+                int f = m_node[up].left;
+                int g = m_node[up].right;
+
+                m_node[up].parent = m_node[a].parent;
+                m_node[a].parent = up;
+                if (m_node[up].parent == null) {
+                    m_root = up;
+                }
+                else if (m_node[m_node[up].parent].left == a) {
+                    m_node[m_node[up].parent].left = up;
+                }
+                else {
+                    m_node[m_node[up].parent].right = up;
+                }
+
+                // The taller grandchild stays with up, the shorter one moves under a
+                int keep = m_node[f].height > m_node[g].height ? f : g;
+                int move = keep == f ? g : f;
+                m_node[up].left = a;
+                m_node[up].right = keep;
+                if (upIsLeft) {
+                    m_node[a].left = move;
+                    m_node[a].right = other;
+                }
+                else {
+                    m_node[a].left = other;
+                    m_node[a].right = move;
+                }
+                m_node[move].parent = a;
+                refit(a);
+                refit(up);
+                return up;
+            }
+
+            /**
+             * \brief Rebalances and refits all nodes from a node up to the root.
+             */
+            void fixUpwards(int id) {
+                while (id != null) {
+                    id = balance(id);
+                    refit(id);
+                    id = m_node[id].parent;
+                }
+            }
+
+            /**
+             * \brief Links a leaf into the tree next to the sibling that increases the total perimeter least.
+             */
+            void insertLeaf(int leaf) {
+                if (m_root == null) {
+                    m_root = leaf;
+                    m_node[leaf].parent = null;
+                    return;
+                }
+
+                // Descend towards the sibling with the smallest perimeter increase
+                BoundingBox box = m_node[leaf].box;
+                int id = m_root;
+                while (!m_node[id].isLeaf()) {
+                    const Node &n = m_node[id];
+                    double combined = merged(n.box, box).perimeter();
+                    double cost = 2 * combined;
+                    double inherited = 2 * (combined - n.box.perimeter());
+
+                    auto childCost = [&](int child) {
+                        const Node &c = m_node[child];
+                        double grown = merged(c.box, box).perimeter();
+                        return (c.isLeaf() ? grown : grown - c.box.perimeter()) + inherited;
+                    };
+                    double costLeft = childCost(n.left);
+                    double costRight = childCost(n.right);
+
+                    if (cost < costLeft && cost < costRight) {
+                        break;
+                    }
+                    id = costLeft < costRight ? n.left : n.right;
+                }
+
+                int sibling = id;
+                int oldParent = m_node[sibling].parent;
+                int parent = allocate();
+                m_node[parent].parent = oldParent;
+                m_node[parent].left = sibling;
+                m_node[parent].right = leaf;
+                m_node[sibling].parent = parent;
+                m_node[leaf].parent = parent;
+
+                if (oldParent == null) {
+                    m_root = parent;
+                }
+                else if (m_node[oldParent].left == sibling) {
+                    m_node[oldParent].left = parent;
+                }
+                else {
+                    m_node[oldParent].right = parent;
+                }
+                fixUpwards(parent);
+            }
+
+            /**
+             * \brief Unlinks a leaf from the tree; the leaf node itself stays allocated.
+             */
+            void removeLeaf(int leaf) {
+                if (leaf == m_root) {
+                    m_root = null;
+                    return;
+                }
+                int parent = m_node[leaf].parent;
+                int grand = m_node[parent].parent;
+                int sibling = m_node[parent].left == leaf ? m_node[parent].right : m_node[parent].left;
+
+                m_node[sibling].parent = grand;
+                if (grand == null) {
+                    m_root = sibling;
+                }
+                else {
+                    if (m_node[grand].left == parent) {
+                        m_node[grand].left = sibling;
+                    }
+                    else {
+                        m_node[grand].right = sibling;
+                    }
+                    fixUpwards(grand);
+                }
+                release(parent);
+            }
+
+            /**
+             * \brief Builds a subtree from leaves using a binned surface area heuristic.
+             *
+             * Leaves are binned by box center along both axes and the split with the
+             * smallest sum of perimeter times leaf count over both halves is taken.
+             */
+            int buildRange(std::vector<int> &leaves, std::size_t lo, std::size_t hi) {
+                if (hi - lo == 1) {
+                    return leaves[lo];
+                }
+                const int bins = 16;
+                auto center = [&](int leaf, bool byX) {
+                    const BoundingBox &b = m_node[leaf].box;
+                    return byX ? b.minX + b.maxX : b.minY + b.maxY;
+                };
+
+                double bestCost = -1;
+                bool bestByX = true;
+                double bestSplit = 0;
+                for (bool byX : {true, false}) {
+                    double lowest = center(leaves[lo], byX), highest = lowest;
+                    for (std::size_t i = lo; i < hi; ++i) {
+                        lowest = std::min(lowest, center(leaves[i], byX));
+                        highest = std::max(highest, center(leaves[i], byX));
+                    }
+                    if (highest == lowest) {
+                        continue;
+                    }
+                    double scale = bins / (highest - lowest);
+
+                    std::vector<BoundingBox> binBox(bins);
+                    std::vector<std::size_t> binCount(bins, 0);
+                    for (std::size_t i = lo; i < hi; ++i) {
+                        int bin = std::min(bins - 1, static_cast<int>((center(leaves[i], byX) - lowest) * scale));
+                        binBox[bin] = binCount[bin]++ == 0 ? m_node[leaves[i]].box : merged(binBox[bin], m_node[leaves[i]].box);
+                    }
+
+                    // Cost of every split between bin k - 1 and bin k, from the right side first
+                    std::vector<double> rightCost(bins, 0);
+                    BoundingBox acc {};
+                    std::size_t count = 0;
+                    for (int k = bins - 1; k > 0; --k) {
+                        if (binCount[k] > 0) {
+                            acc = count == 0 ? binBox[k] : merged(acc, binBox[k]);
+                            count += binCount[k];
+                        }
+                        rightCost[k] = count == 0 ? -1 : acc.perimeter() * count;
+                    }
+                    count = 0;
+                    for (int k = 1; k < bins; ++k) {
+                        if (binCount[k - 1] > 0) {
+                            acc = count == 0 ? binBox[k - 1] : merged(acc, binBox[k - 1]);
+                            count += binCount[k - 1];
+                        }
+                        if (count == 0 || rightCost[k] < 0) {
+                            continue;
+                        }
+                        double cost = acc.perimeter() * count + rightCost[k];
+                        if (bestCost < 0 || cost < bestCost) {
+                            bestCost = cost;
+                            bestByX = byX;
+                            bestSplit = lowest + k / scale;
+                        }
+                    }
+                }
+
+                std::size_t mid;
+                if (bestCost < 0) {
+                    // All centers coincide, any split is as good as another
+                    mid = lo + (hi - lo) / 2;
+                }
+                else {
+                    mid = std::partition(leaves.begin() + lo, leaves.begin() + hi, [&](int leaf) {
+                        return center(leaf, bestByX) < bestSplit;
+                    }) - leaves.begin();
+                    if (mid == lo || mid == hi) {
+                        mid = lo + (hi - lo) / 2;
+                    }
+                }
+
+                int left = buildRange(leaves, lo, mid);
+                int right = buildRange(leaves, mid, hi);
+                int parent = allocate();
+                m_node[parent].left = left;
+                m_node[parent].right = right;
+                m_node[left].parent = parent;
+                m_node[right].parent = parent;
+                refit(parent);
+                return parent;
+            }
+
+        public:
+            /**
+             * \brief Creates an empty tree.
+             *
+             * \param margin Margin added around every figure's tight box.
+             * \param predict Multiplier of the displacement passed to update() used to stretch fat boxes.
+             * \param rebuildRatio Area ratio above which updateAll() rebuilds the tree, 0 disables rebuilding.
+             *
+             * \throws const char* If margin or predict is negative.
+             */
+            DynamicBVH(double margin = 1.0, double predict = 2.0, double rebuildRatio = 0)
+                : m_margin(margin), m_predict(predict), m_rebuildRatio(rebuildRatio) {
+                if (margin < 0 || predict < 0) {
+                    throw "Margin cannot be less than 0";
+                }
+            }
+
+            /**
+             * \brief Adds a figure to the tree.
+             *
+             * \param figure Figure to add.
+             * \return Proxy id of the figure.
+             */
+            int insert(Figure &figure) {
+                int leaf = allocate();
+                m_node[leaf].figure = &figure;
+                m_node[leaf].box = fatBox(figure.outline().bounds(), {0, 0});
+                insertLeaf(leaf);
+                ++m_count;
+                return leaf;
+            }
+
+            /**
+             * \brief Removes a figure from the tree.
+             *
+             * \param id Proxy id returned by insert().
+             */
+            void remove(int id) {
+                removeLeaf(id);
+                release(id);
+                --m_count;
+            }
+
+            /**
+             * \brief Updates the tree after a figure changed.
+             *
+             * Cheap when the figure still fits in its fat box; otherwise the leaf
+             * is reinserted with a new fat box stretched along the displacement.
+             *
+             * \param id Proxy id of the changed figure.
+             * \param displacement Expected movement per update, used to predict the next position.
+             * \return True if the leaf was reinserted.
+             */
+            bool update(int id, const Vec2 &displacement = {0, 0}) {
+                BoundingBox tight = m_node[id].figure->outline().bounds();
+                if (m_node[id].box.contains(tight)) {
+                    return false;
+                }
+                removeLeaf(id);
+                m_node[id].box = fatBox(tight, displacement);
+                insertLeaf(id);
+                return true;
+            }
+
+            /**
+             * \brief Moves a figure to a new center and updates the tree.
+             *
+             * \param id Proxy id of the figure.
+             * \param center New center of the figure.
+             * \return True if the leaf was reinserted.
+             */
+            bool setCenter(int id, const Point &center) {
+                Figure &figure = *m_node[id].figure;
+                Point old = figure.getCenter();
+                figure.setCenter(center);
+                return update(id, {double(center.getX() - old.getX()), double(center.getY() - old.getY())});
+            }
+
+            /**
+             * \brief Updates the tree after any number of figures changed.
+             *
+             * Tight boxes are recomputed and checked against the fat boxes in
+             * parallel; only figures that left their fat box are reinserted. If
+             * a rebuild ratio was set and the tree quality dropped below it, the
+             * tree is rebuilt afterwards.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Number of reinserted figures.
+             */
+            std::size_t updateAll(unsigned threads = 0) {
+                std::vector<BoundingBox> tight(m_node.size());
+                std::vector<std::uint8_t> moved(m_node.size(), 0);
+                parallelFor(m_node.size(), 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const Node &n = m_node[i];
+                        if (n.figure != nullptr) {
+                            tight[i] = n.figure->outline().bounds();
+                            moved[i] = !n.box.contains(tight[i]);
+                        }
+                    }
+                }, threads);
+
+                std::size_t count = 0;
+                for (std::size_t i = 0; i < moved.size(); ++i) {
+                    if (moved[i]) {
+                        int id = static_cast<int>(i);
+                        removeLeaf(id);
+                        m_node[id].box = fatBox(tight[i], {0, 0});
+                        insertLeaf(id);
+                        ++count;
+                    }
+                }
+                if (m_rebuildRatio > 0 && areaRatio() > m_rebuildRatio) {
+                    rebuild();
+                }
+                return count;
+            }
+
+            /**
+             * \brief Rebuilds the whole tree from its leaves.
+             *
+             * Proxy ids stay valid.
+             */
+            void rebuild() {
+                std::vector<int> leaves;
+                for (std::size_t i = 0; i < m_node.size(); ++i) {
+                    if (m_node[i].figure != nullptr) {
+                        leaves.push_back(static_cast<int>(i));
+                    }
+                    else if (m_node[i].height > 0) {
+                        release(static_cast<int>(i));
+                    }
+                }
+                m_root = leaves.empty() ? null : buildRange(leaves, 0, leaves.size());
+                if (m_root != null) {
+                    m_node[m_root].parent = null;
+                }
+            }
+
+            /**
+             * \brief Returns the tree quality.
+             *
+             * \return Sum of perimeters of all internal nodes divided by the root perimeter; lower is better.
+             */
+            double areaRatio() const {
+                if (m_root == null) {
+                    return 0;
+                }
+                double rootPerimeter = m_node[m_root].box.perimeter();
+                double total = 0;
+                for (const Node &n : m_node) {
+                    if (n.height > 0) {
+                        total += n.box.perimeter();
+                    }
+                }
+                return rootPerimeter > 0 ? total / rootPerimeter : 0;
+            }
+
+            /**
+             * \brief Returns the height of the tree.
+             *
+             * \return Height, 0 for a single leaf and -1 for an empty tree.
+             */
+            int height() const {
+                return m_root == null ? -1 : m_node[m_root].height;
+            }
+
+            /**
+             * \brief Returns the number of figures in the tree.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_count;
+            }
+
+            /**
+             * \brief Returns the fat box of a figure.
+             *
+             * \param id Proxy id of the figure.
+             * \return Fat bounding box stored in the tree.
+             */
+            const BoundingBox &getFatBox(int id) const {
+                return m_node[id].box;
+            }
+
+            /**
+             * \brief Calls a function for every figure whose fat box overlaps a box.
+             *
+             * The callback may return false to stop the query early.
+             *
+             * \param box Query box.
+             * \param fn Function called as fn(id, figure), returning bool.
+             */
+            template <typename Fn>
+            void query(const BoundingBox &box, Fn fn) const {
+                if (m_root == null) {
+                    return;
+                }
+                std::vector<int> stack {m_root};
+                while (!stack.empty()) {
+                    int id = stack.back();
+                    stack.pop_back();
+                    const Node &n = m_node[id];
+                    if (!n.box.overlaps(box)) {
+                        continue;
+                    }
+                    if (n.isLeaf()) {
+                        if (!fn(id, static_cast<const Figure&>(*n.figure))) {
+                            return;
+                        }
+                    }
+                    else {
+                        stack.push_back(n.left);
+                        stack.push_back(n.right);
+                    }
+                }
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+namespace mw{
+
+/**
+ * \brief Selects between exact and fast approximate computation of figure values.
+ */
+    enum class Precision {
+        /**
+         * \brief Uses the standard library functions, correct to the last bit or two.
+         */
+        Exact,
+
+        /**
+         * \brief Uses the approximations of FastMath, with the error bounds documented there.
+         */
+        Fast
+    };
+
+/**
+ * \brief Sines of the integer angles 0 to 90 degrees, built at compile time.
+ *
+ * Uses the Taylor series up to x^25, whose truncation error on [0, pi / 2]
+ * is smaller than a double can represent.
+ */
+    inline constexpr std::array<double, 91> sineOfDegrees = []() {
+        std::array<double, 91> table {};
+        for (int i = 0; i <= 90; ++i) {
+            double x = i * 3.14159265358979323846 / 180;
+            double term = x;
+            double sum = x;
+            for (int k = 1; k <= 12; ++k) {
+                term *= -x * x / ((2 * k) * (2 * k + 1));
+                sum += term;
+            }
+            table[i] = sum;
+        }
+        return table;
+    }();
+
+/**
+ * \brief Fast approximations of the square root and trigonometric functions used by the figures.
+ *
+ * Every function documents its largest error, which is checked by the tests:
+ * - sqrt: relative error below sqrtError,
+ * - sinDegrees, cosDegrees: table lookups for integer angles, error below 1e-15,
+ * - acosDegrees: absolute error below acosError degrees.
+ */
+    class FastMath {
+        public:
+            /**
+             * \brief Largest relative error of sqrt().
+             */
+            static constexpr double sqrtError = 1e-7;
+
+            /**
+             * \brief Largest absolute error of acosDegrees(), in degrees.
+             */
+            static constexpr double acosError = 2e-6;
+
+            /**
+             * \brief Approximates the square root.
+             *
+             * Rounds x to float and takes the single-precision hardware square
+             * root, which has a shorter latency than the double one and fits
+             * twice as many lanes into a vector register.
+             *
+             * \param x Value, not negative and below the float range (3.4e38).
+             * \return sqrt(x) with a relative error below sqrtError.
+             */
+            static double sqrt(double x) {
+                return double(std::sqrt(float(x)));
+            }
+
+            /**
+             * \brief Returns the sine of an integer angle from 0 to 90 degrees.
+             *
+             * \param degrees Angle in degrees.
+             * \return Sine of the angle, with an error below 1e-15.
+             */
+            static constexpr double sinDegrees(int degrees) {
+                return sineOfDegrees[degrees];
+            }
+
+            /**
+             * \brief Returns the cosine of an integer angle from 0 to 90 degrees.
+             *
+             * \param degrees Angle in degrees.
+             * \return Cosine of the angle, with an error below 1e-15.
+             */
+            static constexpr double cosDegrees(int degrees) {
+                return sineOfDegrees[90 - degrees];
+            }
+
+            /**
+             * \brief Approximates the arc cosine in degrees.
+             *
+             * Uses the polynomial approximation 4.4.46 of Abramowitz and Stegun,
+             * acos(x) = sqrt(1 - x) * p(x) for x >= 0, mirrored for x < 0.
+             *
+             * \param x Value from -1 to 1.
+             * \return Arc cosine of x in degrees, with an absolute error below acosError.
+             */
+            static double acosDegrees(double x) {
+                double a = std::abs(x);
+                double p = -0.0012624911;
+                p = p * a + 0.0066700901;
+                p = p * a - 0.0170881256;
+                p = p * a + 0.0308918810;
+                p = p * a - 0.0501743046;
+                p = p * a + 0.0889789874;
+                p = p * a - 0.2145988016;
+                p = p * a + 1.5707963050;
+                double r = std::sqrt(1 - a) * p * (180 / 3.14159265358979323846);
+                return x < 0 ? 180 - r : r;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -2,23 +2,45 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 #include "Point.hpp"
+#include "Geometry.hpp"
+#include "FastMath.hpp"
 
 namespace mw{
+/**
+ * \brief Identifies the concrete type of a figure.
+ */
+    enum class ShapeType {
+        Circle,
+        Triangle,
+        Rectangle,
+        Square,
+        Rhombus
+    };
+
 /**
  * \brief Represents a geometric figure.
  *
- * The Figure class is an abstract base class for all 2D geometric figures.
+ * The BasicFigure class is an abstract base class for all 2D geometric figures.
  * It stores a center point and a name for the figure. It also declares
  * pure virtual functions for area and perimeter, which must be implemented
  * by derived classes.
+ *
+ * Coordinates and computed values (side lengths, radius, area, perimeter)
+ * have their own template parameters. Figure is the default precision used
+ * across the library and FigureF stores everything as float for bulk work.
+ *
+ * \tparam Coord Coordinate type of the center point and corners.
+ * \tparam Scalar Type of lengths and computed values.
  */
-    class Figure {
+    template <typename Coord, typename Scalar>
+    class BasicFigure {
         private:
             /**
              * \brief Center point of the figure.
              */
-            Point m_point;
+            BasicPoint<Coord> m_point;
 
             /**
              * \brief Name of the figure.
@@ -30,23 +52,25 @@ namespace mw{
              * \brief Creates a figure with a given center point and name.
              *
              * \param p Center point of the figure.
-             * \param name Name of the figure.
+             * \param name Name of the figure (moved into the figure).
              */
-            Figure(const Point &p, const std::string &name) : m_point(p), m_name(name) {}
+            BasicFigure(const BasicPoint<Coord> &p, std::string name) : m_point(p), m_name(std::move(name)) {}
 
             /**
              * \brief Creates a figure at the origin with a given name.
              *
              * The center point is set to (0,0) by default.
              *
-             * \param name Name of the figure.
+             * \param name Name of the figure (moved into the figure).
              */
-            Figure(const std::string &name) : m_point(0,0), m_name(name) {}
+            BasicFigure(std::string name) : m_point(0,0), m_name(std::move(name)) {}
 
             /**
              * \brief Default destructor.
+             *
+             * Virtual, so figures can be owned and destroyed through a Figure pointer.
              */
-            ~Figure() = default;
+            virtual ~BasicFigure() = default;
 
             /**
              * \brief Calculates the area of the figure.
@@ -55,7 +79,7 @@ namespace mw{
              *
              * \return Area of the figure.
              */
-            virtual double area() const = 0;
+            virtual Scalar area() const = 0;
 
             /**
              * \brief Calculates the perimeter of the figure.
@@ -64,42 +88,96 @@ namespace mw{
              *
              * \return Perimeter of the figure.
              */
-            virtual double perimeter() const = 0;
+            virtual Scalar perimeter() const = 0;
+
+            /**
+             * \brief Calculates the area of the figure with a selected precision.
+             *
+             * Figures whose area needs no square root or trigonometry ignore the
+             * precision and return area().
+             *
+             * \param precision Exact or fast approximate computation.
+             * \return Area of the figure.
+             */
+            virtual Scalar area([[maybe_unused]] Precision precision) const {
+                return area();
+            }
+
+            /**
+             * \brief Calculates the perimeter of the figure with a selected precision.
+             *
+             * Figures whose perimeter needs no square root or trigonometry ignore
+             * the precision and return perimeter().
+             *
+             * \param precision Exact or fast approximate computation.
+             * \return Perimeter of the figure.
+             */
+            virtual Scalar perimeter([[maybe_unused]] Precision precision) const {
+                return perimeter();
+            }
+
+            /**
+             * \brief Returns the exact boundary of the figure.
+             *
+             * This is a pure virtual function and must be implemented by derived classes.
+             *
+             * \return Outline of the figure in floating point coordinates.
+             */
+            virtual Outline outline() const = 0;
+
+            /**
+             * \brief Returns the concrete type of the figure.
+             *
+             * Unlike the name, the type cannot be changed and is safe to dispatch on.
+             *
+             * \return Type of the figure.
+             */
+            virtual ShapeType type() const = 0;
 
             /**
              * \brief Sets the center point of the figure.
              *
              * \param p New center point.
              */
-            void setCenter(const Point &p){
+            void setCenter(const BasicPoint<Coord> &p){
                 m_point = p;
             }
 
             /**
              * \brief Returns the center point of the figure.
              *
-             * \return Center point as a Point object.
+             * \return Constant reference to the center point.
              */
-            Point getCenter() const {
+            const BasicPoint<Coord>& getCenter() const {
                 return m_point;
             }
 
             /**
              * \brief Sets the name of the figure.
              *
-             * \param n New name of the figure.
+             * \param n New name of the figure (moved into the figure).
              */
-            void setName(const std::string &n){
-                m_name = n;
+            void setName(std::string n){
+                m_name = std::move(n);
             }
 
             /**
              * \brief Returns the name of the figure.
              *
-             * \return Name of the figure as a string.
+             * \return Constant reference to the name of the figure.
              */
-            std::string getName() const {
+            const std::string& getName() const {
                 return m_name;
             }
     };
+
+/**
+ * \brief Figure with integer coordinates and double values, the default used across the library.
+ */
+    using Figure = BasicFigure<int, double>;
+
+/**
+ * \brief Figure with float coordinates and values for bulk work.
+ */
+    using FigureF = BasicFigure<float, float>;
 }//namespace mw
\ No newline at end of file
@@ -0,0 +1,762 @@
+#pragma once
+
+#include "Circle.hpp"
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include "Rectangle.hpp"
+#include "Rhombus.hpp"
+#include "Triangle.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Attribute of a figure that queries can test.
+ *
+ * Attributes a figure does not have are NaN and fail every comparison:
+ * Radius is set only for circles; SideA and SideB for rectangles, squares,
+ * rhombi and triangles; SideC only for triangles (the sides run from corner
+ * 0 to 1, 1 to 2 and 2 to 0); Angle for rhombi and, as 90, for rectangles and
+ * squares. Type holds the ShapeType value.
+ */
+    enum class Attribute {
+        Type,
+        X,
+        Y,
+        Radius,
+        SideA,
+        SideB,
+        SideC,
+        Angle,
+        Area,
+        Perimeter
+    };
+
+/**
+ * \brief Comparison of an attribute with a constant.
+ */
+    enum class Comparison {
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual
+    };
+
+/**
+ * \brief Condition on figures, built from fields and combined with &&, || and !.
+ *
+ * Example: field(Attribute::Area) > 10 && isType(ShapeType::Circle) && centerWithin(window).
+ * Predicates are immutable and cheap to copy.
+ */
+    class Predicate {
+        private:
+            friend class FigureTable;
+            friend class Field;
+            friend Predicate centerWithin(const BoundingBox &box);
+            friend Predicate overlapping(const BoundingBox &box);
+
+            /**
+             * \brief Kind of a node of the expression tree.
+             */
+            enum class Kind {
+                Compare,
+                Between,
+                Within,
+                Overlaps,
+                And,
+                Or,
+                Not
+            };
+
+            /**
+             * \brief Node of the expression tree.
+             */
+            struct Node {
+                Kind kind;
+                Attribute attribute = Attribute::Type;
+                Comparison comparison = Comparison::Equal;
+                double low = 0;
+                double high = 0;
+                BoundingBox box {0, 0, 0, 0};
+                std::shared_ptr<const Node> left;
+                std::shared_ptr<const Node> right;
+
+                explicit Node(Kind kind) : kind(kind) {}
+            };
+
+            /**
+             * \brief Root of the expression tree.
+             */
+            std::shared_ptr<const Node> m_node;
+
+            explicit Predicate(std::shared_ptr<const Node> node) : m_node(std::move(node)) {}
+
+            /**
+             * \brief Creates a node combining two predicates.
+             */
+            static Predicate combine(Kind kind, const Predicate &a, const Predicate &b) {
+                Node n(kind);
+                n.left = a.m_node;
+                n.right = b.m_node;
+                return Predicate(std::make_shared<const Node>(n));
+            }
+
+        public:
+            /**
+             * \brief Figures matching both predicates.
+             */
+            friend Predicate operator&&(const Predicate &a, const Predicate &b) {
+                return combine(Kind::And, a, b);
+            }
+
+            /**
+             * \brief Figures matching either predicate.
+             */
+            friend Predicate operator||(const Predicate &a, const Predicate &b) {
+                return combine(Kind::Or, a, b);
+            }
+
+            /**
+             * \brief Figures not matching the predicate, including those missing the tested attribute.
+             */
+            friend Predicate operator!(const Predicate &a) {
+                Node n(Kind::Not);
+                n.left = a.m_node;
+                return Predicate(std::make_shared<const Node>(n));
+            }
+    };
+
+/**
+ * \brief Attribute used on the left side of a comparison.
+ */
+    class Field {
+        private:
+            /**
+             * \brief Tested attribute.
+             */
+            Attribute m_attribute;
+
+            /**
+             * \brief Creates a comparison node.
+             */
+            Predicate compare(Comparison comparison, double value) const {
+                Predicate::Node n(Predicate::Kind::Compare);
+                n.attribute = m_attribute;
+                n.comparison = comparison;
+                n.low = value;
+                return Predicate(std::make_shared<const Predicate::Node>(n));
+            }
+
+        public:
+            /**
+             * \brief Creates a field.
+             *
+             * \param attribute Tested attribute.
+             */
+            explicit Field(Attribute attribute) : m_attribute(attribute) {}
+
+            Predicate operator<(double v) const { return compare(Comparison::Less, v); }
+            Predicate operator<=(double v) const { return compare(Comparison::LessEqual, v); }
+            Predicate operator>(double v) const { return compare(Comparison::Greater, v); }
+            Predicate operator>=(double v) const { return compare(Comparison::GreaterEqual, v); }
+            Predicate operator==(double v) const { return compare(Comparison::Equal, v); }
+            Predicate operator!=(double v) const { return compare(Comparison::NotEqual, v); }
+
+            /**
+             * \brief Tests low <= attribute <= high.
+             *
+             * \param low Smallest accepted value.
+             * \param high Largest accepted value.
+             * \return Predicate.
+             */
+            Predicate between(double low, double high) const {
+                Predicate::Node n(Predicate::Kind::Between);
+                n.attribute = m_attribute;
+                n.low = low;
+                n.high = high;
+                return Predicate(std::make_shared<const Predicate::Node>(n));
+            }
+    };
+
+/**
+ * \brief Returns a field for an attribute.
+ *
+ * \param attribute Tested attribute.
+ * \return Field to compare.
+ */
+    inline Field field(Attribute attribute) {
+        return Field(attribute);
+    }
+
+/**
+ * \brief Matches figures of one type.
+ *
+ * \param type Type to match.
+ * \return Predicate.
+ */
+    inline Predicate isType(ShapeType type) {
+        return field(Attribute::Type) == static_cast<double>(type);
+    }
+
+/**
+ * \brief Matches figures whose center lies in a box (borders included).
+ *
+ * \param box Window.
+ * \return Predicate.
+ */
+    inline Predicate centerWithin(const BoundingBox &box) {
+        Predicate::Node n(Predicate::Kind::Within);
+        n.box = box;
+        return Predicate(std::make_shared<const Predicate::Node>(n));
+    }
+
+/**
+ * \brief Matches figures whose bounding box overlaps a box (touching counts).
+ *
+ * \param box Window.
+ * \return Predicate.
+ */
+    inline Predicate overlapping(const BoundingBox &box) {
+        Predicate::Node n(Predicate::Kind::Overlaps);
+        n.box = box;
+        return Predicate(std::make_shared<const Predicate::Node>(n));
+    }
+
+/**
+ * \brief Set of rows selected by a query, one bit per row.
+ */
+    class Selection {
+        private:
+            friend class FigureTable;
+
+            /**
+             * \brief Bitmap, bit i of word i / 64 is row i.
+             */
+            std::vector<std::uint64_t> m_word;
+
+            /**
+             * \brief Number of rows of the table.
+             */
+            std::size_t m_size = 0;
+
+            /**
+             * \brief Number of rows the scan evaluated.
+             */
+            std::size_t m_scanned = 0;
+
+        public:
+            /**
+             * \brief Returns whether a row is selected.
+             *
+             * \param i Row index.
+             * \return True if the row matches.
+             */
+            bool contains(std::size_t i) const {
+                return (m_word[i >> 6] >> (i & 63)) & 1;
+            }
+
+            /**
+             * \brief Returns the number of selected rows.
+             *
+             * \return Number of set bits.
+             */
+            std::size_t count() const {
+                std::size_t total = 0;
+                for (std::uint64_t w : m_word) {
+                    total += __builtin_popcountll(w);
+                }
+                return total;
+            }
+
+            /**
+             * \brief Returns the selected row indices in ascending order.
+             *
+             * \return Row indices.
+             */
+            std::vector<std::size_t> indices() const {
+                std::vector<std::size_t> out;
+                out.reserve(count());
+                for (std::size_t w = 0; w < m_word.size(); ++w) {
+                    for (std::uint64_t bits = m_word[w]; bits != 0; bits &= bits - 1) {
+                        out.push_back(w * 64 + __builtin_ctzll(bits));
+                    }
+                }
+                return out;
+            }
+
+            /**
+             * \brief Returns the number of rows the table had.
+             *
+             * \return Number of rows.
+             */
+            std::size_t size() const {
+                return m_size;
+            }
+
+            /**
+             * \brief Returns how many rows were evaluated; less than size() when the index pruned blocks.
+             *
+             * \return Number of evaluated rows.
+             */
+            std::size_t scanned() const {
+                return m_scanned;
+            }
+    };
+
+/**
+ * \brief Column store of figure attributes that evaluates predicates by scanning.
+ *
+ * Every attribute and every side of the bounding box is kept in its own
+ * array. A query walks the table in blocks of rows; every comparison is one
+ * branch-free loop over a column that writes a byte mask, which the compiler
+ * vectorizes, and the masks are combined with bitwise AND, OR and NOT. The
+ * right side of an AND is skipped for blocks where the left side matched
+ * nothing. Each block is finally packed into the selection bitmap; blocks are
+ * processed in parallel.
+ *
+ * After buildIndex(), the window of centerWithin() and overlapping()
+ * predicates that every match must satisfy (those joined by AND at the top
+ * of the expression) is looked up in a uniform grid first. The grid holds
+ * every bounding box merged with the figure's center, so both kinds of
+ * predicate can only match rows found there; the columns of those rows are
+ * gathered into blocks and only they are scanned. Windows whose cells hold
+ * more than a sixteenth of the rows are scanned in full, which is faster.
+ */
+    class FigureTable {
+        private:
+            /**
+             * \brief Rows per block, a multiple of 64.
+             */
+            static constexpr std::size_t block = 1024;
+
+            /**
+             * \brief Number of attributes.
+             */
+            static constexpr std::size_t attributes = 10;
+
+            /**
+             * \brief Figures, indexed like the rows.
+             */
+            std::vector<const Figure*> m_figures;
+
+            /**
+             * \brief One column per attribute.
+             */
+            std::array<std::vector<double>, attributes> m_column;
+
+            /**
+             * \brief Bounding boxes as columns: minX, minY, maxX, maxY.
+             */
+            std::array<std::vector<double>, 4> m_bounds;
+
+            /**
+             * \brief Grid over the rows; empty without an index.
+             */
+            UniformGrid m_grid;
+
+            /**
+             * \brief Returns the bounding box of row i.
+             */
+            BoundingBox bounds(std::size_t i) const {
+                return {m_bounds[0][i], m_bounds[1][i], m_bounds[2][i], m_bounds[3][i]};
+            }
+
+            /**
+             * \brief Returns the box of row i in the grid: its bounding box merged with its center.
+             */
+            BoundingBox cellBox(std::size_t i) const {
+                BoundingBox b = bounds(i);
+                double x = m_column[static_cast<int>(Attribute::X)][i], y = m_column[static_cast<int>(Attribute::Y)][i];
+                b.merge(BoundingBox {x, y, x, y});
+                return b;
+            }
+
+            /**
+             * \brief Collects the box predicates joined by AND at the top.
+             *
+             * \param within Intersection of the centerWithin() windows.
+             * \param hasWithin Set if there is at least one centerWithin().
+             * \param overlap Window of the first overlapping().
+             * \param hasOverlap Set if there is at least one overlapping().
+             */
+            static void collect(const Predicate::Node &n, BoundingBox &within, bool &hasWithin,
+                                BoundingBox &overlap, bool &hasOverlap) {
+                if (n.kind == Predicate::Kind::And) {
+                    collect(*n.left, within, hasWithin, overlap, hasOverlap);
+                    collect(*n.right, within, hasWithin, overlap, hasOverlap);
+                }
+                else if (n.kind == Predicate::Kind::Within) {
+                    within = {std::max(within.minX, n.box.minX), std::max(within.minY, n.box.minY),
+                              std::min(within.maxX, n.box.maxX), std::min(within.maxY, n.box.maxY)};
+                    hasWithin = true;
+                }
+                else if (n.kind == Predicate::Kind::Overlaps && !hasOverlap) {
+                    overlap = n.box;
+                    hasOverlap = true;
+                }
+            }
+
+            /**
+             * \brief Finds a window that the grid box of every matching row overlaps.
+             *
+             * The centerWithin() windows joined by AND at the top are intersected,
+             * since a matching center lies in all of them. Windows of overlapping()
+             * cannot be intersected, with each other or with centerWithin(): one
+             * figure may overlap two boxes that do not meet. Without a center
+             * window, the first overlapping() window is used alone.
+             *
+             * \return True if there is such a window.
+             */
+            static bool window(const Predicate::Node &n, BoundingBox &box) {
+                bool hasWithin = false, hasOverlap = false;
+                BoundingBox overlap {0, 0, 0, 0};
+                collect(n, box, hasWithin, overlap, hasOverlap);
+                if (!hasWithin && hasOverlap) {
+                    box = overlap;
+                }
+                return hasWithin || hasOverlap;
+            }
+
+            /**
+             * \brief Returns whether any byte of a mask is set.
+             */
+            static bool any(const std::uint8_t *mask, std::size_t count) {
+                std::uint8_t found = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    found |= mask[i];
+                }
+                return found != 0;
+            }
+
+            /**
+             * \brief Evaluates a node over count rows into a byte mask.
+             *
+             * \param columns Start of the rows in every attribute column, followed by the four bounds columns.
+             */
+            static void evaluate(const Predicate::Node &n, const double *const *columns, std::size_t count, std::uint8_t *mask) {
+                switch (n.kind) {
+                    case Predicate::Kind::Compare: {
+                        const double *c = columns[static_cast<int>(n.attribute)];
+                        const double v = n.low;
+                        switch (n.comparison) {
+                            case Comparison::Less:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = c[i] < v;
+                                break;
+                            case Comparison::LessEqual:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = c[i] <= v;
+                                break;
+                            case Comparison::Greater:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = c[i] > v;
+                                break;
+                            case Comparison::GreaterEqual:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = c[i] >= v;
+                                break;
+                            case Comparison::Equal:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = c[i] == v;
+                                break;
+                            case Comparison::NotEqual:
+                                for (std::size_t i = 0; i < count; ++i) mask[i] = (c[i] == c[i]) & (c[i] != v);
+                                break;
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::Between: {
+                        const double *c = columns[static_cast<int>(n.attribute)];
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] = (c[i] >= n.low) & (c[i] <= n.high);
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::Within: {
+                        const double *x = columns[static_cast<int>(Attribute::X)];
+                        const double *y = columns[static_cast<int>(Attribute::Y)];
+                        const BoundingBox b = n.box;
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] = (x[i] >= b.minX) & (x[i] <= b.maxX) & (y[i] >= b.minY) & (y[i] <= b.maxY);
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::Overlaps: {
+                        const double *minX = columns[attributes], *minY = columns[attributes + 1];
+                        const double *maxX = columns[attributes + 2], *maxY = columns[attributes + 3];
+                        const BoundingBox b = n.box;
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] = (minX[i] <= b.maxX) & (maxX[i] >= b.minX) & (minY[i] <= b.maxY) & (maxY[i] >= b.minY);
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::And: {
+                        evaluate(*n.left, columns, count, mask);
+                        if (!any(mask, count)) {
+                            return;
+                        }
+                        alignas(64) std::uint8_t other[block];
+                        evaluate(*n.right, columns, count, other);
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] &= other[i];
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::Or: {
+                        evaluate(*n.left, columns, count, mask);
+                        alignas(64) std::uint8_t other[block];
+                        evaluate(*n.right, columns, count, other);
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] |= other[i];
+                        }
+                        return;
+                    }
+                    case Predicate::Kind::Not: {
+                        evaluate(*n.left, columns, count, mask);
+                        for (std::size_t i = 0; i < count; ++i) {
+                            mask[i] ^= 1;
+                        }
+                        return;
+                    }
+                }
+            }
+
+            /**
+             * \brief Collects the rows whose grid box overlaps a window, each once.
+             *
+             * \param limit Largest number of entries worth visiting.
+             * \return False without collecting if the cells hold more than limit entries.
+             */
+            bool candidates(const BoundingBox &box, std::size_t limit, std::vector<std::uint32_t> &out) const {
+                if (box.minX > box.maxX || box.minY > box.maxY) {
+                    return true;
+                }
+                const int x0 = m_grid.column(box.minX), x1 = m_grid.column(box.maxX);
+                const int y0 = m_grid.row(box.minY), y1 = m_grid.row(box.maxY);
+                std::size_t entries = 0;
+                for (int y = y0; y <= y1; ++y) {
+                    entries += m_grid.cellStart[m_grid.index(x1, y) + 1] - m_grid.cellStart[m_grid.index(x0, y)];
+                }
+                if (entries > limit) {
+                    return false;
+                }
+
+                // A row spanning several cells is taken only from the first of them inside the window
+                const double *x = m_column[static_cast<int>(Attribute::X)].data();
+                const double *y = m_column[static_cast<int>(Attribute::Y)].data();
+                for (int cy = y0; cy <= y1; ++cy) {
+                    for (int cx = x0; cx <= x1; ++cx) {
+                        std::size_t cell = m_grid.index(cx, cy);
+                        for (std::uint32_t k = m_grid.cellStart[cell]; k < m_grid.cellStart[cell + 1]; ++k) {
+                            std::uint32_t i = m_grid.item[k];
+                            double minX = std::min(m_bounds[0][i], x[i]), minY = std::min(m_bounds[1][i], y[i]);
+                            if (m_grid.column(std::max(minX, box.minX)) == cx && m_grid.row(std::max(minY, box.minY)) == cy) {
+                                out.push_back(i);
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+
+        public:
+            /**
+             * \brief Extracts the attributes of figures into columns.
+             *
+             * \param figures Figures to query; they must outlive the table and not change.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             *
+             * \throws const char* If there are more than 2^32 - 1 figures.
+             */
+            FigureTable(const std::vector<const Figure*> &figures, unsigned threads = 0) : m_figures(figures) {
+                if (figures.size() >= 0xffffffffULL) {
+                    throw "Too many figures for a table";
+                }
+                const std::size_t n = figures.size();
+                const double none = std::numeric_limits<double>::quiet_NaN();
+                for (std::vector<double> &c : m_column) {
+                    c.assign(n, none);
+                }
+                for (std::vector<double> &c : m_bounds) {
+                    c.resize(n);
+                }
+                parallelFor(n, 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const Figure &f = *figures[i];
+                        auto set = [&](Attribute a, double v) {
+                            m_column[static_cast<int>(a)][i] = v;
+                        };
+                        set(Attribute::Type, static_cast<double>(f.type()));
+                        set(Attribute::X, f.getCenter().getX());
+                        set(Attribute::Y, f.getCenter().getY());
+                        set(Attribute::Area, f.area());
+                        set(Attribute::Perimeter, f.perimeter());
+                        switch (f.type()) {
+                            case ShapeType::Circle:
+                                set(Attribute::Radius, static_cast<const Circle&>(f).getRadius());
+                                break;
+                            case ShapeType::Triangle: {
+                                const auto &c = static_cast<const Triangle&>(f).getCorners();
+                                for (int k = 0; k < 3; ++k) {
+                                    double dx = double(c[(k + 1) % 3].getX()) - c[k].getX();
+                                    double dy = double(c[(k + 1) % 3].getY()) - c[k].getY();
+                                    set(static_cast<Attribute>(static_cast<int>(Attribute::SideA) + k), std::sqrt(dx * dx + dy * dy));
+                                }
+                                break;
+                            }
+                            case ShapeType::Rectangle:
+                            case ShapeType::Square:
+                                set(Attribute::SideA, static_cast<const Rectangle&>(f).getA());
+                                set(Attribute::SideB, static_cast<const Rectangle&>(f).getB());
+                                set(Attribute::Angle, 90);
+                                break;
+                            case ShapeType::Rhombus:
+                                set(Attribute::SideA, static_cast<const Rhombus&>(f).getA());
+                                set(Attribute::SideB, static_cast<const Rhombus&>(f).getA());
+                                set(Attribute::Angle, static_cast<const Rhombus&>(f).getAngle());
+                                break;
+                        }
+                        BoundingBox b = f.outline().bounds();
+                        m_bounds[0][i] = b.minX;
+                        m_bounds[1][i] = b.minY;
+                        m_bounds[2][i] = b.maxX;
+                        m_bounds[3][i] = b.maxY;
+                    }
+                }, threads);
+            }
+
+            /**
+             * \brief Builds the uniform grid used to prune box predicates.
+             *
+             * The grid is the same as in QueryScene, built over the cellBox() of every row.
+             */
+            void buildIndex() {
+                m_grid = UniformGrid();
+                if (!m_figures.empty()) {
+                    m_grid.build(m_figures.size(), [this](std::size_t i) { return cellBox(i); });
+                }
+            }
+
+            /**
+             * \brief Returns whether buildIndex() was called.
+             *
+             * \return True if box predicates are pruned through the grid.
+             */
+            bool indexed() const {
+                return !m_grid.cellStart.empty();
+            }
+
+            /**
+             * \brief Selects the rows matching a predicate.
+             *
+             * \param predicate Condition to test.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Bitmap of the matching rows.
+             */
+            Selection select(const Predicate &predicate, unsigned threads = 0) const {
+                const std::size_t n = m_figures.size();
+                Selection s;
+                s.m_size = n;
+                s.m_word.assign((n + 63) / 64, 0);
+
+                BoundingBox box {-INFINITY, -INFINITY, INFINITY, INFINITY};
+                std::vector<std::uint32_t> rows;
+                if (indexed() && window(*predicate.m_node, box) && candidates(box, n / 16, rows)) {
+                    // Gather the candidates of the window into blocks and scan only those
+                    std::vector<std::vector<std::uint32_t>> matches((rows.size() + block - 1) / block);
+                    parallelFor(matches.size(), 1, [&](std::size_t first, std::size_t last) {
+                        std::vector<double> gathered((attributes + 4) * block);
+                        const double *columns[attributes + 4];
+                        alignas(64) std::uint8_t mask[block];
+                        for (std::size_t b = first; b < last; ++b) {
+                            const std::size_t begin = b * block, count = std::min(block, rows.size() - begin);
+                            for (std::size_t c = 0; c < attributes + 4; ++c) {
+                                const double *source = c < attributes ? m_column[c].data() : m_bounds[c - attributes].data();
+                                double *target = gathered.data() + c * block;
+                                for (std::size_t i = 0; i < count; ++i) {
+                                    target[i] = source[rows[begin + i]];
+                                }
+                                columns[c] = target;
+                            }
+                            evaluate(*predicate.m_node, columns, count, mask);
+                            for (std::size_t i = 0; i < count; ++i) {
+                                if (mask[i]) {
+                                    matches[b].push_back(rows[begin + i]);
+                                }
+                            }
+                        }
+                    }, threads);
+                    for (const std::vector<std::uint32_t> &m : matches) {
+                        for (std::uint32_t i : m) {
+                            s.m_word[i / 64] |= std::uint64_t(1) << (i % 64);
+                        }
+                    }
+                    s.m_scanned = rows.size();
+                    return s;
+                }
+
+                parallelFor((n + block - 1) / block, 4, [&](std::size_t first, std::size_t last) {
+                    const double *columns[attributes + 4];
+                    alignas(64) std::uint8_t mask[block];
+                    for (std::size_t b = first; b < last; ++b) {
+                        const std::size_t begin = b * block, count = std::min(block, n - begin);
+                        for (std::size_t c = 0; c < attributes + 4; ++c) {
+                            columns[c] = (c < attributes ? m_column[c].data() : m_bounds[c - attributes].data()) + begin;
+                        }
+                        evaluate(*predicate.m_node, columns, count, mask);
+
+                        // Blocks start on word boundaries, so every block owns its words
+                        for (std::size_t i = 0; i < count; i += 64) {
+                            std::uint64_t bits = 0;
+                            for (std::size_t j = 0; j < 64 && i + j < count; ++j) {
+                                bits |= std::uint64_t(mask[i + j]) << j;
+                            }
+                            s.m_word[(begin + i) / 64] = bits;
+                        }
+                    }
+                }, threads);
+                s.m_scanned = n;
+                return s;
+            }
+
+            /**
+             * \brief Returns the selected figures.
+             *
+             * \param selection Result of select() on this table.
+             * \return Figures of the selected rows, in row order.
+             */
+            std::vector<const Figure*> figures(const Selection &selection) const {
+                std::vector<const Figure*> out;
+                for (std::size_t i : selection.indices()) {
+                    out.push_back(m_figures[i]);
+                }
+                return out;
+            }
+
+            /**
+             * \brief Returns an attribute of a row.
+             *
+             * \param attribute Attribute to read.
+             * \param i Row index.
+             * \return Value, NaN if the figure does not have the attribute.
+             */
+            double value(Attribute attribute, std::size_t i) const {
+                return m_column[static_cast<int>(attribute)][i];
+            }
+
+            /**
+             * \brief Returns the number of rows.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_figures.size();
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Figure.hpp"
+#include <string_view>
+
+namespace mw{
+
+/**
+ * \brief Non-owning handle to a figure.
+ *
+ * A view is a single pointer that can be copied freely and stored in
+ * containers without copying the figure, its name or its corners. All
+ * accessors forward to the figure and return references or views into it,
+ * so reading through a view never allocates. The figure must outlive the view.
+ *
+ * \tparam Coord Coordinate type of the figure.
+ * \tparam Scalar Type of the figure's computed values.
+ */
+    template <typename Coord, typename Scalar>
+    class BasicFigureView {
+        private:
+            /**
+             * \brief The viewed figure.
+             */
+            const BasicFigure<Coord, Scalar> *m_figure;
+
+        public:
+            /**
+             * \brief Creates a view of a figure.
+             *
+             * \param figure Figure to view.
+             */
+            BasicFigureView(const BasicFigure<Coord, Scalar> &figure) : m_figure(&figure) {}
+
+            /**
+             * \brief Creates a view of a figure.
+             *
+             * \param figure Pointer to the figure to view.
+             *
+             * \throws const char* If the pointer is null.
+             */
+            BasicFigureView(const BasicFigure<Coord, Scalar> *figure) : m_figure(figure) {
+                if (figure == nullptr) {
+                    throw "Figure cannot be null";
+                }
+            }
+
+            /**
+             * \brief Returns the viewed figure.
+             *
+             * \return Constant reference to the figure.
+             */
+            const BasicFigure<Coord, Scalar>& get() const {
+                return *m_figure;
+            }
+
+            /**
+             * \brief Calculates the area of the figure.
+             *
+             * \return Area of the figure.
+             */
+            Scalar area() const {
+                return m_figure->area();
+            }
+
+            /**
+             * \brief Calculates the perimeter of the figure.
+             *
+             * \return Perimeter of the figure.
+             */
+            Scalar perimeter() const {
+                return m_figure->perimeter();
+            }
+
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return Type of the figure.
+             */
+            ShapeType type() const {
+                return m_figure->type();
+            }
+
+            /**
+             * \brief Returns the center point of the figure.
+             *
+             * \return Constant reference to the center point.
+             */
+            const BasicPoint<Coord>& getCenter() const {
+                return m_figure->getCenter();
+            }
+
+            /**
+             * \brief Returns the name of the figure.
+             *
+             * \return View of the name, valid as long as the name is not changed.
+             */
+            std::string_view getName() const {
+                return m_figure->getName();
+            }
+
+            /**
+             * \brief Returns the outline of the figure.
+             *
+             * \return Outline of the figure.
+             */
+            Outline outline() const {
+                return m_figure->outline();
+            }
+    };
+
+/**
+ * \brief View of a figure with the default precision.
+ */
+    using FigureView = BasicFigureView<int, double>;
+
+/**
+ * \brief View of a float figure.
+ */
+    using FigureViewF = BasicFigureView<float, float>;
+
+} // namespace mw
\ No newline at end of file
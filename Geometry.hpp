@@ -0,0 +1,411 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Represents a 2D vector with floating point coordinates.
+ *
+ * Used for derived geometry (vertices of figures built from side lengths,
+ * scanline intersections) that does not fit on the integer Point grid.
+ */
+    struct Vec2 {
+        /**
+         * \brief X coordinate.
+         */
+        double x;
+
+        /**
+         * \brief Y coordinate.
+         */
+        double y;
+    };
+
+/**
+ * \brief Represents an axis-aligned bounding box.
+ *
+ * The box is closed, i.e. points lying on its border are inside.
+ */
+    struct BoundingBox {
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+
+        /**
+         * \brief Checks whether a point lies inside the box.
+         *
+         * \param p Point to test.
+         * \return True if the point is inside or on the border.
+         */
+        bool contains(const Vec2 &p) const {
+            return p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY;
+        }
+
+        /**
+         * \brief Checks whether two boxes share at least one point.
+         *
+         * \param other Box to test against.
+         * \return True if the boxes overlap or touch.
+         */
+        bool overlaps(const BoundingBox &other) const {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+
+        /**
+         * \brief Checks whether another box lies completely inside this box.
+         *
+         * \param other Box to test.
+         * \return True if the other box is inside or on the border.
+         */
+        bool contains(const BoundingBox &other) const {
+            return other.minX >= minX && other.maxX <= maxX && other.minY >= minY && other.maxY <= maxY;
+        }
+
+        /**
+         * \brief Returns the perimeter of the box.
+         *
+         * \return Perimeter, used as the cost of a box in bounding volume trees.
+         */
+        double perimeter() const {
+            return 2 * ((maxX - minX) + (maxY - minY));
+        }
+
+        /**
+         * \brief Grows the box so it also covers another box.
+         *
+         * \param other Box to include.
+         */
+        void merge(const BoundingBox &other) {
+            minX = std::min(minX, other.minX);
+            minY = std::min(minY, other.minY);
+            maxX = std::max(maxX, other.maxX);
+            maxY = std::max(maxY, other.maxY);
+        }
+    };
+
+/**
+ * \brief Describes the exact boundary of a figure.
+ *
+ * Every figure in the library is either a circle or a convex polygon with at
+ * most four vertices. Polygon vertices are stored in counter-clockwise order,
+ * so algorithms working on the outline do not have to care about the order in
+ * which corners were passed to the figure constructors.
+ */
+    struct Outline {
+        /**
+         * \brief True if the outline is a circle, false for polygons.
+         */
+        bool isCircle = false;
+
+        /**
+         * \brief Center of the circle (only meaningful for circles).
+         */
+        Vec2 center {0, 0};
+
+        /**
+         * \brief Radius of the circle (only meaningful for circles).
+         */
+        double radius = 0;
+
+        /**
+         * \brief Number of polygon vertices (3 or 4, 0 for circles).
+         */
+        int size = 0;
+
+        /**
+         * \brief Polygon vertices in counter-clockwise order.
+         */
+        std::array<Vec2, 4> vertex {};
+
+        /**
+         * \brief Returns the smallest axis-aligned box containing the outline.
+         *
+         * \return Bounding box of the outline.
+         */
+        BoundingBox bounds() const {
+            if (isCircle) {
+                return {center.x - radius, center.y - radius, center.x + radius, center.y + radius};
+            }
+            BoundingBox box {vertex[0].x, vertex[0].y, vertex[0].x, vertex[0].y};
+            for (int i = 1; i < size; ++i) {
+                box.minX = std::min(box.minX, vertex[i].x);
+                box.minY = std::min(box.minY, vertex[i].y);
+                box.maxX = std::max(box.maxX, vertex[i].x);
+                box.maxY = std::max(box.maxY, vertex[i].y);
+            }
+            return box;
+        }
+
+        /**
+         * \brief Checks whether a point lies inside the outline.
+         *
+         * \param p Point to test.
+         * \return True if the point is inside or on the boundary.
+         */
+        bool contains(const Vec2 &p) const {
+            if (isCircle) {
+                return squaredDistance(p, center) <= radius * radius;
+            }
+            for (int i = 0; i < size; ++i) {
+                if (cross(vertex[i], vertex[(i + 1) % size], p) < 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * \brief Returns the distance from a point to the figure.
+         *
+         * \param p Point to measure from.
+         * \return 0 if the point is inside, otherwise the distance to the boundary.
+         */
+        double distanceTo(const Vec2 &p) const {
+            if (isCircle) {
+                return std::max(0.0, std::sqrt(squaredDistance(p, center)) - radius);
+            }
+            if (contains(p)) {
+                return 0;
+            }
+            double best = segmentSquaredDistance(p, vertex[0], vertex[1]);
+            for (int i = 1; i < size; ++i) {
+                best = std::min(best, segmentSquaredDistance(p, vertex[i], vertex[(i + 1) % size]));
+            }
+            return std::sqrt(best);
+        }
+
+        /**
+         * \brief Returns the largest distance from a point to any point of the figure.
+         *
+         * \param p Point to measure from.
+         * \return Distance to the farthest point of the figure.
+         */
+        double extentFrom(const Vec2 &p) const {
+            if (isCircle) {
+                return std::sqrt(squaredDistance(p, center)) + radius;
+            }
+            double best = 0;
+            for (int i = 0; i < size; ++i) {
+                best = std::max(best, squaredDistance(p, vertex[i]));
+            }
+            return std::sqrt(best);
+        }
+
+        /**
+         * \brief Returns the z component of the cross product (b - a) x (c - a).
+         *
+         * \return Positive if a, b, c turn counter-clockwise, negative if clockwise, 0 if collinear.
+         */
+        static double cross(const Vec2 &a, const Vec2 &b, const Vec2 &c) {
+            return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        }
+
+        /**
+         * \brief Returns the squared distance between two points.
+         */
+        static double squaredDistance(const Vec2 &a, const Vec2 &b) {
+            return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+        }
+
+        /**
+         * \brief Returns the squared distance from a point to the segment [a, b].
+         */
+        static double segmentSquaredDistance(const Vec2 &p, const Vec2 &a, const Vec2 &b) {
+            double dx = b.x - a.x;
+            double dy = b.y - a.y;
+            double length2 = dx * dx + dy * dy;
+            double t = length2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0;
+            t = std::min(1.0, std::max(0.0, t));
+            return squaredDistance(p, {a.x + t * dx, a.y + t * dy});
+        }
+
+        /**
+         * \brief Creates a circular outline.
+         *
+         * \param center Center of the circle.
+         * \param radius Radius of the circle.
+         * \return Circle outline.
+         */
+        static Outline circle(const Vec2 &center, double radius) {
+            Outline o;
+            o.isCircle = true;
+            o.center = center;
+            o.radius = radius;
+            return o;
+        }
+
+        /**
+         * \brief Creates a convex polygon outline from vertices in any order.
+         *
+         * The vertices are sorted by angle around their centroid, which gives
+         * counter-clockwise order for any convex polygon.
+         *
+         * \param points Polygon vertices.
+         * \param n Number of vertices (3 or 4).
+         * \return Polygon outline.
+         */
+        static Outline polygon(const std::array<Vec2, 4> &points, int n) {
+            Outline o;
+            o.size = n;
+            double cx = 0, cy = 0;
+            for (int i = 0; i < n; ++i) {
+                cx += points[i].x;
+                cy += points[i].y;
+            }
+            cx /= n;
+            cy /= n;
+            // Insertion sort by angle: at most four vertices, each angle computed once
+            std::array<double, 4> angle {};
+            for (int i = 0; i < n && i < 4; ++i) {
+                double a = std::atan2(points[i].y - cy, points[i].x - cx);
+                int j = i;
+                for (; j > 0 && a < angle[j - 1]; --j) {
+                    angle[j] = angle[j - 1];
+                    o.vertex[j] = o.vertex[j - 1];
+                }
+                angle[j] = a;
+                o.vertex[j] = points[i];
+            }
+            o.center = {cx, cy};
+            return o;
+        }
+    };
+
+/**
+ * \brief Uniform grid over bounding boxes, stored in compressed rows.
+ *
+ * Every box is listed in each cell it touches and the entries of a cell are
+ * contiguous in item, so visiting a cell is a walk over one array slice.
+ * Cells are about as large as an average box, but there are never more cells
+ * than boxes and at most 4096 in either direction.
+ */
+    struct UniformGrid {
+        /**
+         * \brief First entry of every cell in item, plus one past the end; empty before build().
+         */
+        std::vector<std::uint32_t> cellStart;
+
+        /**
+         * \brief Box indices, grouped by cell.
+         */
+        std::vector<std::uint32_t> item;
+
+        /**
+         * \brief Union of all boxes.
+         */
+        BoundingBox bounds {0, 0, 0, 0};
+
+        /**
+         * \brief Width and height of a cell.
+         */
+        double cell = 1;
+
+        /**
+         * \brief Number of columns.
+         */
+        int columns = 1;
+
+        /**
+         * \brief Number of rows.
+         */
+        int rows = 1;
+
+        /**
+         * \brief Returns the column of an x coordinate, clamped to the grid.
+         */
+        int column(double x) const {
+            return clamp((x - bounds.minX) / cell, columns);
+        }
+
+        /**
+         * \brief Returns the row of a y coordinate, clamped to the grid.
+         */
+        int row(double y) const {
+            return clamp((y - bounds.minY) / cell, rows);
+        }
+
+        /**
+         * \brief Converts a position in cells to a cell in [0, count).
+         *
+         * Clamps before the conversion, which is undefined for values outside
+         * the int range; NaN maps to 0.
+         */
+        static int clamp(double cells, int count) {
+            if (!(cells > 0)) {
+                return 0;
+            }
+            return cells < count - 1 ? static_cast<int>(cells) : count - 1;
+        }
+
+        /**
+         * \brief Returns the index of a cell in cellStart.
+         */
+        std::size_t index(int x, int y) const {
+            return std::size_t(y) * columns + x;
+        }
+
+        /**
+         * \brief Fills the grid with boxes.
+         *
+         * \param n Number of boxes, below 2^32.
+         * \param box Callable returning the BoundingBox of index i; called three times per box.
+         */
+        template <typename Box>
+        void build(std::size_t n, Box box) {
+            item.clear();
+            if (n == 0) {
+                bounds = {0, 0, 0, 0};
+                cell = 1;
+                columns = rows = 1;
+                cellStart = {0, 0};
+                return;
+            }
+
+            double extent = 0;
+            bounds = box(0);
+            for (std::size_t i = 0; i < n; ++i) {
+                BoundingBox b = box(i);
+                bounds.merge(b);
+                extent += std::max(b.maxX - b.minX, b.maxY - b.minY);
+            }
+
+            // Cells about as large as an average box, but not more cells than boxes
+            double width = bounds.maxX - bounds.minX, height = bounds.maxY - bounds.minY;
+            cell = std::max({extent / n, std::sqrt(width * height / n), 1e-9});
+            columns = std::min(4096, static_cast<int>(width / cell) + 1);
+            rows = std::min(4096, static_cast<int>(height / cell) + 1);
+            cell = std::max({cell, width / columns, height / rows});
+
+            cellStart.assign(std::size_t(columns) * rows + 1, 0);
+            for (std::size_t i = 0; i < n; ++i) {
+                BoundingBox b = box(i);
+                for (int y = row(b.minY); y <= row(b.maxY); ++y) {
+                    for (int x = column(b.minX); x <= column(b.maxX); ++x) {
+                        ++cellStart[index(x, y) + 1];
+                    }
+                }
+            }
+            for (std::size_t c = 1; c < cellStart.size(); ++c) {
+                cellStart[c] += cellStart[c - 1];
+            }
+            item.resize(cellStart.back());
+            std::vector<std::uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+            for (std::size_t i = 0; i < n; ++i) {
+                BoundingBox b = box(i);
+                for (int y = row(b.minY); y <= row(b.maxY); ++y) {
+                    for (int x = column(b.minX); x <= column(b.maxX); ++x) {
+                        item[fill[index(x, y)]++] = static_cast<std::uint32_t>(i);
+                    }
+                }
+            }
+        }
+    };
+
+} // namespace mw
\ No newline at end of file
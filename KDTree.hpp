@@ -0,0 +1,290 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Result of a nearest-neighbor query.
+ */
+    struct Neighbor {
+        /**
+         * \brief Index of the figure in the collection the tree was built from.
+         */
+        std::size_t index;
+
+        /**
+         * \brief The figure itself.
+         */
+        const Figure *figure;
+
+        /**
+         * \brief Distance from the query point (to the center or to the boundary).
+         */
+        double distance;
+    };
+
+/**
+ * \brief Static KD-tree over figure centers.
+ *
+ * The tree is stored implicitly in one array: the median of every range is
+ * the node and the two halves are its subtrees, with the split axis
+ * alternating between X and Y per level. Each node also keeps the largest
+ * distance from a center to the farthest point of its figure within its
+ * subtree, which lets the boundary-distance queries prune subtrees just like
+ * the center queries do.
+ */
+    class KDTree {
+        private:
+            /**
+             * \brief Figure center with the figure's index.
+             */
+            struct Entry {
+                double x;
+                double y;
+                double extent;
+                std::uint32_t index;
+            };
+
+            /**
+             * \brief Figures the tree was built from.
+             */
+            std::vector<const Figure*> m_figures;
+
+            /**
+             * \brief Outlines of the figures, indexed like m_figures.
+             */
+            std::vector<Outline> m_outlines;
+
+            /**
+             * \brief Tree nodes in implicit layout.
+             */
+            std::vector<Entry> m_entry;
+
+            /**
+             * \brief Largest figure extent around its center in each subtree.
+             */
+            std::vector<double> m_extent;
+
+            /**
+             * \brief Builds the subtree for the range [lo, hi).
+             *
+             * \param lo First entry of the range.
+             * \param hi One past the last entry of the range.
+             * \param depth Depth of the subtree root.
+             * \param spawn Number of levels which still start a new thread.
+             * \return Largest extent within the subtree.
+             */
+            double build(std::size_t lo, std::size_t hi, int depth, int spawn) {
+                if (lo >= hi) {
+                    return 0;
+                }
+                std::size_t mid = lo + (hi - lo) / 2;
+                bool byX = depth % 2 == 0;
+                std::nth_element(m_entry.begin() + lo, m_entry.begin() + mid, m_entry.begin() + hi,
+                    [byX](const Entry &a, const Entry &b) { return byX ? a.x < b.x : a.y < b.y; });
+
+                double left = 0, right = 0;
+                if (spawn > 0 && hi - lo > 65536) {
+                    std::thread worker([&]() { left = build(lo, mid, depth + 1, spawn - 1); });
+                    right = build(mid + 1, hi, depth + 1, spawn - 1);
+                    worker.join();
+                }
+                else {
+                    left = build(lo, mid, depth + 1, 0);
+                    right = build(mid + 1, hi, depth + 1, 0);
+                }
+                m_extent[mid] = std::max({m_entry[mid].extent, left, right});
+                return m_extent[mid];
+            }
+
+            /**
+             * \brief Returns the distance from a point to an entry.
+             *
+             * \param e Entry to measure to.
+             * \param p Query point.
+             * \param boundary True to measure to the figure boundary, false to its center.
+             */
+            double distance(const Entry &e, const Vec2 &p, bool boundary) const {
+                if (boundary) {
+                    return m_outlines[e.index].distanceTo(p);
+                }
+                return std::sqrt(Outline::squaredDistance({e.x, e.y}, p));
+            }
+
+            /**
+             * \brief Recursive k-nearest search over the range [lo, hi).
+             */
+            template <typename Heap>
+            void nearest(std::size_t lo, std::size_t hi, int depth, const Vec2 &p, std::size_t k,
+                         bool boundary, Heap &heap) const {
+                if (lo >= hi) {
+                    return;
+                }
+                std::size_t mid = lo + (hi - lo) / 2;
+                const Entry &e = m_entry[mid];
+                double d = distance(e, p, boundary);
+                if (heap.size() < k) {
+                    heap.push({d, e.index});
+                }
+                else if (d < heap.top().first) {
+                    heap.pop();
+                    heap.push({d, e.index});
+                }
+
+                double diff = depth % 2 == 0 ? p.x - e.x : p.y - e.y;
+                std::size_t nearLo = diff < 0 ? lo : mid + 1;
+                std::size_t nearHi = diff < 0 ? mid : hi;
+                std::size_t farLo = diff < 0 ? mid + 1 : lo;
+                std::size_t farHi = diff < 0 ? hi : mid;
+
+                nearest(nearLo, nearHi, depth + 1, p, k, boundary, heap);
+                if (farLo < farHi) {
+                    double bound = std::abs(diff);
+                    if (boundary) {
+                        bound -= m_extent[farLo + (farHi - farLo) / 2];
+                    }
+                    if (heap.size() < k || bound < heap.top().first) {
+                        nearest(farLo, farHi, depth + 1, p, k, boundary, heap);
+                    }
+                }
+            }
+
+            /**
+             * \brief Recursive radius search over the range [lo, hi).
+             */
+            void within(std::size_t lo, std::size_t hi, int depth, const Vec2 &p, double r,
+                        bool boundary, std::vector<Neighbor> &out) const {
+                if (lo >= hi) {
+                    return;
+                }
+                std::size_t mid = lo + (hi - lo) / 2;
+                const Entry &e = m_entry[mid];
+                double d = distance(e, p, boundary);
+                if (d <= r) {
+                    out.push_back({e.index, m_figures[e.index], d});
+                }
+
+                double diff = depth % 2 == 0 ? p.x - e.x : p.y - e.y;
+                double slack = boundary ? m_extent[mid] : 0;
+                if (diff - slack <= r) {
+                    within(lo, mid, depth + 1, p, r, boundary, out);
+                }
+                if (-diff - slack <= r) {
+                    within(mid + 1, hi, depth + 1, p, r, boundary, out);
+                }
+            }
+
+            /**
+             * \brief Shared implementation of the nearest-neighbor queries.
+             */
+            std::vector<Neighbor> nearest(const Vec2 &p, std::size_t k, bool boundary) const {
+                std::vector<Neighbor> out;
+                if (k == 0) {
+                    return out;
+                }
+                std::priority_queue<std::pair<double, std::uint32_t>> heap;
+                nearest(0, m_entry.size(), 0, p, k, boundary, heap);
+                out.resize(heap.size());
+                for (std::size_t i = out.size(); i-- > 0; heap.pop()) {
+                    out[i] = {heap.top().second, m_figures[heap.top().second], heap.top().first};
+                }
+                return out;
+            }
+
+        public:
+            /**
+             * \brief Builds a tree over the centers of the given figures.
+             *
+             * Top levels of the tree are built on separate threads.
+             *
+             * \param figures Figures to index; they must outlive the tree.
+             * \param threads Number of build threads, 0 means one per hardware thread.
+             */
+            KDTree(const std::vector<const Figure*> &figures, unsigned threads = 0)
+                : m_figures(figures), m_outlines(figures.size()), m_entry(figures.size()), m_extent(figures.size()) {
+                parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        Point c = figures[i]->getCenter();
+                        m_outlines[i] = figures[i]->outline();
+                        m_entry[i] = {double(c.getX()), double(c.getY()), 0, static_cast<std::uint32_t>(i)};
+                        m_entry[i].extent = m_outlines[i].extentFrom({m_entry[i].x, m_entry[i].y});
+                    }
+                }, threads);
+
+                int spawn = 0;
+                for (unsigned t = threadCount(threads); t > 1; t /= 2) {
+                    ++spawn;
+                }
+                build(0, m_entry.size(), 0, spawn);
+            }
+
+            /**
+             * \brief Returns the number of indexed figures.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_entry.size();
+            }
+
+            /**
+             * \brief Finds the k figures whose centers are closest to a point.
+             *
+             * \param p Query point.
+             * \param k Number of neighbors.
+             * \return Up to k neighbors, closest first.
+             */
+            std::vector<Neighbor> nearest(const Point &p, std::size_t k) const {
+                return nearest({double(p.getX()), double(p.getY())}, k, false);
+            }
+
+            /**
+             * \brief Finds the k figures whose boundaries are closest to a point.
+             *
+             * The distance is exact for every figure type and is 0 for figures
+             * containing the point.
+             *
+             * \param p Query point.
+             * \param k Number of neighbors.
+             * \return Up to k neighbors, closest first.
+             */
+            std::vector<Neighbor> nearestByBoundary(const Point &p, std::size_t k) const {
+                return nearest({double(p.getX()), double(p.getY())}, k, true);
+            }
+
+            /**
+             * \brief Finds all figures whose centers lie within a radius of a point.
+             *
+             * \param p Query point.
+             * \param r Search radius.
+             * \return Matching figures in no particular order.
+             */
+            std::vector<Neighbor> withinRadius(const Point &p, double r) const {
+                std::vector<Neighbor> out;
+                within(0, m_entry.size(), 0, {double(p.getX()), double(p.getY())}, r, false, out);
+                return out;
+            }
+
+            /**
+             * \brief Finds all figures whose boundaries lie within a radius of a point.
+             *
+             * \param p Query point.
+             * \param r Search radius.
+             * \return Matching figures in no particular order.
+             */
+            std::vector<Neighbor> withinRadiusByBoundary(const Point &p, double r) const {
+                std::vector<Neighbor> out;
+                within(0, m_entry.size(), 0, {double(p.getX()), double(p.getY())}, r, true, out);
+                return out;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
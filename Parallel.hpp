@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Returns the number of worker threads to use.
+ *
+ * \param requested Requested number of threads, 0 means one per hardware thread.
+ * \return Number of threads, always at least 1.
+ */
+    inline unsigned threadCount(unsigned requested = 0) {
+        if (requested == 0) {
+            requested = std::thread::hardware_concurrency();
+        }
+        return requested == 0 ? 1 : requested;
+    }
+
+/**
+ * \brief Runs a function over the range [0, count) on several threads.
+ *
+ * The range is split into chunks of \p grain elements which are handed out
+ * dynamically, so uneven work per element is balanced between threads. The
+ * function is called as fn(begin, end) once per chunk. If any call throws,
+ * the remaining chunks are skipped and the first exception is rethrown in
+ * the calling thread.
+ *
+ * \param count Number of elements.
+ * \param grain Number of elements per chunk (at least 1).
+ * \param fn Function called for each chunk.
+ * \param threads Number of threads, 0 means one per hardware thread.
+ */
+    template <typename Fn>
+    void parallelFor(std::size_t count, std::size_t grain, Fn fn, unsigned threads = 0) {
+        if (count == 0) {
+            return;
+        }
+        grain = std::max<std::size_t>(grain, 1);
+        std::size_t chunks = (count + grain - 1) / grain;
+        unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threadCount(threads), chunks));
+
+        if (workers == 1) {
+            for (std::size_t begin = 0; begin < count; begin += grain) {
+                fn(begin, std::min(begin + grain, count));
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next {0};
+        std::atomic<bool> failed {false};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto work = [&]() {
+            while (!failed.load(std::memory_order_relaxed)) {
+                std::size_t chunk = next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunks) {
+                    return;
+                }
+                std::size_t begin = chunk * grain;
+                try {
+                    fn(begin, std::min(begin + grain, count));
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < workers; ++i) {
+            pool.emplace_back(work);
+        }
+        work();
+        for (std::thread &t : pool) {
+            t.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+} // namespace mw
\ No newline at end of file
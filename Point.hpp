@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
 
@@ -8,25 +10,30 @@ namespace mw{
 /**
  * \brief Represents a point in 2D space.
  *
- * The Point class stores two non-negative integer coordinates (x, y)
+ * The BasicPoint class stores two non-negative coordinates (x, y)
  * and provides basic operations such as comparison, addition,
- * subtraction, and coordinate modification.
+ * subtraction, and coordinate modification. The coordinate type is a
+ * template parameter; Point (int coordinates) is the default used across
+ * the library and PointF (float coordinates) is meant for bulk work.
+ *
+ * \tparam T Coordinate type.
  */
-    class Point {
+    template <typename T>
+    class BasicPoint {
         private:
             /**
              * \brief X coordinate of the point.
              *
-             * Must be a non-negative integer.
+             * Must be non-negative.
              */
-            int m_x;
+            T m_x;
 
             /**
              * \brief Y coordinate of the point.
              *
-             * Must be a non-negative integer.
+             * Must be non-negative.
              */
-            int m_y;
+            T m_y;
         
         public:
             /**
@@ -34,7 +41,7 @@ namespace mw{
              *
              * Default constructor that initializes both coordinates to zero.
              */
-            Point() : m_x(0), m_y(0) {}
+            BasicPoint() : m_x(0), m_y(0) {}
 
             /**
              * \brief Creates a point with given coordinates.
@@ -47,7 +54,7 @@ namespace mw{
              *
              * \throw const char* If x or y is less than 0.
             */
-            Point(int x, int y) {
+            BasicPoint(T x, T y) {
                 setX(x);
                 setY(y);
             }
@@ -55,14 +62,14 @@ namespace mw{
             /**
              * \brief Default destructor.
              */
-                ~Point() = default;
+                ~BasicPoint() = default;
     
             /**
              * \brief Returns the X coordinate.
              *
              * \return X coordinate of the point.
              */
-            int getX() const {
+            T getX() const {
                 return m_x;
             }
 
@@ -71,7 +78,7 @@ namespace mw{
              *
              * \return Y coordinate of the point.
              */
-            int getY() const {
+            T getY() const {
                 return m_y;
             }
 
@@ -82,7 +89,7 @@ namespace mw{
              *
              * \throw const char* If x is less than 0.
              */
-            void setX(int x) {
+            void setX(T x) {
                 if (x < 0) {
                     throw "x cannot be less than 0";
                 }
@@ -96,7 +103,7 @@ namespace mw{
              *
              * \throw const char* If y is less than 0.
              */
-            void setY(int y) {
+            void setY(T y) {
                 if (y < 0) {
                     throw "y cannot be less than 0";
                 }
@@ -111,7 +118,7 @@ namespace mw{
              * \param other Point to compare with.
              * \return True if points are equal, false otherwise.
              */
-            bool operator==(const Point& other) {
+            bool operator==(const BasicPoint& other) const {
                 if((m_x == other.m_x) && (m_y == other.m_y)) {
                     return true;
                 }
@@ -129,8 +136,8 @@ namespace mw{
              * \param other Point to add.
              * \return New point representing the sum.
              */
-            Point operator+(const Point& other) {
-                return Point(m_x + other.m_x, m_y + other.m_y);
+            BasicPoint operator+(const BasicPoint& other) {
+                return BasicPoint(m_x + other.m_x, m_y + other.m_y);
             }
 
             /**
@@ -142,7 +149,7 @@ namespace mw{
              * \param other Point to add.
              * \return Reference to the modified point.
              */
-            Point& operator+=(const Point& other) {
+            BasicPoint& operator+=(const BasicPoint& other) {
                 m_x += other.m_x;
                 m_y += other.m_y;
             return *this;
@@ -157,8 +164,8 @@ namespace mw{
              * \param other Point to subtract.
              * \return New point representing the difference.
              */
-            Point operator-(const Point& other) {
-                return Point(m_x - other.m_x, m_y - other.m_y);
+            BasicPoint operator-(const BasicPoint& other) {
+                return BasicPoint(m_x - other.m_x, m_y - other.m_y);
             }
     
             /**
@@ -170,11 +177,39 @@ namespace mw{
              * \param other Point to subtract.
              * \return Reference to the modified point.
              */
-            Point& operator-=(const Point& other) {
+            BasicPoint& operator-=(const BasicPoint& other) {
                 m_x -= other.m_x;
                 m_y -= other.m_y;
                 return *this;
             }
     };
 
-} // namespace mw
\ No newline at end of file
+/**
+ * \brief Point with integer coordinates, the default used across the library.
+ */
+    using Point = BasicPoint<int>;
+
+/**
+ * \brief Point with float coordinates for bulk work.
+ */
+    using PointF = BasicPoint<float>;
+
+} // namespace mw
+
+namespace std{
+
+/**
+ * \brief Hash function for points, so points can be used in unordered containers.
+ */
+    template <typename T>
+    struct hash<mw::BasicPoint<T>> {
+        size_t operator()(const mw::BasicPoint<T> &p) const {
+            uint64_t h = (uint64_t(hash<T>()(p.getX())) << 32) ^ uint64_t(hash<T>()(p.getY()));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+    };
+
+} // namespace std
\ No newline at end of file
@@ -0,0 +1,464 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Number, total area and number per type of a set of figures.
+ */
+    struct RegionTotals {
+        /**
+         * \brief Number of figures.
+         */
+        std::size_t count = 0;
+
+        /**
+         * \brief Sum of the areas.
+         */
+        double area = 0;
+
+        /**
+         * \brief Number of figures of every type, indexed by ShapeType.
+         */
+        std::array<std::size_t, 5> types {};
+
+        /**
+         * \brief Adds the totals of another set.
+         *
+         * \param other Totals to add.
+         */
+        void add(const RegionTotals &other) {
+            count += other.count;
+            area += other.area;
+            for (std::size_t t = 0; t < types.size(); ++t) {
+                types[t] += other.types[t];
+            }
+        }
+    };
+
+/**
+ * \brief Quadtree over figure centers with precomputed totals in every node.
+ *
+ * Every node stores the number, the total area and the number per type of the
+ * figures whose center lies in its square. A range query adds up the totals
+ * of the nodes inside the window and only visits the figures of leaves that
+ * cross its border, so it costs about O(log N + boundary) instead of a pass
+ * over all figures.
+ *
+ * Leaves hold up to a fixed number of figures and split when they get more;
+ * a subtree that falls back to that number after removals collapses into one
+ * leaf. Adding, removing or updating a figure changes the totals along one
+ * root-to-leaf path. The root grows when a figure lies outside it, so the
+ * initial bounds are only a hint.
+ *
+ * Figures are referred to by the proxy id returned from insert(). The tree
+ * keeps pointers to the figures, so they must outlive it; call update() after
+ * moving a figure or changing its size.
+ */
+    class AggregateQuadTree {
+        private:
+            /**
+             * \brief Marks a missing node, slot or list entry.
+             */
+            static constexpr int null = -1;
+
+            /**
+             * \brief Smallest node that still splits; centers are integers, so smaller nodes do not separate them.
+             */
+            static constexpr double minimumSize = 1;
+
+            /**
+             * \brief Square [x, x + size) x [y, y + size) with its totals; free nodes are chained through child[0].
+             */
+            struct Node {
+                double x;
+                double y;
+                double size;
+                int parent;
+                std::array<int, 4> child;
+                int first;
+                RegionTotals totals;
+            };
+
+            /**
+             * \brief One figure with its cached values; free slots are chained through next.
+             */
+            struct Slot {
+                Figure *figure;
+                double x;
+                double y;
+                double area;
+                ShapeType type;
+                int node;
+                int prev;
+                int next;
+            };
+
+            /**
+             * \brief All nodes.
+             */
+            std::vector<Node> m_node;
+
+            /**
+             * \brief All slots.
+             */
+            std::vector<Slot> m_slot;
+
+            /**
+             * \brief Root node.
+             */
+            int m_root;
+
+            /**
+             * \brief First free node or null.
+             */
+            int m_freeNode = null;
+
+            /**
+             * \brief First free slot or null.
+             */
+            int m_freeSlot = null;
+
+            /**
+             * \brief Largest number of figures in a leaf.
+             */
+            std::size_t m_capacity;
+
+            /**
+             * \brief Returns a new leaf.
+             */
+            int allocate(double x, double y, double size, int parent) {
+                int id = m_freeNode;
+                if (id == null) {
+                    m_node.push_back(Node {});
+                    id = static_cast<int>(m_node.size()) - 1;
+                }
+                else {
+                    m_freeNode = m_node[id].child[0];
+                }
+                m_node[id] = Node {x, y, size, parent, {null, null, null, null}, null, RegionTotals {}};
+                return id;
+            }
+
+            /**
+             * \brief Returns whether a point lies in the square of a node.
+             */
+            bool inside(int n, double x, double y) const {
+                const Node &node = m_node[n];
+                return x >= node.x && x < node.x + node.size && y >= node.y && y < node.y + node.size;
+            }
+
+            /**
+             * \brief Returns the child quadrant of a node containing a point.
+             */
+            int quadrant(int n, double x, double y) const {
+                const Node &node = m_node[n];
+                double half = node.size / 2;
+                return (x >= node.x + half ? 1 : 0) | (y >= node.y + half ? 2 : 0);
+            }
+
+            /**
+             * \brief Adds (sign 1) or subtracts (sign -1) a figure from the totals of a node and its ancestors.
+             */
+            void addPath(int n, const Slot &s, int sign) {
+                for (; n != null; n = m_node[n].parent) {
+                    RegionTotals &t = m_node[n].totals;
+                    t.count += sign;
+                    t.area += sign * s.area;
+                    t.types[static_cast<int>(s.type)] += sign;
+                }
+            }
+
+            /**
+             * \brief Prepends a slot to the list of a leaf without touching totals.
+             */
+            void attach(int id, int leaf) {
+                Slot &s = m_slot[id];
+                s.node = leaf;
+                s.prev = null;
+                s.next = m_node[leaf].first;
+                if (s.next != null) {
+                    m_slot[s.next].prev = id;
+                }
+                m_node[leaf].first = id;
+            }
+
+            /**
+             * \brief Removes a slot from the list of its leaf without touching totals.
+             */
+            void detach(int id) {
+                Slot &s = m_slot[id];
+                if (s.prev != null) {
+                    m_slot[s.prev].next = s.next;
+                }
+                else {
+                    m_node[s.node].first = s.next;
+                }
+                if (s.next != null) {
+                    m_slot[s.next].prev = s.prev;
+                }
+            }
+
+            /**
+             * \brief Doubles the root until it contains a point.
+             */
+            void grow(double x, double y) {
+                while (!inside(m_root, x, y)) {
+                    const Node old = m_node[m_root];
+                    double nx = x < old.x ? old.x - old.size : old.x;
+                    double ny = y < old.y ? old.y - old.size : old.y;
+                    int root = allocate(nx, ny, old.size * 2, null);
+                    m_node[root].totals = old.totals;
+                    if (old.first == null && old.child[0] == null) {
+                        // An empty leaf is simply replaced
+                        m_node[m_root].child[0] = m_freeNode;
+                        m_freeNode = m_root;
+                    }
+                    else {
+                        int q = (old.x > nx ? 1 : 0) | (old.y > ny ? 2 : 0);
+                        for (int c = 0; c < 4; ++c) {
+                            m_node[root].child[c] = c == q ? m_root : allocate(nx + (c & 1) * old.size, ny + (c >> 1) * old.size, old.size, root);
+                        }
+                        m_node[m_root].parent = root;
+                    }
+                    m_root = root;
+                }
+            }
+
+            /**
+             * \brief Splits a leaf that holds too many figures, repeating in the children.
+             */
+            void split(int n) {
+                if (m_node[n].totals.count <= m_capacity || m_node[n].size <= minimumSize) {
+                    return;
+                }
+                double half = m_node[n].size / 2;
+                for (int c = 0; c < 4; ++c) {
+                    int child = allocate(m_node[n].x + (c & 1) * half, m_node[n].y + (c >> 1) * half, half, n);
+                    m_node[n].child[c] = child;
+                }
+                for (int id = m_node[n].first; id != null;) {
+                    Slot &s = m_slot[id];
+                    int next = s.next;
+                    int child = m_node[n].child[quadrant(n, s.x, s.y)];
+                    attach(id, child);
+                    RegionTotals &t = m_node[child].totals;
+                    ++t.count;
+                    t.area += s.area;
+                    ++t.types[static_cast<int>(s.type)];
+                    id = next;
+                }
+                m_node[n].first = null;
+                for (int c = 0; c < 4; ++c) {
+                    split(m_node[n].child[c]);
+                }
+            }
+
+            /**
+             * \brief Moves all figures of the subtrees of a node into the node and frees the subtrees.
+             */
+            void collapse(int n, int into) {
+                if (m_node[n].child[0] == null) {
+                    for (int id = m_node[n].first; id != null;) {
+                        int next = m_slot[id].next;
+                        attach(id, into);
+                        id = next;
+                    }
+                }
+                else {
+                    for (int c = 0; c < 4; ++c) {
+                        collapse(m_node[n].child[c], into);
+                        m_node[n].child[c] = null;
+                    }
+                }
+                if (n != into) {
+                    m_node[n].child[0] = m_freeNode;
+                    m_freeNode = n;
+                }
+                else {
+                    m_node[n].child = {null, null, null, null};
+                }
+            }
+
+            /**
+             * \brief Puts a slot into the leaf containing its center and adds it to the totals.
+             */
+            void link(int id) {
+                Slot &s = m_slot[id];
+                grow(s.x, s.y);
+                int n = m_root;
+                while (m_node[n].child[0] != null) {
+                    n = m_node[n].child[quadrant(n, s.x, s.y)];
+                }
+                attach(id, n);
+                addPath(n, s, 1);
+                split(n);
+            }
+
+            /**
+             * \brief Takes a slot out of its leaf and the totals, collapsing subtrees that became small.
+             */
+            void unlink(int id) {
+                Slot &s = m_slot[id];
+                detach(id);
+                addPath(s.node, s, -1);
+                int highest = null;
+                for (int n = m_node[s.node].parent; n != null; n = m_node[n].parent) {
+                    if (m_node[n].totals.count <= m_capacity) {
+                        highest = n;
+                    }
+                }
+                if (highest != null) {
+                    collapse(highest, highest);
+                }
+            }
+
+        public:
+            /**
+             * \brief Creates an empty tree.
+             *
+             * \param bounds Expected area of the figure centers; the tree grows beyond it if needed.
+             * \param capacity Largest number of figures in a leaf (at least 1).
+             */
+            AggregateQuadTree(const BoundingBox &bounds, std::size_t capacity = 8) : m_capacity(std::max<std::size_t>(capacity, 1)) {
+                double size = std::max({bounds.maxX - bounds.minX, bounds.maxY - bounds.minY, minimumSize});
+                // Half-open squares: make room for centers on the upper border
+                m_root = allocate(bounds.minX, bounds.minY, size + minimumSize, null);
+            }
+
+            /**
+             * \brief Adds a figure.
+             *
+             * \param figure Figure to add.
+             * \return Proxy id of the figure.
+             */
+            int insert(Figure &figure) {
+                int id = m_freeSlot;
+                if (id == null) {
+                    m_slot.push_back(Slot {});
+                    id = static_cast<int>(m_slot.size()) - 1;
+                }
+                else {
+                    m_freeSlot = m_slot[id].next;
+                }
+                m_slot[id] = Slot {&figure, double(figure.getCenter().getX()), double(figure.getCenter().getY()),
+                                   figure.area(), figure.type(), null, null, null};
+                link(id);
+                return id;
+            }
+
+            /**
+             * \brief Removes a figure.
+             *
+             * \param id Proxy id returned by insert().
+             */
+            void remove(int id) {
+                unlink(id);
+                m_slot[id].figure = nullptr;
+                m_slot[id].next = m_freeSlot;
+                m_freeSlot = id;
+            }
+
+            /**
+             * \brief Picks up a new center or size of a figure.
+             *
+             * A figure that stays in its leaf only changes the totals along
+             * its path; otherwise it is moved to its new leaf.
+             *
+             * \param id Proxy id of the changed figure.
+             */
+            void update(int id) {
+                Slot &s = m_slot[id];
+                double x = s.figure->getCenter().getX(), y = s.figure->getCenter().getY();
+                double area = s.figure->area();
+                if (inside(s.node, x, y)) {
+                    for (int n = s.node; n != null; n = m_node[n].parent) {
+                        m_node[n].totals.area += area - s.area;
+                    }
+                    s.x = x;
+                    s.y = y;
+                    s.area = area;
+                    return;
+                }
+                unlink(id);
+                s.x = x;
+                s.y = y;
+                s.area = area;
+                link(id);
+            }
+
+            /**
+             * \brief Sums up the figures whose center lies in a window (borders included).
+             *
+             * \param box Window.
+             * \return Totals of the figures in the window.
+             */
+            RegionTotals query(const BoundingBox &box) const {
+                RegionTotals result;
+                // Depth is bounded by the 32-bit coordinate range, so 3 entries per level fit
+                int stack[256];
+                int top = 0;
+                stack[top++] = m_root;
+                while (top > 0) {
+                    const Node &node = m_node[stack[--top]];
+                    if (node.totals.count == 0 || node.x > box.maxX || node.y > box.maxY
+                        || node.x + node.size <= box.minX || node.y + node.size <= box.minY) {
+                        continue;
+                    }
+                    if (node.x >= box.minX && node.y >= box.minY && node.x + node.size <= box.maxX && node.y + node.size <= box.maxY) {
+                        result.add(node.totals);
+                    }
+                    else if (node.child[0] == null) {
+                        for (int id = node.first; id != null; id = m_slot[id].next) {
+                            const Slot &s = m_slot[id];
+                            if (s.x >= box.minX && s.x <= box.maxX && s.y >= box.minY && s.y <= box.maxY) {
+                                ++result.count;
+                                result.area += s.area;
+                                ++result.types[static_cast<int>(s.type)];
+                            }
+                        }
+                    }
+                    else {
+                        for (int c : node.child) {
+                            stack[top++] = c;
+                        }
+                    }
+                }
+                return result;
+            }
+
+            /**
+             * \brief Returns the totals of all figures.
+             *
+             * \return Totals of the root.
+             */
+            const RegionTotals &totals() const {
+                return m_node[m_root].totals;
+            }
+
+            /**
+             * \brief Returns the number of figures.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_node[m_root].totals.count;
+            }
+
+            /**
+             * \brief Returns a figure by its proxy id.
+             *
+             * \param id Proxy id of the figure.
+             * \return Reference to the figure.
+             */
+            Figure &get(int id) const {
+                return *m_slot[id].figure;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
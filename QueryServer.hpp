@@ -0,0 +1,1036 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mw{
+
+/**
+ * \brief Operations understood by the query server.
+ */
+    enum class QueryOp : std::uint16_t {
+        /**
+         * \brief Area and perimeter of the figure with a given index.
+         */
+        Measure = 1,
+
+        /**
+         * \brief Indices of the figures containing a point.
+         */
+        HitTest = 2,
+
+        /**
+         * \brief Number and total area of the figures whose bounds overlap a box.
+         */
+        Range = 3,
+
+        /**
+         * \brief Totals over the whole scene.
+         */
+        Aggregate = 4
+    };
+
+/**
+ * \brief Request frame of the query protocol.
+ *
+ * Every request has the same size, so the server parses it by copying it out
+ * of the receive buffer. Integers and doubles use the byte order of the host,
+ * as client and server run on the same machine.
+ */
+    struct QueryRequest {
+        /**
+         * \brief Size of the frame, always sizeof(QueryRequest).
+         */
+        std::uint32_t size = sizeof(QueryRequest);
+
+        /**
+         * \brief Client-chosen id, returned in the response.
+         */
+        std::uint32_t id = 0;
+
+        /**
+         * \brief Requested operation.
+         */
+        QueryOp op = QueryOp::Aggregate;
+
+        /**
+         * \brief Unused, zero.
+         */
+        std::uint16_t reserved = 0;
+
+        /**
+         * \brief Figure index for Measure.
+         */
+        std::uint32_t index = 0;
+
+        /**
+         * \brief Point (x, y) for HitTest, box (minX, minY, maxX, maxY) for Range.
+         */
+        double value[4] = {0, 0, 0, 0};
+
+        /**
+         * \brief Creates a Measure request.
+         *
+         * \param id Request id.
+         * \param index Index of the figure.
+         * \return Request frame.
+         */
+        static QueryRequest measure(std::uint32_t id, std::uint32_t index) {
+            QueryRequest r;
+            r.id = id;
+            r.op = QueryOp::Measure;
+            r.index = index;
+            return r;
+        }
+
+        /**
+         * \brief Creates a HitTest request.
+         *
+         * \param id Request id.
+         * \param p Point to test.
+         * \return Request frame.
+         */
+        static QueryRequest hitTest(std::uint32_t id, const Vec2 &p) {
+            QueryRequest r;
+            r.id = id;
+            r.op = QueryOp::HitTest;
+            r.value[0] = p.x;
+            r.value[1] = p.y;
+            return r;
+        }
+
+        /**
+         * \brief Creates a Range request.
+         *
+         * \param id Request id.
+         * \param box Query box.
+         * \return Request frame.
+         */
+        static QueryRequest range(std::uint32_t id, const BoundingBox &box) {
+            QueryRequest r;
+            r.id = id;
+            r.op = QueryOp::Range;
+            r.value[0] = box.minX;
+            r.value[1] = box.minY;
+            r.value[2] = box.maxX;
+            r.value[3] = box.maxY;
+            return r;
+        }
+
+        /**
+         * \brief Creates an Aggregate request.
+         *
+         * \param id Request id.
+         * \return Request frame.
+         */
+        static QueryRequest aggregate(std::uint32_t id) {
+            QueryRequest r;
+            r.id = id;
+            r.op = QueryOp::Aggregate;
+            return r;
+        }
+    };
+
+/**
+ * \brief Fixed part of a response frame.
+ *
+ * It is followed by count 32-bit items for HitTest (figure indices) and by
+ * five items for Aggregate (figures per ShapeType).
+ */
+    struct QueryResponse {
+        /**
+         * \brief Size of the frame including the items.
+         */
+        std::uint32_t size;
+
+        /**
+         * \brief Id of the request.
+         */
+        std::uint32_t id;
+
+        /**
+         * \brief Operation of the request.
+         */
+        QueryOp op;
+
+        /**
+         * \brief 0 on success, 1 for a malformed request, 2 for an index out of range.
+         */
+        std::uint16_t status;
+
+        /**
+         * \brief Number of hits, matches or figures.
+         */
+        std::uint32_t count;
+
+        /**
+         * \brief Area and perimeter (Measure, Aggregate) or area sum (Range).
+         */
+        double value[2];
+    };
+
+/**
+ * \brief Decoded response with its items, as returned by QueryClient.
+ */
+    struct QueryResult {
+        /**
+         * \brief Fixed part of the response.
+         */
+        QueryResponse header;
+
+        /**
+         * \brief Items following the fixed part.
+         */
+        std::vector<std::uint32_t> items;
+    };
+
+/**
+ * \brief Read-only scene with a uniform grid for point and box queries.
+ *
+ * Figures are flattened into records with their outline, bounds and values,
+ * so queries make no virtual calls and allocate nothing. The grid is stored
+ * in compressed rows: the records of every cell are contiguous.
+ */
+    class QueryScene {
+        private:
+            /**
+             * \brief One figure of the scene.
+             */
+            struct Record {
+                BoundingBox bounds;
+                Outline outline;
+                double area;
+                double perimeter;
+                ShapeType type;
+            };
+
+            /**
+             * \brief All figures, indexed like the input.
+             */
+            std::vector<Record> m_record;
+
+            /**
+             * \brief Grid over the figure bounds.
+             */
+            UniformGrid m_grid;
+
+            /**
+             * \brief Total area of all figures.
+             */
+            double m_totalArea = 0;
+
+            /**
+             * \brief Total perimeter of all figures.
+             */
+            double m_totalPerimeter = 0;
+
+            /**
+             * \brief Number of figures of every type.
+             */
+            std::array<std::uint32_t, 5> m_count {};
+
+        public:
+            /**
+             * \brief Builds the scene from figures.
+             *
+             * \param figures Figures to copy into the scene.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             *
+             * \throws const char* If there are more than 2^32 - 1 figures.
+             */
+            QueryScene(const std::vector<const Figure*> &figures, unsigned threads = 0) {
+                if (figures.size() >= 0xffffffffULL) {
+                    throw "Too many figures for a scene";
+                }
+                const std::size_t n = figures.size();
+                m_record.resize(n);
+                parallelFor(n, 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        Record &r = m_record[i];
+                        r.outline = figures[i]->outline();
+                        r.bounds = r.outline.bounds();
+                        r.area = figures[i]->area();
+                        r.perimeter = figures[i]->perimeter();
+                        r.type = figures[i]->type();
+                    }
+                }, threads);
+                for (const Record &r : m_record) {
+                    m_totalArea += r.area;
+                    m_totalPerimeter += r.perimeter;
+                    ++m_count[static_cast<int>(r.type)];
+                }
+                m_grid.build(n, [this](std::size_t i) { return m_record[i].bounds; });
+            }
+
+            /**
+             * \brief Returns the number of figures.
+             *
+             * \return Number of figures.
+             */
+            std::size_t size() const {
+                return m_record.size();
+            }
+
+            /**
+             * \brief Returns the bounds of the whole scene.
+             *
+             * \return Union of all figure bounds.
+             */
+            const BoundingBox &bounds() const {
+                return m_grid.bounds;
+            }
+
+            /**
+             * \brief Answers one request.
+             *
+             * \param request Request to answer.
+             * \param response Receives the fixed part of the response.
+             * \param items Receives the items; room for maxItems values.
+             * \param maxItems Largest number of items to write.
+             * \return Number of items written.
+             */
+            std::uint32_t answer(const QueryRequest &request, QueryResponse &response,
+                                 std::uint32_t *items, std::uint32_t maxItems) const {
+                response = {sizeof(QueryResponse), request.id, request.op, 0, 0, {0, 0}};
+                std::uint32_t written = 0;
+                switch (request.op) {
+                    case QueryOp::Measure:
+                        if (request.index >= m_record.size()) {
+                            response.status = 2;
+                            break;
+                        }
+                        response.count = 1;
+                        response.value[0] = m_record[request.index].area;
+                        response.value[1] = m_record[request.index].perimeter;
+                        break;
+
+                    case QueryOp::HitTest: {
+                        Vec2 p {request.value[0], request.value[1]};
+                        if (m_record.empty() || !m_grid.bounds.contains(p)) {
+                            break;
+                        }
+                        std::size_t cell = m_grid.index(m_grid.column(p.x), m_grid.row(p.y));
+                        for (std::uint32_t k = m_grid.cellStart[cell]; k < m_grid.cellStart[cell + 1]; ++k) {
+                            const Record &r = m_record[m_grid.item[k]];
+                            if (r.bounds.contains(p) && r.outline.contains(p)) {
+                                if (written < maxItems) {
+                                    items[written++] = m_grid.item[k];
+                                }
+                                ++response.count;
+                            }
+                        }
+                        break;
+                    }
+
+                    case QueryOp::Range: {
+                        BoundingBox box {request.value[0], request.value[1], request.value[2], request.value[3]};
+                        if (m_record.empty() || !box.overlaps(m_grid.bounds)) {
+                            break;
+                        }
+                        int x0 = m_grid.column(box.minX), x1 = m_grid.column(box.maxX);
+                        int y0 = m_grid.row(box.minY), y1 = m_grid.row(box.maxY);
+                        for (int y = y0; y <= y1; ++y) {
+                            for (int x = x0; x <= x1; ++x) {
+                                std::size_t cell = m_grid.index(x, y);
+                                for (std::uint32_t k = m_grid.cellStart[cell]; k < m_grid.cellStart[cell + 1]; ++k) {
+                                    const Record &r = m_record[m_grid.item[k]];
+                                    // A figure in several cells counts only in the first cell of the overlap
+                                    if (r.bounds.overlaps(box)
+                                        && m_grid.column(std::max(r.bounds.minX, box.minX)) == x
+                                        && m_grid.row(std::max(r.bounds.minY, box.minY)) == y) {
+                                        ++response.count;
+                                        response.value[0] += r.area;
+                                    }
+                                }
+                            }
+                        }
+                        break;
+                    }
+
+                    case QueryOp::Aggregate:
+                        response.count = static_cast<std::uint32_t>(m_record.size());
+                        response.value[0] = m_totalArea;
+                        response.value[1] = m_totalPerimeter;
+                        for (std::uint32_t t = 0; t < 5 && written < maxItems; ++t) {
+                            items[written++] = m_count[t];
+                        }
+                        break;
+
+                    default:
+                        response.status = 1;
+                }
+                response.size += written * sizeof(std::uint32_t);
+                return written;
+            }
+    };
+
+/**
+ * \brief Local query server over a Unix domain socket.
+ *
+ * An acceptor thread hands new connections round-robin to the workers. Every
+ * worker runs its own poll() loop over its connections; one pass of the loop
+ * (a tick) first reads everything that arrived on all ready connections,
+ * then answers all complete requests as one batch and finally sends each
+ * connection its responses with one write. Requests are parsed in place from
+ * fixed-size per-connection buffers and responses are written into reused
+ * output buffers, so steady-state serving does not allocate.
+ */
+    class QueryServer {
+        private:
+            /**
+             * \brief Largest number of items in one response.
+             */
+            static constexpr std::uint32_t maxItems = 256;
+
+            /**
+             * \brief Size of the receive buffer of a connection.
+             */
+            static constexpr std::size_t inputBytes = 64 * 1024;
+
+            /**
+             * \brief One client connection.
+             */
+            struct Connection {
+                int fd;
+                std::vector<char> input;
+                std::size_t inputUsed = 0;
+                std::vector<char> output;
+                std::size_t outputSent = 0;
+            };
+
+            /**
+             * \brief State of one worker.
+             */
+            struct Worker {
+                std::thread thread;
+                int wake[2] = {-1, -1};
+                std::mutex mutex;
+                std::vector<int> incoming;
+            };
+
+            /**
+             * \brief Scene answering the queries.
+             */
+            QueryScene m_scene;
+
+            /**
+             * \brief Socket path.
+             */
+            std::string m_path;
+
+            /**
+             * \brief Listening socket.
+             */
+            int m_listen = -1;
+
+            /**
+             * \brief Workers, created once.
+             */
+            std::vector<std::unique_ptr<Worker>> m_worker;
+
+            /**
+             * \brief Thread accepting connections.
+             */
+            std::thread m_acceptor;
+
+            /**
+             * \brief Set to stop all threads.
+             */
+            std::atomic<bool> m_stop {false};
+
+            /**
+             * \brief Number of answered requests.
+             */
+            std::atomic<std::uint64_t> m_served {0};
+
+            /**
+             * \brief Number of ticks that answered at least one request.
+             */
+            std::atomic<std::uint64_t> m_batches {0};
+
+            /**
+             * \brief Appends all complete requests of a connection to its output.
+             *
+             * \return Number of answered requests.
+             */
+            std::size_t process(Connection &c) {
+                std::size_t done = 0, offset = 0;
+                std::uint32_t items[maxItems];
+                while (c.inputUsed - offset >= sizeof(QueryRequest)) {
+                    QueryRequest request;
+                    std::memcpy(&request, c.input.data() + offset, sizeof request);
+                    offset += sizeof request;
+                    QueryResponse response;
+                    std::uint32_t n = 0;
+                    if (request.size != sizeof(QueryRequest)) {
+                        response = {sizeof(QueryResponse), request.id, request.op, 1, 0, {0, 0}};
+                    }
+                    else {
+                        n = m_scene.answer(request, response, items, maxItems);
+                    }
+                    std::size_t at = c.output.size();
+                    c.output.resize(at + response.size);
+                    std::memcpy(c.output.data() + at, &response, sizeof response);
+                    std::memcpy(c.output.data() + at + sizeof response, items, n * sizeof(std::uint32_t));
+                    ++done;
+                }
+                std::memmove(c.input.data(), c.input.data() + offset, c.inputUsed - offset);
+                c.inputUsed -= offset;
+                return done;
+            }
+
+            /**
+             * \brief Sends pending output of a connection.
+             *
+             * \return False if the connection failed.
+             */
+            static bool flush(Connection &c) {
+                while (c.outputSent < c.output.size()) {
+                    ssize_t n = send(c.fd, c.output.data() + c.outputSent, c.output.size() - c.outputSent, MSG_NOSIGNAL);
+                    if (n < 0) {
+                        return errno == EAGAIN || errno == EWOULDBLOCK;
+                    }
+                    c.outputSent += static_cast<std::size_t>(n);
+                }
+                c.output.clear();
+                c.outputSent = 0;
+                return true;
+            }
+
+            /**
+             * \brief Event loop of one worker.
+             *
+             * Connections handed over during a tick join the poll set of the next
+             * one. If poll() fails for any reason other than a signal, the worker
+             * closes its connections and exits.
+             */
+            void run(Worker &w) {
+                std::vector<Connection> connections;
+                std::vector<pollfd> fds;
+                std::vector<std::uint8_t> closed;
+                while (!m_stop.load()) {
+                    fds.clear();
+                    fds.push_back({w.wake[0], POLLIN, 0});
+                    for (const Connection &c : connections) {
+                        // Reading stops while responses are pending or the buffer is full,
+                        // otherwise unread input would wake poll() again at once
+                        short events = 0;
+                        if (c.output.empty() && c.inputUsed < c.input.size()) {
+                            events |= POLLIN;
+                        }
+                        if (!c.output.empty()) {
+                            events |= POLLOUT;
+                        }
+                        fds.push_back({c.fd, events, 0});
+                    }
+                    if (poll(fds.data(), fds.size(), -1) < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        break;
+                    }
+                    std::size_t polled = fds.size() - 1;
+
+                    if (fds[0].revents & POLLIN) {
+                        char drain[64];
+                        while (read(w.wake[0], drain, sizeof drain) > 0) {
+                        }
+                        std::lock_guard<std::mutex> lock(w.mutex);
+                        for (int fd : w.incoming) {
+                            connections.push_back(Connection {fd, std::vector<char>(inputBytes), 0, {}, 0});
+                            connections.back().output.reserve(inputBytes);
+                        }
+                        w.incoming.clear();
+                    }
+
+                    // Read from every ready connection, then answer the whole batch
+                    closed.assign(connections.size(), 0);
+                    std::size_t batch = 0;
+                    for (std::size_t i = 0; i < polled; ++i) {
+                        Connection &c = connections[i];
+                        short revents = fds[i + 1].revents;
+                        if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                            while (c.inputUsed < c.input.size()) {
+                                ssize_t n = recv(c.fd, c.input.data() + c.inputUsed, c.input.size() - c.inputUsed, 0);
+                                if (n > 0) {
+                                    c.inputUsed += static_cast<std::size_t>(n);
+                                    continue;
+                                }
+                                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                                    closed[i] = 1;
+                                }
+                                break;
+                            }
+                        }
+                    }
+                    // A connection whose responses are not sent yet is not read further
+                    for (Connection &c : connections) {
+                        if (c.output.empty()) {
+                            batch += process(c);
+                        }
+                    }
+                    for (std::size_t i = 0; i < connections.size(); ++i) {
+                        if (!closed[i] && !flush(connections[i])) {
+                            closed[i] = 1;
+                        }
+                    }
+                    if (batch > 0) {
+                        m_served.fetch_add(batch);
+                        m_batches.fetch_add(1);
+                    }
+
+                    for (std::size_t i = connections.size(); i-- > 0;) {
+                        if (closed[i]) {
+                            close(connections[i].fd);
+                            connections[i] = std::move(connections.back());
+                            connections.pop_back();
+                        }
+                    }
+                }
+                for (Connection &c : connections) {
+                    close(c.fd);
+                }
+            }
+
+            /**
+             * \brief Accepts connections and hands them to the workers.
+             */
+            void accept() {
+                std::size_t next = 0;
+                while (!m_stop.load()) {
+                    int fd = ::accept(m_listen, nullptr, nullptr);
+                    if (fd < 0) {
+                        if (m_stop.load()) {
+                            break;
+                        }
+                        continue;
+                    }
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    Worker &w = *m_worker[next++ % m_worker.size()];
+                    {
+                        std::lock_guard<std::mutex> lock(w.mutex);
+                        w.incoming.push_back(fd);
+                    }
+                    char c = 1;
+                    (void) !write(w.wake[1], &c, 1);
+                }
+            }
+
+        public:
+            /**
+             * \brief Loads a scene and starts serving it.
+             *
+             * \param figures Figures of the scene; they are copied.
+             * \param path Path of the Unix domain socket; an existing file is replaced.
+             * \param workers Number of worker threads, 0 means one per hardware thread.
+             *
+             * \throws const char* If the socket cannot be created.
+             */
+            QueryServer(const std::vector<const Figure*> &figures, const std::string &path, unsigned workers = 0)
+                : m_scene(figures), m_path(path) {
+                sockaddr_un address {};
+                if (path.size() >= sizeof address.sun_path) {
+                    throw "Socket path is too long";
+                }
+                address.sun_family = AF_UNIX;
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                ::unlink(path.c_str());
+
+                m_listen = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (m_listen < 0 || bind(m_listen, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0
+                    || listen(m_listen, 128) != 0) {
+                    if (m_listen >= 0) {
+                        close(m_listen);
+                    }
+                    throw "Cannot listen on socket";
+                }
+
+                for (unsigned i = 0; i < threadCount(workers); ++i) {
+                    m_worker.push_back(std::unique_ptr<Worker>(new Worker));
+                    Worker &w = *m_worker.back();
+                    if (pipe(w.wake) != 0) {
+                        for (std::unique_ptr<Worker> &created : m_worker) {
+                            if (created->wake[0] >= 0) {
+                                close(created->wake[0]);
+                                close(created->wake[1]);
+                            }
+                        }
+                        close(m_listen);
+                        ::unlink(path.c_str());
+                        throw "Cannot create worker pipe";
+                    }
+                    fcntl(w.wake[0], F_SETFL, fcntl(w.wake[0], F_GETFL) | O_NONBLOCK);
+                }
+                for (std::unique_ptr<Worker> &w : m_worker) {
+                    Worker *worker = w.get();
+                    w->thread = std::thread([this, worker]() { run(*worker); });
+                }
+                m_acceptor = std::thread([this]() { accept(); });
+            }
+
+            QueryServer(const QueryServer&) = delete;
+            QueryServer &operator=(const QueryServer&) = delete;
+
+            /**
+             * \brief Stops the server and removes the socket file.
+             */
+            ~QueryServer() {
+                stop();
+            }
+
+            /**
+             * \brief Stops all threads and closes all connections.
+             */
+            void stop() {
+                if (m_stop.exchange(true)) {
+                    return;
+                }
+                shutdown(m_listen, SHUT_RDWR);
+                close(m_listen);
+                if (m_acceptor.joinable()) {
+                    m_acceptor.join();
+                }
+                for (std::unique_ptr<Worker> &w : m_worker) {
+                    char c = 0;
+                    (void) !write(w->wake[1], &c, 1);
+                    w->thread.join();
+                    close(w->wake[0]);
+                    close(w->wake[1]);
+                }
+                ::unlink(m_path.c_str());
+            }
+
+            /**
+             * \brief Returns the scene being served.
+             *
+             * \return Constant reference to the scene.
+             */
+            const QueryScene &scene() const {
+                return m_scene;
+            }
+
+            /**
+             * \brief Returns the number of answered requests.
+             *
+             * \return Requests answered so far.
+             */
+            std::uint64_t served() const {
+                return m_served.load();
+            }
+
+            /**
+             * \brief Returns the number of batches the requests were answered in.
+             *
+             * \return Ticks that answered at least one request.
+             */
+            std::uint64_t batches() const {
+                return m_batches.load();
+            }
+    };
+
+/**
+ * \brief Blocking client of the query server.
+ */
+    class QueryClient {
+        private:
+            /**
+             * \brief Connected socket.
+             */
+            int m_fd = -1;
+
+            /**
+             * \brief Requests not sent yet.
+             */
+            std::vector<char> m_pending;
+
+            /**
+             * \brief Response bytes taken in by flush() and not received yet.
+             */
+            std::vector<char> m_received;
+
+            /**
+             * \brief Bytes of m_received already handed out by receive().
+             */
+            std::size_t m_receivedRead = 0;
+
+            /**
+             * \brief Reads exactly n bytes, buffered ones first.
+             */
+            void readFully(void *data, std::size_t n) {
+                char *p = static_cast<char*>(data);
+                std::size_t buffered = std::min(n, m_received.size() - m_receivedRead);
+                std::memcpy(p, m_received.data() + m_receivedRead, buffered);
+                m_receivedRead += buffered;
+                p += buffered;
+                n -= buffered;
+                while (n > 0) {
+                    ssize_t r = recv(m_fd, p, n, 0);
+                    if (r <= 0) {
+                        throw "Connection to query server lost";
+                    }
+                    p += r;
+                    n -= static_cast<std::size_t>(r);
+                }
+            }
+
+        public:
+            /**
+             * \brief Connects to a server.
+             *
+             * \param path Path of the server socket.
+             *
+             * \throws const char* If the connection fails.
+             */
+            QueryClient(const std::string &path) {
+                sockaddr_un address {};
+                if (path.size() >= sizeof address.sun_path) {
+                    throw "Socket path is too long";
+                }
+                address.sun_family = AF_UNIX;
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (m_fd < 0 || connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+                    if (m_fd >= 0) {
+                        close(m_fd);
+                    }
+                    throw "Cannot connect to query server";
+                }
+            }
+
+            QueryClient(const QueryClient&) = delete;
+            QueryClient &operator=(const QueryClient&) = delete;
+
+            /**
+             * \brief Closes the connection.
+             */
+            ~QueryClient() {
+                close(m_fd);
+            }
+
+            /**
+             * \brief Queues a request; it is sent by flush().
+             *
+             * \param request Request to queue.
+             */
+            void send(const QueryRequest &request) {
+                const char *p = reinterpret_cast<const char*>(&request);
+                m_pending.insert(m_pending.end(), p, p + sizeof request);
+            }
+
+            /**
+             * \brief Sends all queued requests.
+             *
+             * The server stops reading a connection while its responses are not
+             * read, so responses arriving meanwhile are read into a buffer that
+             * receive() drains first. Any number of requests can be queued; the
+             * only limit is the memory for their responses until they are received.
+             *
+             * \throws const char* If the connection fails.
+             */
+            void flush() {
+                m_received.erase(m_received.begin(), m_received.begin() + m_receivedRead);
+                m_receivedRead = 0;
+                std::size_t sent = 0;
+                while (sent < m_pending.size()) {
+                    pollfd fd {m_fd, POLLIN | POLLOUT, 0};
+                    if (poll(&fd, 1, -1) < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw "Connection to query server lost";
+                    }
+                    if (fd.revents & POLLIN) {
+                        const std::size_t at = m_received.size(), chunk = 1 << 16;
+                        m_received.resize(at + chunk);
+                        ssize_t r = recv(m_fd, m_received.data() + at, chunk, MSG_DONTWAIT);
+                        m_received.resize(at + static_cast<std::size_t>(std::max<ssize_t>(r, 0)));
+                        if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                            throw "Connection to query server lost";
+                        }
+                    }
+                    else if (fd.revents & (POLLERR | POLLHUP)) {
+                        throw "Connection to query server lost";
+                    }
+                    if (fd.revents & POLLOUT) {
+                        ssize_t n = ::send(m_fd, m_pending.data() + sent, m_pending.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+                        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                            throw "Connection to query server lost";
+                        }
+                        sent += static_cast<std::size_t>(std::max<ssize_t>(n, 0));
+                    }
+                }
+                m_pending.clear();
+            }
+
+            /**
+             * \brief Receives the next response.
+             *
+             * \param result Receives the response; its item vector is reused.
+             *
+             * \throws const char* If the connection fails or the response is malformed.
+             */
+            void receive(QueryResult &result) {
+                readFully(&result.header, sizeof result.header);
+                if (result.header.size < sizeof(QueryResponse)) {
+                    throw "Malformed query response";
+                }
+                result.items.resize((result.header.size - sizeof(QueryResponse)) / sizeof(std::uint32_t));
+                readFully(result.items.data(), result.items.size() * sizeof(std::uint32_t));
+            }
+
+            /**
+             * \brief Sends one request and waits for its response.
+             *
+             * \param request Request to send.
+             * \return Response of the server.
+             */
+            QueryResult call(const QueryRequest &request) {
+                send(request);
+                flush();
+                QueryResult result;
+                receive(result);
+                return result;
+            }
+    };
+
+/**
+ * \brief Result of a load test.
+ */
+    struct LoadReport {
+        /**
+         * \brief Number of answered requests.
+         */
+        std::uint64_t requests = 0;
+
+        /**
+         * \brief Wall-clock duration in seconds.
+         */
+        double seconds = 0;
+
+        /**
+         * \brief Requests per second.
+         */
+        double qps = 0;
+
+        /**
+         * \brief Median latency in microseconds.
+         */
+        double p50 = 0;
+
+        /**
+         * \brief 99th percentile latency in microseconds.
+         */
+        double p99 = 0;
+    };
+
+/**
+ * \brief Drives a query server with a random mix of requests and measures it.
+ *
+ * Every client thread keeps a fixed number of requests in flight: it sends
+ * a window of requests, then waits for all their responses. Latency is
+ * measured per request from sending the window to receiving the response.
+ *
+ * \param path Path of the server socket.
+ * \param scene Bounds of the scene, used to place points and boxes.
+ * \param figures Number of figures in the scene, used for Measure indices.
+ * \param clients Number of client threads, each with its own connection.
+ * \param requests Requests sent by every client.
+ * \param pipeline Requests in flight per client.
+ * \param seed Seed of the request mix.
+ * \return Throughput and latency percentiles.
+ *
+ * \throws const char* If a connection fails.
+ */
+    inline LoadReport runLoad(const std::string &path, const BoundingBox &scene, std::size_t figures,
+                              unsigned clients, std::size_t requests, std::size_t pipeline = 16, std::uint64_t seed = 1) {
+        using Clock = std::chrono::steady_clock;
+        pipeline = std::max<std::size_t>(1, pipeline);
+        std::vector<std::vector<double>> latency(clients);
+        std::vector<std::thread> threads;
+        std::mutex errorMutex;
+        const char *error = nullptr;
+
+        Clock::time_point start = Clock::now();
+        for (unsigned t = 0; t < clients; ++t) {
+            threads.emplace_back([&, t]() {
+                try {
+                    QueryClient client(path);
+                    std::mt19937_64 rng(seed + t);
+                    std::uniform_real_distribution<double> x(scene.minX, scene.maxX), y(scene.minY, scene.maxY);
+                    std::vector<Clock::time_point> sent(pipeline);
+                    QueryResult result;
+                    latency[t].reserve(requests);
+                    for (std::size_t done = 0; done < requests;) {
+                        std::size_t window = std::min(pipeline, requests - done);
+                        for (std::size_t i = 0; i < window; ++i) {
+                            std::uint32_t id = static_cast<std::uint32_t>(i);
+                            switch (rng() % 4) {
+                                case 0: client.send(QueryRequest::measure(id, static_cast<std::uint32_t>(rng() % std::max<std::size_t>(1, figures)))); break;
+                                case 1: client.send(QueryRequest::hitTest(id, {x(rng), y(rng)})); break;
+                                case 2: {
+                                    double x0 = x(rng), y0 = y(rng);
+                                    client.send(QueryRequest::range(id, {x0, y0, x0 + (scene.maxX - scene.minX) / 50, y0 + (scene.maxY - scene.minY) / 50}));
+                                    break;
+                                }
+                                default: client.send(QueryRequest::aggregate(id));
+                            }
+                        }
+                        Clock::time_point now = Clock::now();
+                        client.flush();
+                        for (std::size_t i = 0; i < window; ++i) {
+                            client.receive(result);
+                            latency[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - now).count());
+                        }
+                        done += window;
+                    }
+                }
+                catch (const char *e) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    error = e;
+                }
+            });
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+        if (error != nullptr) {
+            throw error;
+        }
+
+        LoadReport report;
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::vector<double> all;
+        for (const std::vector<double> &l : latency) {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+        report.requests = all.size();
+        report.qps = report.seconds > 0 ? report.requests / report.seconds : 0;
+        if (!all.empty()) {
+            std::sort(all.begin(), all.end());
+            report.p50 = all[all.size() / 2];
+            report.p99 = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+        }
+        return report;
+    }
+
+} // namespace mw
\ No newline at end of file
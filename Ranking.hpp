@@ -0,0 +1,215 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Value figures are ranked by.
+ */
+    enum class RankKey {
+        Area,
+        Perimeter
+    };
+
+/**
+ * \brief Sorting and ranking of figures by area or perimeter.
+ *
+ * Every figure's key is computed exactly once in a parallel pass, so the
+ * virtual area() and perimeter() functions (and the sqrt/sin they do for
+ * some figures) run n times instead of O(n log n) times. The keys are mapped
+ * to unsigned integers with the same order and sorted together with the
+ * figure indices by a parallel least-significant-digit radix sort, which is
+ * stable: figures with equal keys keep their input order.
+ */
+    class Ranking {
+        private:
+            /**
+             * \brief Maps a double to an unsigned integer with the same order.
+             */
+            static std::uint64_t orderedBits(double value) {
+                std::uint64_t bits;
+                std::memcpy(&bits, &value, sizeof bits);
+                return (bits >> 63) ? ~bits : bits | 0x8000000000000000ULL;
+            }
+
+            /**
+             * \brief Computes the sort keys of all figures.
+             */
+            static std::vector<std::uint64_t> keys(const std::vector<const Figure*> &figures, RankKey key,
+                                                   bool descending, unsigned threads) {
+                std::vector<std::uint64_t> out(figures.size());
+                parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        double value = key == RankKey::Area ? figures[i]->area() : figures[i]->perimeter();
+                        // +0.0 folds -0.0 into 0.0 so both rank equal
+                        std::uint64_t bits = orderedBits(value + 0.0);
+                        out[i] = descending ? ~bits : bits;
+                    }
+                }, threads);
+                return out;
+            }
+
+        public:
+            /**
+             * \brief Sorts (key, index) pairs by key with a stable parallel radix sort.
+             *
+             * \param key Keys to sort by, reordered in place.
+             * \param index Values carried along with the keys, reordered in place.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             */
+            static void radixSort(std::vector<std::uint64_t> &key, std::vector<std::uint32_t> &index, unsigned threads = 0) {
+                const std::size_t n = key.size();
+                const unsigned blocks = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threadCount(threads), n / 65536)));
+                std::vector<std::uint64_t> keyOut(n);
+                std::vector<std::uint32_t> indexOut(n);
+                std::vector<std::size_t> count(blocks * 256);
+
+                auto blockBegin = [&](std::size_t b) { return b * n / blocks; };
+
+                for (int shift = 0; shift < 64; shift += 8) {
+                    std::fill(count.begin(), count.end(), 0);
+                    parallelFor(blocks, 1, [&](std::size_t b, std::size_t) {
+                        std::size_t *c = &count[b * 256];
+                        for (std::size_t i = blockBegin(b); i < blockBegin(b + 1); ++i) {
+                            ++c[(key[i] >> shift) & 0xff];
+                        }
+                    }, threads);
+
+                    // Skip digits that are the same for every key
+                    bool trivial = false;
+                    for (std::size_t d = 0; d < 256 && !trivial; ++d) {
+                        std::size_t total = 0;
+                        for (unsigned b = 0; b < blocks; ++b) {
+                            total += count[b * 256 + d];
+                        }
+                        trivial = total == n;
+                    }
+                    if (trivial) {
+                        continue;
+                    }
+
+                    // Turn counts into start offsets, digit-major and block-minor
+                    std::size_t offset = 0;
+                    for (std::size_t d = 0; d < 256; ++d) {
+                        for (unsigned b = 0; b < blocks; ++b) {
+                            std::size_t c = count[b * 256 + d];
+                            count[b * 256 + d] = offset;
+                            offset += c;
+                        }
+                    }
+
+                    parallelFor(blocks, 1, [&](std::size_t b, std::size_t) {
+                        std::size_t *c = &count[b * 256];
+                        for (std::size_t i = blockBegin(b); i < blockBegin(b + 1); ++i) {
+                            std::size_t pos = c[(key[i] >> shift) & 0xff]++;
+                            keyOut[pos] = key[i];
+                            indexOut[pos] = index[i];
+                        }
+                    }, threads);
+                    key.swap(keyOut);
+                    index.swap(indexOut);
+                }
+            }
+
+            /**
+             * \brief Returns the order of figures sorted by a key.
+             *
+             * \param figures Figures to rank.
+             * \param key Value to rank by.
+             * \param descending True to put the largest values first.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Permutation: the i-th element is the index of the i-th ranked figure.
+             *
+             * \throws const char* If there are more than 2^32 - 1 figures.
+             */
+            static std::vector<std::size_t> order(const std::vector<const Figure*> &figures, RankKey key,
+                                                  bool descending = false, unsigned threads = 0) {
+                if (figures.size() >= 0xffffffffULL) {
+                    throw "Too many figures to rank";
+                }
+                std::vector<std::uint64_t> k = keys(figures, key, descending, threads);
+                std::vector<std::uint32_t> index(figures.size());
+                for (std::size_t i = 0; i < index.size(); ++i) {
+                    index[i] = static_cast<std::uint32_t>(i);
+                }
+                radixSort(k, index, threads);
+                return std::vector<std::size_t>(index.begin(), index.end());
+            }
+
+            /**
+             * \brief Returns the k first figures of the ranking.
+             *
+             * Only the selected figures are sorted. Ties are broken by input
+             * order, so the result equals the first k entries of order() called
+             * with the same key and direction; both rank ascending by default.
+             *
+             * \param figures Figures to rank.
+             * \param key Value to rank by.
+             * \param k Number of figures to return.
+             * \param descending True to select the largest values.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Indices of the k first ranked figures, in rank order.
+             */
+            static std::vector<std::size_t> top(const std::vector<const Figure*> &figures, RankKey key, std::size_t k,
+                                                bool descending = false, unsigned threads = 0) {
+                std::vector<std::uint64_t> keyOf = keys(figures, key, descending, threads);
+                k = std::min(k, figures.size());
+                using Entry = std::pair<std::uint64_t, std::size_t>;
+
+                // Every chunk keeps its own k best, then the candidates are merged
+                const std::size_t chunk = std::max<std::size_t>(65536, k);
+                std::vector<std::vector<Entry>> best((figures.size() + chunk - 1) / chunk);
+                parallelFor(figures.size(), chunk, [&](std::size_t begin, std::size_t end) {
+                    std::vector<Entry> &local = best[begin / chunk];
+                    for (std::size_t i = begin; i < end; ++i) {
+                        local.emplace_back(keyOf[i], i);
+                    }
+                    if (local.size() > k) {
+                        std::nth_element(local.begin(), local.begin() + k, local.end());
+                        local.resize(k);
+                    }
+                }, threads);
+
+                std::vector<Entry> candidates;
+                for (const std::vector<Entry> &local : best) {
+                    candidates.insert(candidates.end(), local.begin(), local.end());
+                }
+                std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+
+                std::vector<std::size_t> out(k);
+                for (std::size_t i = 0; i < k; ++i) {
+                    out[i] = candidates[i].second;
+                }
+                return out;
+            }
+
+            /**
+             * \brief Reorders a collection by a permutation.
+             *
+             * \param items Collection to reorder; elements are moved.
+             * \param permutation Permutation as returned by order().
+             *
+             * \throws const char* If the sizes differ.
+             */
+            template <typename T>
+            static void apply(std::vector<T> &items, const std::vector<std::size_t> &permutation) {
+                if (items.size() != permutation.size()) {
+                    throw "Permutation size does not match";
+                }
+                std::vector<T> out;
+                out.reserve(items.size());
+                for (std::size_t i : permutation) {
+                    out.push_back(std::move(items[i]));
+                }
+                items.swap(out);
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
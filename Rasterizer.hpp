@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Represents one rendered tile of a raster canvas.
+ *
+ * Holds the number of figures covering each pixel of the tile, stored row by
+ * row. Pixel (x, y) is the unit cell [x, x+1) x [y, y+1) of the Point grid and
+ * is covered by a figure if its center (x + 0.5, y + 0.5) lies inside it.
+ */
+    struct RasterTile {
+        /**
+         * \brief Canvas X coordinate of the tile's first column.
+         */
+        int x0 = 0;
+
+        /**
+         * \brief Canvas Y coordinate of the tile's first row.
+         */
+        int y0 = 0;
+
+        /**
+         * \brief Width of the tile in pixels.
+         */
+        int width = 0;
+
+        /**
+         * \brief Height of the tile in pixels.
+         */
+        int height = 0;
+
+        /**
+         * \brief Coverage counts, width * height values stored row by row.
+         */
+        std::vector<std::uint32_t> count;
+
+        /**
+         * \brief Returns the coverage count of a pixel.
+         *
+         * \param x Canvas X coordinate (inside the tile).
+         * \param y Canvas Y coordinate (inside the tile).
+         * \return Number of figures covering the pixel.
+         */
+        std::uint32_t at(int x, int y) const {
+            return count[(y - y0) * width + (x - x0)];
+        }
+    };
+
+/**
+ * \brief Scanline rasterizer rendering figures onto an integer grid.
+ *
+ * The canvas is split into square tiles which are rendered in parallel. Each
+ * worker only holds the tile it is currently rendering, so memory used for
+ * rendering is bounded by the tile size and not by the canvas size. Figures
+ * are binned to tiles by their bounding boxes before rendering, and every
+ * figure contributes a single span per row since all figures are convex.
+ */
+    class Rasterizer {
+        private:
+            /**
+             * \brief Width of the canvas in pixels.
+             */
+            int m_width;
+
+            /**
+             * \brief Height of the canvas in pixels.
+             */
+            int m_height;
+
+            /**
+             * \brief Side length of a tile in pixels.
+             */
+            int m_tileSize;
+
+            /**
+             * \brief Number of worker threads, 0 means one per hardware thread.
+             */
+            unsigned m_threads;
+
+            /**
+             * \brief Adds one figure to a tile.
+             *
+             * \param o Outline of the figure.
+             * \param box Bounding box of the outline.
+             * \param tile Tile to draw into.
+             */
+            static void drawOutline(const Outline &o, const BoundingBox &box, RasterTile &tile) {
+                int rowBegin = std::max(tile.y0, static_cast<int>(std::floor(box.minY)));
+                int rowEnd = std::min(tile.y0 + tile.height - 1, static_cast<int>(std::ceil(box.maxY)));
+
+                for (int y = rowBegin; y <= rowEnd; ++y) {
+                    double yc = y + 0.5;
+                    double left, right;
+
+                    if (o.isCircle) {
+                        double dy = yc - o.center.y;
+                        double h = o.radius * o.radius - dy * dy;
+                        if (h < 0) {
+                            continue;
+                        }
+                        h = std::sqrt(h);
+                        left = o.center.x - h;
+                        right = o.center.x + h;
+                    }
+                    else {
+                        left = box.maxX;
+                        right = box.minX;
+                        for (int i = 0; i < o.size; ++i) {
+                            const Vec2 &a = o.vertex[i];
+                            const Vec2 &b = o.vertex[(i + 1) % o.size];
+                            // Half-open rule, so a row through a vertex is not counted twice
+                            if ((a.y <= yc && b.y > yc) || (b.y <= yc && a.y > yc)) {
+                                double x = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+                                left = std::min(left, x);
+                                right = std::max(right, x);
+                            }
+                        }
+                        if (left > right) {
+                            continue;
+                        }
+                    }
+
+                    int xBegin = std::max(tile.x0, static_cast<int>(std::ceil(left - 0.5)));
+                    int xEnd = std::min(tile.x0 + tile.width - 1, static_cast<int>(std::floor(right - 0.5)));
+                    std::uint32_t *row = tile.count.data() + (y - tile.y0) * tile.width;
+                    for (int x = xBegin; x <= xEnd; ++x) {
+                        ++row[x - tile.x0];
+                    }
+                }
+            }
+
+        public:
+            /**
+             * \brief Creates a rasterizer for a canvas of the given size.
+             *
+             * \param width Width of the canvas in pixels.
+             * \param height Height of the canvas in pixels.
+             * \param tileSize Side length of a tile in pixels.
+             * \param threads Number of worker threads, 0 means one per hardware thread.
+             *
+             * \throws const char* If any dimension is not positive.
+             */
+            Rasterizer(int width, int height, int tileSize = 256, unsigned threads = 0)
+                : m_width(width), m_height(height), m_tileSize(tileSize), m_threads(threads) {
+                if (width <= 0 || height <= 0) {
+                    throw "Canvas size must be positive";
+                }
+                if (tileSize <= 0) {
+                    throw "Tile size must be positive";
+                }
+            }
+
+            /**
+             * \brief Returns the width of the canvas.
+             *
+             * \return Width in pixels.
+             */
+            int getWidth() const {
+                return m_width;
+            }
+
+            /**
+             * \brief Returns the height of the canvas.
+             *
+             * \return Height in pixels.
+             */
+            int getHeight() const {
+                return m_height;
+            }
+
+            /**
+             * \brief Renders figures tile by tile.
+             *
+             * Every tile that is covered by at least one figure is passed to the
+             * sink once it is finished. The sink is called from worker threads,
+             * possibly concurrently, and must not keep a reference to the tile.
+             *
+             * \param figures Figures to render.
+             * \param sink Function called as sink(const RasterTile&).
+             */
+            template <typename Sink>
+            void render(const std::vector<const Figure*> &figures, Sink sink) const {
+                std::vector<Outline> outlines(figures.size());
+                std::vector<BoundingBox> boxes(figures.size());
+                parallelFor(figures.size(), 4096, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        outlines[i] = figures[i]->outline();
+                        boxes[i] = outlines[i].bounds();
+                    }
+                }, m_threads);
+
+                int tilesX = (m_width + m_tileSize - 1) / m_tileSize;
+                int tilesY = (m_height + m_tileSize - 1) / m_tileSize;
+                std::vector<std::vector<std::uint32_t>> bins(static_cast<std::size_t>(tilesX) * tilesY);
+
+                for (std::size_t i = 0; i < boxes.size(); ++i) {
+                    const BoundingBox &b = boxes[i];
+                    if (b.maxX < 0 || b.maxY < 0 || b.minX >= m_width || b.minY >= m_height) {
+                        continue;
+                    }
+                    int tx0 = std::max(0, static_cast<int>(b.minX) / m_tileSize);
+                    int ty0 = std::max(0, static_cast<int>(b.minY) / m_tileSize);
+                    int tx1 = std::min(tilesX - 1, static_cast<int>(b.maxX) / m_tileSize);
+                    int ty1 = std::min(tilesY - 1, static_cast<int>(b.maxY) / m_tileSize);
+                    for (int ty = ty0; ty <= ty1; ++ty) {
+                        for (int tx = tx0; tx <= tx1; ++tx) {
+                            bins[ty * tilesX + tx].push_back(static_cast<std::uint32_t>(i));
+                        }
+                    }
+                }
+
+                parallelFor(bins.size(), 1, [&](std::size_t begin, std::size_t end) {
+                    RasterTile tile;
+                    for (std::size_t t = begin; t < end; ++t) {
+                        if (bins[t].empty()) {
+                            continue;
+                        }
+                        tile.x0 = static_cast<int>(t % tilesX) * m_tileSize;
+                        tile.y0 = static_cast<int>(t / tilesX) * m_tileSize;
+                        tile.width = std::min(m_tileSize, m_width - tile.x0);
+                        tile.height = std::min(m_tileSize, m_height - tile.y0);
+                        tile.count.assign(static_cast<std::size_t>(tile.width) * tile.height, 0);
+                        for (std::uint32_t i : bins[t]) {
+                            drawOutline(outlines[i], boxes[i], tile);
+                        }
+                        sink(static_cast<const RasterTile&>(tile));
+                    }
+                }, m_threads);
+            }
+
+            /**
+             * \brief Renders figures into a full-canvas count bitmap.
+             *
+             * \param figures Figures to render.
+             * \return width * height coverage counts stored row by row.
+             */
+            std::vector<std::uint32_t> countMap(const std::vector<const Figure*> &figures) const {
+                std::vector<std::uint32_t> map(static_cast<std::size_t>(m_width) * m_height, 0);
+                render(figures, [&](const RasterTile &tile) {
+                    for (int y = 0; y < tile.height; ++y) {
+                        std::copy(tile.count.begin() + y * tile.width, tile.count.begin() + (y + 1) * tile.width,
+                                  map.begin() + static_cast<std::size_t>(tile.y0 + y) * m_width + tile.x0);
+                    }
+                });
+                return map;
+            }
+
+            /**
+             * \brief Renders figures into a full-canvas occupancy bitmap.
+             *
+             * \param figures Figures to render.
+             * \return width * height values stored row by row, 1 where at least one figure covers the pixel.
+             */
+            std::vector<std::uint8_t> occupancyMap(const std::vector<const Figure*> &figures) const {
+                std::vector<std::uint8_t> map(static_cast<std::size_t>(m_width) * m_height, 0);
+                render(figures, [&](const RasterTile &tile) {
+                    for (int y = 0; y < tile.height; ++y) {
+                        std::uint8_t *row = map.data() + static_cast<std::size_t>(tile.y0 + y) * m_width + tile.x0;
+                        for (int x = 0; x < tile.width; ++x) {
+                            row[x] = tile.count[y * tile.width + x] != 0;
+                        }
+                    }
+                });
+                return map;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
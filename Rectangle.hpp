@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AxisRect.hpp"
 #include "Figure.hpp"
 #include "Point.hpp"
 #include <cmath>
@@ -14,29 +15,33 @@ namespace mw{
  * lengths, or by four corner points. It provides methods to compute the
  * rectangle's area and perimeter, as well as accessors and mutators for its
  * geometric properties.
+ *
+ * \tparam Coord Coordinate type of the center point and corners.
+ * \tparam Scalar Type of the side lengths and computed values.
  */
-    class Rectangle : public Figure {
+    template <typename Coord, typename Scalar>
+    class BasicRectangle : public BasicFigure<Coord, Scalar> {
         private:
             /**
              * \brief Length of side A.
              *
              * Represents one side length of the rectangle. Must be non-negative.
              */
-            double m_sideA;
+            Scalar m_sideA;
 
             /**
              * \brief Length of side B.
              *
              * Represents the second side length of the rectangle. Must be non-negative.
              */
-            double m_sideB;
+            Scalar m_sideB;
 
             /**
              * \brief Corner points of the rectangle.
              *
              * Stores the four corner points of the rectangle in order.
              */
-            std::array<Point, 4> m_corner {};
+            std::array<BasicPoint<Coord>, 4> m_corner {};
 
         protected:
             /**
@@ -50,7 +55,7 @@ namespace mw{
              * \param center Center point of the rectangle.
              * \param name Name of the figure.
              */
-            Rectangle(double a, double b, const Point &center, std::string name): m_sideA(a), m_sideB(b), Figure(center, name) {
+            BasicRectangle(Scalar a, Scalar b, const BasicPoint<Coord> &center, std::string name): m_sideA(a), m_sideB(b), BasicFigure<Coord, Scalar>(center, std::move(name)) {
                 setA(a);
                 setB(b);
             }
@@ -64,11 +69,17 @@ namespace mw{
              * \param corners Array of four corner points.
              * \param name Name of the figure.
              */
-            Rectangle(const std::array<Point, 4>& corners, std::string name) : m_corner(corners), Figure(name) {
+            BasicRectangle(const std::array<BasicPoint<Coord>, 4>& corners, std::string name) : m_corner(corners), BasicFigure<Coord, Scalar>(std::move(name)) {
                 setCorner(corners);
             }
 
         public:
+            /**
+             * \brief Makes the precision overloads of area() and perimeter() visible.
+             */
+            using BasicFigure<Coord, Scalar>::area;
+            using BasicFigure<Coord, Scalar>::perimeter;
+
 
             /**
              * \brief Creates a rectangle using side lengths and a center point.
@@ -79,7 +90,7 @@ namespace mw{
              * \param b Length of side B.
              * \param center Center point of the rectangle.
              */
-            Rectangle(double a, double b, const Point &center): Rectangle(a, b, center, "Rectangle") {}
+            BasicRectangle(Scalar a, Scalar b, const BasicPoint<Coord> &center): BasicRectangle(a, b, center, "Rectangle") {}
 
             /**
              * \brief Creates a rectangle from four corner points.
@@ -89,7 +100,7 @@ namespace mw{
              *
              * \param corners Array of four corner points.
              */
-            Rectangle(const std::array<Point, 4>& corners) : m_corner(corners), Figure("Rectangle") {
+            BasicRectangle(const std::array<BasicPoint<Coord>, 4>& corners) : m_corner(corners), BasicFigure<Coord, Scalar>("Rectangle") {
                 setCorner(corners);
             }
 
@@ -98,7 +109,7 @@ namespace mw{
              *
              * Default destructor for the Rectangle class.
              */
-            ~Rectangle() = default;
+            ~BasicRectangle() = default;
 
             /**
              * \brief Calculates the area of the rectangle.
@@ -107,7 +118,7 @@ namespace mw{
              *
              * \return The area of the rectangle.
             */
-            double area() const override{
+            Scalar area() const override{
                 return m_sideA * m_sideB;
             }
 
@@ -118,7 +129,7 @@ namespace mw{
              *
              * \return The perimeter of the rectangle.
              */
-            double perimeter() const override{
+            Scalar perimeter() const override{
                 return 2 * (m_sideA +  m_sideB);
             }
 
@@ -131,7 +142,7 @@ namespace mw{
              *
              * \throws const char* If a is less than zero.
              */
-            void setA(double a) {
+            void setA(Scalar a) {
                 if (a < 0) {
                     throw "a cannot be less than 0";
                 }
@@ -147,7 +158,7 @@ namespace mw{
              *
              * \throws const char* If b is less than zero.
              */
-            void setB(double b) {
+            void setB(Scalar b) {
                 if (b < 0) {
                     throw "b cannot be less than 0";
                 }
@@ -159,13 +170,27 @@ namespace mw{
              *
              * Determines whether the given points form a valid rectangle by checking
              * diagonal length and side orthogonality. Also rejects degenerate cases.
+             * The check is done in double precision whatever the Scalar type is.
+             * Axis-aligned corners are recognized first by comparisons alone and
+             * skip the diagonal search and the square roots.
              *
              * \param corners Array of four corner points.
              *
              * \throws const char* If the points do not form a rectangle or form
              *         a degenerate rectangle.
              */
-            void setCorner(const std::array<Point, 4>& corners) {
+            void setCorner(const std::array<BasicPoint<Coord>, 4>& corners) {
+                BasicAxisRect<Coord> box;
+                if (BasicAxisRect<Coord>::fromCorners(corners, box)) {
+                    // Side A runs from corner 0 to the first corner not opposite to it, as below
+                    bool opposite = corners[1].getX() != corners[0].getX() && corners[1].getY() != corners[0].getY();
+                    bool horizontal = corners[opposite ? 2 : 1].getY() == corners[0].getY();
+                    m_corner = corners;
+                    setA(Scalar(horizontal ? box.width() : box.height()));
+                    setB(Scalar(horizontal ? box.height() : box.width()));
+                    return;
+                }
+
                 int p1 = 0, p2 = -1, p3 = 1, p4 = -1;
                 double maxDistance = 0.0;
 
@@ -208,7 +233,7 @@ namespace mw{
                 const double eps = 0.000001;
 
                 // Validate rectangle geometry using Pythagorean theorem
-                if(abs(sideA * sideA + sideB * sideB - maxDistance) > eps){
+                if(std::abs(sideA * sideA + sideB * sideB - maxDistance) > eps){
                     throw " This is not a Rectangle";
                 }
             
@@ -217,8 +242,8 @@ namespace mw{
                 }
 
                 m_corner = corners;
-                setA(sideA);
-                setB(sideB);
+                setA(Scalar(sideA));
+                setB(Scalar(sideB));
             }
 
             /**
@@ -226,7 +251,7 @@ namespace mw{
              *
              * \return Length of side A.
              */
-            double getA() const {
+            Scalar getA() const {
                 return m_sideA;
             }
 
@@ -235,18 +260,99 @@ namespace mw{
              *
              * \return Length of side B.
              */
-            double getB() const {
+            Scalar getB() const {
                 return m_sideB;
             }
 
             /**
              * \brief Returns the corner points of the rectangle.
              *
-             * \return Array containing the four corner points.
+             * \return Constant reference to the array of the four corner points.
              */
-            std::array<Point, 4> getCorner() const{
+            const std::array<BasicPoint<Coord>, 4>& getCorner() const{
                 return m_corner;
             }
 
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return ShapeType::Rectangle.
+             */
+            ShapeType type() const override{
+                return ShapeType::Rectangle;
+            }
+
+            /**
+             * \brief Returns the outline of the rectangle.
+             *
+             * A rectangle created from corners uses those corners. A rectangle
+             * created from side lengths is axis-aligned, with side A along the
+             * X axis, centered at its center point.
+             *
+             * \return Polygon outline of the rectangle.
+             */
+            Outline outline() const override{
+                if (m_corner[0] == m_corner[1]) {
+                    double cx = this->getCenter().getX();
+                    double cy = this->getCenter().getY();
+                    return BasicAxisRect<double> {cx - m_sideA / 2, cy - m_sideB / 2, cx + m_sideA / 2, cy + m_sideB / 2}.outline();
+                }
+                BasicAxisRect<Coord> box;
+                if (BasicAxisRect<Coord>::fromCorners(m_corner, box)) {
+                    return box.outline();
+                }
+                std::array<Vec2, 4> v {};
+                for (int i = 0; i < 4; ++i) {
+                    v[i] = {double(m_corner[i].getX()), double(m_corner[i].getY())};
+                }
+                return Outline::polygon(v, 4);
+            }
+
+            /**
+             * \brief Checks whether the sides are parallel to the axes.
+             *
+             * Rectangles created from side lengths always are; for rectangles
+             * created from corners only the coordinates are compared.
+             *
+             * \return True if the rectangle is axis-aligned.
+             */
+            bool isAxisAligned() const {
+                BasicAxisRect<Coord> box;
+                return m_corner[0] == m_corner[1] || BasicAxisRect<Coord>::fromCorners(m_corner, box);
+            }
+
+            /**
+             * \brief Returns the compact axis-aligned representation of the rectangle.
+             *
+             * \param out Receives the minimum and maximum corners.
+             * \return False if the rectangle is not axis-aligned or, for one created
+             *         from side lengths, if its corners are not representable in Coord.
+             */
+            bool toAxisRect(BasicAxisRect<Coord> &out) const {
+                if (!(m_corner[0] == m_corner[1])) {
+                    return BasicAxisRect<Coord>::fromCorners(m_corner, out);
+                }
+                double cx = this->getCenter().getX();
+                double cy = this->getCenter().getY();
+                std::array<double, 4> v {cx - m_sideA / 2, cy - m_sideB / 2, cx + m_sideA / 2, cy + m_sideB / 2};
+                for (double c : v) {
+                    if (c < 0 || double(Coord(c)) != c) {
+                        return false;
+                    }
+                }
+                out = {Coord(v[0]), Coord(v[1]), Coord(v[2]), Coord(v[3])};
+                return true;
+            }
+
     };
+
+/**
+ * \brief Rectangle with integer corners and double sides, the default used across the library.
+ */
+    using Rectangle = BasicRectangle<int, double>;
+
+/**
+ * \brief Rectangle with float corners and sides for bulk work.
+ */
+    using RectangleF = BasicRectangle<float, float>;
 } // namespace mw
\ No newline at end of file
@@ -12,15 +12,19 @@ namespace mw{
  * This class models a rhombus defined either by its side length, acute angle,
  * and center point, or by four corner points. It provides methods to compute
  * the rhombus area and perimeter, as well as validation of its geometry.
+ *
+ * \tparam Coord Coordinate type of the center point and corners.
+ * \tparam Scalar Type of the side length and computed values.
  */
-    class Rhombus : public Figure {
+    template <typename Coord, typename Scalar>
+    class BasicRhombus : public BasicFigure<Coord, Scalar> {
         private:
             /**
              * \brief Length of the rhombus side.
              *
              * All sides of a rhombus have equal length. This value must be positive.
              */
-            double m_sideA;
+            Scalar m_sideA;
 
             /**
              * \brief Acute interior angle of the rhombus (in degrees).
@@ -35,15 +39,32 @@ namespace mw{
              *
              * Stores the four vertices of the rhombus.
              */
-            std::array<Point, 4> m_corner {};
+            std::array<BasicPoint<Coord>, 4> m_corner {};
+
+            /**
+             * \brief Returns the area spanned by the corners.
+             *
+             * Any three corners of a parallelogram span a triangle of half its area.
+             */
+            Scalar cornerArea() const {
+                double ux = double(m_corner[1].getX()) - m_corner[0].getX(), uy = double(m_corner[1].getY()) - m_corner[0].getY();
+                double vx = double(m_corner[2].getX()) - m_corner[0].getX(), vy = double(m_corner[2].getY()) - m_corner[0].getY();
+                return Scalar(std::abs(ux * vy - uy * vx));
+            }
 
         public:
+            /**
+             * \brief Makes the precision overloads of area() and perimeter() visible.
+             */
+            using BasicFigure<Coord, Scalar>::area;
+            using BasicFigure<Coord, Scalar>::perimeter;
+
             /**
              * \brief Corner points of the rhombus.
              *
              * Stores the four vertices of the rhombus.
              */
-            Rhombus(double a, short int angle, const Point &center) : m_sideA(a), m_angle(angle), Figure(center, "Rhombus") {
+            BasicRhombus(Scalar a, short int angle, const BasicPoint<Coord> &center) : m_sideA(a), m_angle(angle), BasicFigure<Coord, Scalar>(center, "Rhombus") {
                 setAngle(angle);
             }
 
@@ -51,12 +72,19 @@ namespace mw{
              * \brief Creates a rhombus from four corner points.
              *
              * Validates whether the provided points form a valid, non-degenerate
-             * rhombus and computes its side length and interior angle.
+             * rhombus and computes its side length and interior angle. The angle
+             * is rounded to the nearest whole degree; area() and outline() use
+             * the corners themselves.
+             *
+             * With Precision::Fast the angle is derived with FastMath::acosDegrees,
+             * so it can differ by one degree when the true angle is within
+             * FastMath::acosError of a half degree.
              *
              * \param corners Array of four corner points.
+             * \param precision Exact or fast approximate computation of the angle.
              */
-            Rhombus(const std::array<Point,4> corners) : m_corner(corners), Figure("Rhombus") {
-                validateCorners();
+            BasicRhombus(const std::array<BasicPoint<Coord>,4>& corners, Precision precision = Precision::Exact) : m_corner(corners), BasicFigure<Coord, Scalar>("Rhombus") {
+                validateCorners(precision);
             }
 
             /**
@@ -64,18 +92,40 @@ namespace mw{
              *
              * Default destructor for the Rhombus class.
              */
-            ~Rhombus() = default;
+            ~BasicRhombus() = default;
 
             /**
              * \brief Calculates the area of the rhombus.
              *
              * Uses the formula A = a² · sin(α), where α is the acute interior angle.
+             * A rhombus created from corners is measured from the corners instead,
+             * since its angle is rounded to whole degrees.
+             *
+             * \return The area of the rhombus.
+             */
+            Scalar area() const override{
+                if (!(m_corner[0] == m_corner[1])) {
+                    return cornerArea();
+                }
+                Scalar alpha = (m_angle*Scalar(M_PI))/180;
+                return  m_sideA * m_sideA * std::sin(alpha);
+            }
+
+            /**
+             * \brief Calculates the area of the rhombus with a selected precision.
              *
+             * The angle is a whole number of degrees, so the fast path looks the
+             * sine up in a table built at compile time instead of converting to
+             * radians and calling sin. The relative error is below 1e-15.
+             *
+             * \param precision Exact or fast approximate computation.
              * \return The area of the rhombus.
              */
-            double area() const override{
-                double alpha = (m_angle*M_PI)/180;
-                return  m_sideA * m_sideA * sin(alpha);
+            Scalar area(Precision precision) const override{
+                if (precision == Precision::Exact || !(m_corner[0] == m_corner[1])) {
+                    return area();
+                }
+                return m_sideA * m_sideA * Scalar(FastMath::sinDegrees(m_angle));
             }
 
             /**
@@ -85,7 +135,7 @@ namespace mw{
              *
              * \return The perimeter of the rhombus.
              */
-            double perimeter() const override{
+            Scalar perimeter() const override{
                 return 4 * m_sideA;
             }
 
@@ -98,7 +148,7 @@ namespace mw{
              *
              * \throws const char* If a is less than zero.
              */
-            void setA(double a) {
+            void setA(Scalar a) {
                 if (a < 0) {
                     throw "a cannot be less than 0";
                 }
@@ -110,7 +160,7 @@ namespace mw{
              *
              * \return Length of the rhombus side.
              */
-            double getA() const{
+            Scalar getA() const{
                 return m_sideA;
             }
 
@@ -140,84 +190,125 @@ namespace mw{
             }
 
             /**
-             * \brief Validates corner points and computes rhombus properties.
+             * \brief Returns the corner points of the rhombus.
              *
-             * Checks whether the four stored points form a valid rhombus by analyzing
-             * pairwise distances, ensuring four equal sides and two diagonals.
-             * Computes the side length and acute interior angle.
+             * All corners are (0, 0) for a rhombus created from side length and angle.
              *
-             * \throws const char* If the points do not form a valid rhombus or form
-             *         a degenerate shape.
+             * \return Constant reference to the array of the four corner points.
              */
-            void validateCorners() {
-                double d[6];
-                int k = 0;
+            const std::array<BasicPoint<Coord>, 4>& getCorner() const{
+                return m_corner;
+            }
 
-                // Compute squared distances between all point pairs
-                for (int i = 0; i < 4; ++i) {
-                    for (int j = i + 1; j < 4; ++j) {
-                        double dx = m_corner[i].getX() - m_corner[j].getX();
-                        double dy = m_corner[i].getY() - m_corner[j].getY();
-                        d[k++] = dx * dx + dy * dy;
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return ShapeType::Rhombus.
+             */
+            ShapeType type() const override{
+                return ShapeType::Rhombus;
+            }
+
+            /**
+             * \brief Returns the outline of the rhombus.
+             *
+             * A rhombus created from corners uses those corners. A rhombus created
+             * from side length and angle has one side along the X axis and is
+             * centered at its center point.
+             *
+             * \return Polygon outline of the rhombus.
+             */
+            Outline outline() const override{
+                std::array<Vec2, 4> v {};
+                if (m_corner[0] == m_corner[1]) {
+                    double alpha = (m_angle * M_PI) / 180;
+                    double dx = m_sideA * cos(alpha);
+                    double dy = m_sideA * sin(alpha);
+                    double cx = this->getCenter().getX() - (m_sideA + dx) / 2;
+                    double cy = this->getCenter().getY() - dy / 2;
+                    v = {Vec2{cx, cy}, Vec2{cx + m_sideA, cy}, Vec2{cx + m_sideA + dx, cy + dy}, Vec2{cx + dx, cy + dy}};
+                }
+                else {
+                    for (int i = 0; i < 4; ++i) {
+                        v[i] = {double(m_corner[i].getX()), double(m_corner[i].getY())};
                     }
                 }
+                return Outline::polygon(v, 4);
+            }
 
+            /**
+             * \brief Validates corner points and computes rhombus properties.
+             *
+             * The corners may come in any order. The two diagonals are the pair of
+             * corner pairs sharing a midpoint, and a rhombus is a parallelogram
+             * whose diagonals are perpendicular. With the squared diagonals d1 < d2,
+             * the side is sqrt((d1 + d2) / 4) and the acute angle is
+             * acos((d2 - d1) / (d2 + d1)). The check is done in double precision
+             * whatever the Scalar type is.
+             *
+             * \param precision Exact or fast approximate computation of the angle.
+             *
+             * \throws const char* If the points do not form a valid rhombus, form
+             *         a degenerate shape or form a square.
+             */
+            void validateCorners(Precision precision = Precision::Exact) {
                 const double eps = 1e-6;
+                auto x = [this](int i) { return double(m_corner[i].getX()); };
+                auto y = [this](int i) { return double(m_corner[i].getY()); };
 
-                // Find the smallest non-zero distance (side length squared)
-                double side2 = 0;
-                for (int i = 0; i < 6; ++i) {
-                    if (d[i] > eps && (side2 == 0 || d[i] < side2)) {
-                    side2 = d[i];
+                // Find the diagonals: the corner pairs with a common midpoint
+                const int pairs[3][4] = {{0, 1, 2, 3}, {0, 2, 1, 3}, {0, 3, 1, 2}};
+                const int *diagonal = nullptr;
+                for (const int *p : pairs) {
+                    if (std::abs(x(p[0]) + x(p[1]) - x(p[2]) - x(p[3])) < eps
+                        && std::abs(y(p[0]) + y(p[1]) - y(p[2]) - y(p[3])) < eps) {
+                        diagonal = p;
+                        break;
                     }
                 }
-
-                if (side2 == 0) {
-                    throw "Degenerate rhombus";
+                if (diagonal == nullptr) {
+                    throw "Points do not form a rhombus";
                 }
 
-                // Count occurrences of side length
-                int count = 0;
-                for (int i = 0; i < 6; ++i) {
-                    if (std::abs(d[i] - side2) < eps){
-                    count++;
-                    }
+                double ux = x(diagonal[1]) - x(diagonal[0]), uy = y(diagonal[1]) - y(diagonal[0]);
+                double vx = x(diagonal[3]) - x(diagonal[2]), vy = y(diagonal[3]) - y(diagonal[2]);
+                double d1 = ux * ux + uy * uy, d2 = vx * vx + vy * vy;
+                if (d1 < eps || d2 < eps) {
+                    throw "Degenerate rhombus";
                 }
-
-                if (count != 4) {
+                if (std::abs(ux * vx + uy * vy) > eps) {
                     throw "Points do not form a rhombus";
                 }
-
-                m_sideA = std::sqrt(side2);
-
-                // Identify diagonals
-                double diag1 = 0, diag2 = 0;
-                for (int i = 0; i < 6; ++i) {
-                    if (d[i] > side2 + eps) {
-                        if (diag1 == 0){
-                            diag1 = d[i];
-                        }
-                        else {
-                            diag2 = d[i];
-                        }
-                    }
-                }
-
-                if (diag1 == 0 || diag2 == 0) {
-                    throw "Invalid rhombus geometry";
+                if (std::abs(d1 - d2) < eps) {
+                    throw "Angle must be acute";
                 }
 
                 // Compute acute angle using diagonal lengths
-                double cosAlpha = (diag1 + diag2 - 4 * side2) / (2 * std::sqrt(diag1 * diag2));
-
-                // Compute acute angle using diagonal lengths
-                double alpha = std::acos(cosAlpha) * 180.0 / M_PI;
+                double cosAlpha = std::abs(d2 - d1) / (d1 + d2);
+                double alpha = precision == Precision::Exact ? std::acos(cosAlpha) * 180.0 / M_PI
+                                                             : FastMath::acosDegrees(cosAlpha);
 
                 if (alpha <= 0 || alpha >= 90){
                     throw "Angle must be acute";
                 }
 
-                m_angle = static_cast<short int>(alpha);
+                // Whole degrees like every other rhombus; a rhombus too flat or too square for them is rejected
+                long rounded = std::lround(alpha);
+                if (rounded <= 0 || rounded >= 90) {
+                    throw "Angle must be acute";
+                }
+                m_sideA = Scalar(std::sqrt((d1 + d2) / 4));
+                m_angle = static_cast<short int>(rounded);
             }
     };
+
+/**
+ * \brief Rhombus with integer corners and double side, the default used across the library.
+ */
+    using Rhombus = BasicRhombus<int, double>;
+
+/**
+ * \brief Rhombus with float corners and side for bulk work.
+ */
+    using RhombusF = BasicRhombus<float, float>;
 } // namespace mw
\ No newline at end of file
@@ -0,0 +1,495 @@
+#pragma once
+
+#include "Figure.hpp"
+#include "Geometry.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mw{
+
+/**
+ * \brief One figure as stored in shared memory.
+ *
+ * Holds everything readers need without calling back into the figure
+ * classes: the precomputed values, the exact outline and the bounds. The name
+ * is an offset into the string pool of the same buffer, so the record
+ * contains no pointers and means the same in every process.
+ */
+    struct SharedRecord {
+        /**
+         * \brief Type of the figure.
+         */
+        ShapeType type;
+
+        /**
+         * \brief X coordinate of the center.
+         */
+        std::int32_t x;
+
+        /**
+         * \brief Y coordinate of the center.
+         */
+        std::int32_t y;
+
+        /**
+         * \brief Offset of the name in the string pool.
+         */
+        std::uint32_t nameOffset;
+
+        /**
+         * \brief Length of the name in bytes.
+         */
+        std::uint32_t nameLength;
+
+        /**
+         * \brief Area of the figure.
+         */
+        double area;
+
+        /**
+         * \brief Perimeter of the figure.
+         */
+        double perimeter;
+
+        /**
+         * \brief Axis-aligned bounds of the outline.
+         */
+        BoundingBox bounds;
+
+        /**
+         * \brief Exact boundary of the figure.
+         */
+        Outline outline;
+    };
+
+/**
+ * \brief Figure store in a POSIX shared-memory segment, written by one process and read by many.
+ *
+ * The segment holds a small header and several equally sized buffers. Every
+ * buffer is one complete, immutable version of the scene: a record array
+ * followed by a string pool, addressed only by offsets. The writer fills a
+ * buffer that is neither the published one nor in use by a reader and then
+ * publishes it with a single atomic store, so readers never see a partly
+ * written scene.
+ *
+ * Readers take a snapshot: they increment the reader count of the published
+ * buffer and check that it is still the published one, retrying otherwise.
+ * That is two atomic operations and never waits for the writer; the records
+ * are then read in place, without copying or parsing. The writer only has to
+ * wait if every other buffer is pinned by a reader, which with the default
+ * three buffers means readers hold on to two old versions.
+ *
+ * A reader that dies while holding a snapshot leaves its buffer pinned, so
+ * use more buffers if reader processes can be killed.
+ */
+    class SharedFigureStore {
+        private:
+            /**
+             * \brief Identifies a segment created by this class.
+             */
+            static constexpr std::uint64_t magic = 0x6d77666967737431ULL;
+
+            /**
+             * \brief Largest number of buffers.
+             */
+            static constexpr std::uint32_t maxBuffers = 8;
+
+            /**
+             * \brief Start of the segment, shared by all processes.
+             */
+            struct Header {
+                std::uint64_t magic;
+                std::uint32_t buffers;
+                std::uint32_t reserved;
+                std::uint64_t bufferBytes;
+                std::atomic<std::uint64_t> published;
+                std::atomic<std::uint32_t> readers[maxBuffers];
+            };
+
+            /**
+             * \brief Start of every buffer.
+             */
+            struct BufferHeader {
+                std::uint64_t version;
+                std::uint64_t count;
+                std::uint64_t nameBytes;
+            };
+
+            static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared atomics must be lock-free");
+            static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Shared atomics must be lock-free");
+            static_assert(std::is_trivially_copyable<SharedRecord>::value, "Records must be trivially copyable");
+
+            /**
+             * \brief Size of the segment header, rounded up to a cache line.
+             */
+            static constexpr std::size_t headerBytes = (sizeof(Header) + 63) / 64 * 64;
+
+            /**
+             * \brief Mapped segment.
+             */
+            void *m_base = nullptr;
+
+            /**
+             * \brief Size of the mapping in bytes.
+             */
+            std::size_t m_bytes = 0;
+
+            /**
+             * \brief Version of the last publish() of this writer.
+             */
+            std::uint64_t m_version = 0;
+
+            /**
+             * \brief Maps an open segment.
+             */
+            SharedFigureStore(int fd, std::size_t bytes) : m_bytes(bytes) {
+                m_base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (m_base == MAP_FAILED) {
+                    m_base = nullptr;
+                    throw "Cannot map shared memory";
+                }
+            }
+
+            /**
+             * \brief Returns the segment header.
+             */
+            Header &header() const {
+                return *static_cast<Header*>(m_base);
+            }
+
+            /**
+             * \brief Returns the start of a buffer.
+             */
+            char *buffer(std::uint32_t index) const {
+                return static_cast<char*>(m_base) + headerBytes + index * header().bufferBytes;
+            }
+
+        public:
+            /**
+             * \brief Read-only view of one published version.
+             *
+             * Keeps its buffer pinned until it is destroyed; records and names
+             * point straight into shared memory.
+             */
+            class Snapshot {
+                private:
+                    friend class SharedFigureStore;
+
+                    /**
+                     * \brief Reader count of the pinned buffer.
+                     */
+                    std::atomic<std::uint32_t> *m_readers = nullptr;
+
+                    /**
+                     * \brief Header of the pinned buffer.
+                     */
+                    const BufferHeader *m_buffer = nullptr;
+
+                    Snapshot(std::atomic<std::uint32_t> *readers, const char *buffer)
+                        : m_readers(readers), m_buffer(reinterpret_cast<const BufferHeader*>(buffer)) {}
+
+                    /**
+                     * \brief Returns the record array.
+                     */
+                    const SharedRecord *records() const {
+                        return reinterpret_cast<const SharedRecord*>(reinterpret_cast<const char*>(m_buffer) + sizeof(BufferHeader));
+                    }
+
+                public:
+                    Snapshot(const Snapshot&) = delete;
+                    Snapshot &operator=(const Snapshot&) = delete;
+
+                    /**
+                     * \brief Takes over the pin of another snapshot.
+                     *
+                     * \param other Snapshot to move from; it becomes empty.
+                     */
+                    Snapshot(Snapshot &&other) noexcept : m_readers(other.m_readers), m_buffer(other.m_buffer) {
+                        other.m_readers = nullptr;
+                    }
+
+                    /**
+                     * \brief Releases the pinned buffer.
+                     */
+                    ~Snapshot() {
+                        if (m_readers != nullptr) {
+                            m_readers->fetch_sub(1);
+                        }
+                    }
+
+                    /**
+                     * \brief Returns the version number of the snapshot.
+                     *
+                     * \return Version counted from 1 by the writer.
+                     */
+                    std::uint64_t version() const {
+                        return m_buffer->version;
+                    }
+
+                    /**
+                     * \brief Returns the number of figures.
+                     *
+                     * \return Number of records.
+                     */
+                    std::size_t size() const {
+                        return m_buffer->count;
+                    }
+
+                    /**
+                     * \brief Returns one record.
+                     *
+                     * \param i Index of the record.
+                     * \return Constant reference into shared memory.
+                     */
+                    const SharedRecord &operator[](std::size_t i) const {
+                        return records()[i];
+                    }
+
+                    /**
+                     * \brief Returns the name of one figure.
+                     *
+                     * \param i Index of the record.
+                     * \return View into the string pool in shared memory.
+                     */
+                    std::string_view name(std::size_t i) const {
+                        const char *pool = reinterpret_cast<const char*>(records() + m_buffer->count);
+                        return std::string_view(pool + records()[i].nameOffset, records()[i].nameLength);
+                    }
+
+                    /**
+                     * \brief Calls a function for every figure whose bounds overlap a box.
+                     *
+                     * \param box Query box.
+                     * \param fn Called with the index and the record of every candidate.
+                     */
+                    template <typename Fn>
+                    void query(const BoundingBox &box, Fn fn) const {
+                        const SharedRecord *r = records();
+                        for (std::size_t i = 0; i < m_buffer->count; ++i) {
+                            if (r[i].bounds.overlaps(box)) {
+                                fn(i, r[i]);
+                            }
+                        }
+                    }
+            };
+
+            SharedFigureStore(const SharedFigureStore&) = delete;
+            SharedFigureStore &operator=(const SharedFigureStore&) = delete;
+
+            /**
+             * \brief Takes over the mapping of another store.
+             *
+             * \param other Store to move from; it becomes empty.
+             */
+            SharedFigureStore(SharedFigureStore &&other) noexcept
+                : m_base(other.m_base), m_bytes(other.m_bytes), m_version(other.m_version) {
+                other.m_base = nullptr;
+            }
+
+            /**
+             * \brief Unmaps the segment. The segment itself stays until unlink().
+             */
+            ~SharedFigureStore() {
+                if (m_base != nullptr) {
+                    munmap(m_base, m_bytes);
+                }
+            }
+
+            /**
+             * \brief Creates a new segment for the writer.
+             *
+             * \param name Name of the segment, starting with a slash.
+             * \param bufferBytes Size of every buffer; limits the size of one version.
+             * \param buffers Number of buffers, from 2 to 8.
+             * \return Store mapped for writing.
+             *
+             * \throws const char* If the segment exists or cannot be created, or the parameters are invalid.
+             */
+            static SharedFigureStore create(const std::string &name, std::size_t bufferBytes, std::uint32_t buffers = 3) {
+                if (buffers < 2 || buffers > maxBuffers) {
+                    throw "Number of buffers must be from 2 to 8";
+                }
+                bufferBytes = (std::max<std::size_t>(bufferBytes, sizeof(BufferHeader)) + 63) / 64 * 64;
+                std::size_t bytes = headerBytes + buffers * bufferBytes;
+
+                int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+                if (fd < 0) {
+                    throw "Cannot create shared memory";
+                }
+                if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                    close(fd);
+                    shm_unlink(name.c_str());
+                    throw "Cannot resize shared memory";
+                }
+                SharedFigureStore store(fd, bytes);
+                Header *h = new (store.m_base) Header;
+                h->buffers = buffers;
+                h->reserved = 0;
+                h->bufferBytes = bufferBytes;
+                h->published.store(0);
+                for (std::atomic<std::uint32_t> &r : h->readers) {
+                    r.store(0);
+                }
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                h->magic = magic;
+                return store;
+            }
+
+            /**
+             * \brief Opens an existing segment for reading.
+             *
+             * \param name Name of the segment.
+             * \return Store mapped for taking snapshots.
+             *
+             * \throws const char* If the segment does not exist or was not created by this class.
+             */
+            static SharedFigureStore open(const std::string &name) {
+                int fd = shm_open(name.c_str(), O_RDWR, 0600);
+                if (fd < 0) {
+                    throw "Cannot open shared memory";
+                }
+                struct stat info;
+                if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < headerBytes) {
+                    close(fd);
+                    throw "Not a figure store";
+                }
+                SharedFigureStore store(fd, static_cast<std::size_t>(info.st_size));
+                const Header &h = store.header();
+                if (h.magic != magic || headerBytes + h.buffers * h.bufferBytes > store.m_bytes) {
+                    throw "Not a figure store";
+                }
+                return store;
+            }
+
+            /**
+             * \brief Removes a segment name; mapped stores stay usable.
+             *
+             * \param name Name of the segment.
+             */
+            static void unlink(const std::string &name) {
+                shm_unlink(name.c_str());
+            }
+
+            /**
+             * \brief Publishes a new version of the scene.
+             *
+             * Records are built in parallel in a free buffer, which is then
+             * made visible to readers at once.
+             *
+             * \param figures Figures of the new version.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Version number of the published scene.
+             *
+             * \throws const char* If the scene does not fit into one buffer.
+             */
+            std::uint64_t publish(const std::vector<const Figure*> &figures, unsigned threads = 0) {
+                Header &h = header();
+                std::size_t nameBytes = 0;
+                for (const Figure *f : figures) {
+                    nameBytes += f->getName().size();
+                }
+                if (sizeof(BufferHeader) + figures.size() * sizeof(SharedRecord) + nameBytes > h.bufferBytes
+                    || nameBytes > 0xffffffffULL) {
+                    throw "Scene does not fit into the shared buffer";
+                }
+
+                // Any buffer that is not published and not pinned; readers hold them only briefly
+                std::uint32_t current = static_cast<std::uint32_t>(h.published.load() & 0xff);
+                std::uint32_t target = maxBuffers;
+                while (target == maxBuffers) {
+                    for (std::uint32_t i = 0; i < h.buffers; ++i) {
+                        if ((m_version == 0 || i != current) && h.readers[i].load() == 0) {
+                            target = i;
+                            break;
+                        }
+                    }
+                    if (target == maxBuffers) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                char *base = buffer(target);
+                BufferHeader *bh = reinterpret_cast<BufferHeader*>(base);
+                SharedRecord *records = reinterpret_cast<SharedRecord*>(base + sizeof(BufferHeader));
+                char *pool = reinterpret_cast<char*>(records + figures.size());
+
+                std::vector<std::uint32_t> offset(figures.size());
+                std::uint32_t next = 0;
+                for (std::size_t i = 0; i < figures.size(); ++i) {
+                    offset[i] = next;
+                    next += static_cast<std::uint32_t>(figures[i]->getName().size());
+                }
+                parallelFor(figures.size(), 1024, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const Figure &f = *figures[i];
+                        SharedRecord &r = records[i];
+                        r.type = f.type();
+                        r.x = f.getCenter().getX();
+                        r.y = f.getCenter().getY();
+                        r.nameOffset = offset[i];
+                        r.nameLength = static_cast<std::uint32_t>(f.getName().size());
+                        r.area = f.area();
+                        r.perimeter = f.perimeter();
+                        r.outline = f.outline();
+                        r.bounds = r.outline.bounds();
+                        std::memcpy(pool + offset[i], f.getName().data(), f.getName().size());
+                    }
+                }, threads);
+
+                bh->version = ++m_version;
+                bh->count = figures.size();
+                bh->nameBytes = nameBytes;
+                h.published.store((m_version << 8) | target);
+                return m_version;
+            }
+
+            /**
+             * \brief Takes a snapshot of the published version.
+             *
+             * \return Snapshot pinning the published buffer.
+             *
+             * \throws const char* If nothing was published yet.
+             */
+            Snapshot snapshot() const {
+                Header &h = header();
+                while (true) {
+                    std::uint64_t published = h.published.load();
+                    if (published == 0) {
+                        throw "Nothing published yet";
+                    }
+                    std::uint32_t index = static_cast<std::uint32_t>(published & 0xff);
+                    h.readers[index].fetch_add(1);
+                    // The writer may have taken the buffer before the pin became visible
+                    if (h.published.load() == published) {
+                        return Snapshot(&h.readers[index], buffer(index));
+                    }
+                    h.readers[index].fetch_sub(1);
+                }
+            }
+
+            /**
+             * \brief Returns the published version number.
+             *
+             * \return Version number, 0 if nothing was published.
+             */
+            std::uint64_t version() const {
+                return header().published.load() >> 8;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,533 @@
+#pragma once
+
+#include "Circle.hpp"
+#include "Figure.hpp"
+#include "Rectangle.hpp"
+#include "Rhombus.hpp"
+#include "Square.hpp"
+#include "Triangle.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Copies a figure of any of the library's types.
+ *
+ * \param figure Figure to copy.
+ * \return New figure of the same type and with the same state.
+ */
+    inline std::unique_ptr<Figure> clone(const Figure &figure) {
+        switch (figure.type()) {
+            case ShapeType::Circle:
+                return std::unique_ptr<Figure>(new Circle(static_cast<const Circle&>(figure)));
+            case ShapeType::Triangle:
+                return std::unique_ptr<Figure>(new Triangle(static_cast<const Triangle&>(figure)));
+            case ShapeType::Rectangle:
+                return std::unique_ptr<Figure>(new Rectangle(static_cast<const Rectangle&>(figure)));
+            case ShapeType::Square:
+                return std::unique_ptr<Figure>(new Square(static_cast<const Square&>(figure)));
+            case ShapeType::Rhombus:
+                return std::unique_ptr<Figure>(new Rhombus(static_cast<const Rhombus&>(figure)));
+        }
+        throw "Unknown figure type";
+    }
+
+/**
+ * \brief Figure collection with immutable versions for concurrent readers.
+ *
+ * Every published version is an immutable array of (id, figure) pairs sorted
+ * by id. Readers take a snapshot of the current version and use it without
+ * any lock; the figures of a version are never changed, so calling area(),
+ * perimeter() or getCenter() on them is safe from any number of threads.
+ *
+ * The writer collects additions, removals and modifications in a Batch and
+ * publishes it as a new version with one atomic pointer swap, so readers see
+ * either none or all of a batch. Modifying a figure copies it first (copy on
+ * write); unchanged figures are shared between versions.
+ *
+ * Replaced versions and figures are reclaimed by epochs: a reader announces
+ * the global epoch in its own cache line while it holds a snapshot, and the
+ * writer frees an old version only when every active reader announced a later
+ * epoch. Taking a snapshot is a fixed number of atomic loads and stores with
+ * no retry loop, so readers are wait-free and never touch shared cache lines
+ * for writing, which lets read throughput scale with the number of threads.
+ */
+    class SnapshotCollection {
+        private:
+            /**
+             * \brief Largest number of simultaneous reader handles.
+             */
+            static constexpr std::size_t maxReaders = 256;
+
+            /**
+             * \brief One figure of a version.
+             */
+            struct Entry {
+                std::uint64_t id;
+                const Figure *figure;
+            };
+
+            /**
+             * \brief One immutable version.
+             */
+            struct Version {
+                std::uint64_t number;
+                std::vector<Entry> entries;
+            };
+
+            /**
+             * \brief Version and figures waiting until no reader can see them.
+             */
+            struct Retired {
+                std::uint64_t epoch;
+                const Version *version;
+                std::vector<const Figure*> figures;
+            };
+
+            /**
+             * \brief Epoch announcement of one reader, alone in its cache line.
+             */
+            struct alignas(64) Slot {
+                std::atomic<std::uint64_t> epoch {0};
+                std::atomic<bool> used {false};
+            };
+
+            /**
+             * \brief Published version.
+             */
+            std::atomic<const Version*> m_current;
+
+            /**
+             * \brief Global epoch, advanced on every publish.
+             */
+            std::atomic<std::uint64_t> m_epoch {1};
+
+            /**
+             * \brief Reader slots.
+             */
+            Slot m_slot[maxReaders];
+
+            /**
+             * \brief Serializes writers.
+             */
+            std::mutex m_writer;
+
+            /**
+             * \brief Next figure id.
+             */
+            std::uint64_t m_nextId = 1;
+
+            /**
+             * \brief Versions and figures not freed yet.
+             */
+            std::vector<Retired> m_retired;
+
+            /**
+             * \brief Frees retired versions no reader can see any more.
+             */
+            void reclaim() {
+                std::uint64_t oldest = UINT64_MAX;
+                for (const Slot &s : m_slot) {
+                    std::uint64_t e = s.epoch.load();
+                    if (e != 0) {
+                        oldest = std::min(oldest, e);
+                    }
+                }
+                auto freed = std::stable_partition(m_retired.begin(), m_retired.end(), [oldest](const Retired &r) {
+                    return r.epoch >= oldest;
+                });
+                for (auto it = freed; it != m_retired.end(); ++it) {
+                    delete it->version;
+                    for (const Figure *f : it->figures) {
+                        delete f;
+                    }
+                }
+                m_retired.erase(freed, m_retired.end());
+            }
+
+        public:
+            /**
+             * \brief Changes to publish as one version.
+             */
+            class Batch {
+                private:
+                    friend class SnapshotCollection;
+
+                    /**
+                     * \brief Collection the batch belongs to.
+                     */
+                    SnapshotCollection *m_owner;
+
+                    /**
+                     * \brief Added and modified figures by id; modified ones replace the current figure.
+                     */
+                    std::vector<std::pair<std::uint64_t, std::unique_ptr<Figure>>> m_put;
+
+                    /**
+                     * \brief Ids of removed figures.
+                     */
+                    std::vector<std::uint64_t> m_removed;
+
+                    explicit Batch(SnapshotCollection *owner) : m_owner(owner) {}
+
+                    /**
+                     * \brief Returns the pending copy of a figure, or nullptr.
+                     */
+                    Figure *pending(std::uint64_t id) {
+                        for (auto &p : m_put) {
+                            if (p.first == id) {
+                                return p.second.get();
+                            }
+                        }
+                        return nullptr;
+                    }
+
+                public:
+                    /**
+                     * \brief Adds a figure.
+                     *
+                     * \param figure Figure to add; the collection takes ownership.
+                     * \return Id of the figure, valid once the batch is published.
+                     */
+                    std::uint64_t add(std::unique_ptr<Figure> figure) {
+                        std::uint64_t id;
+                        {
+                            std::lock_guard<std::mutex> lock(m_owner->m_writer);
+                            id = m_owner->m_nextId++;
+                        }
+                        m_put.emplace_back(id, std::move(figure));
+                        return id;
+                    }
+
+                    /**
+                     * \brief Adds a copy of a figure.
+                     *
+                     * \param figure Figure to copy.
+                     * \return Id of the figure, valid once the batch is published.
+                     */
+                    std::uint64_t add(const Figure &figure) {
+                        return add(clone(figure));
+                    }
+
+                    /**
+                     * \brief Removes a figure.
+                     *
+                     * \param id Id of the figure.
+                     */
+                    void remove(std::uint64_t id) {
+                        m_put.erase(std::remove_if(m_put.begin(), m_put.end(), [id](const auto &p) {
+                            return p.first == id;
+                        }), m_put.end());
+                        m_removed.push_back(id);
+                    }
+
+                    /**
+                     * \brief Changes a copy of a figure; the copy replaces it on publish.
+                     *
+                     * \param id Id of the figure.
+                     * \param fn Function called with the copy.
+                     *
+                     * \throws const char* If there is no figure with that id.
+                     */
+                    template <typename Fn>
+                    void modify(std::uint64_t id, Fn fn) {
+                        Figure *copy = pending(id);
+                        if (copy == nullptr) {
+                            std::lock_guard<std::mutex> lock(m_owner->m_writer);
+                            const Figure *current = m_owner->find(*m_owner->m_current.load(), id);
+                            if (current == nullptr) {
+                                throw "No figure with this id";
+                            }
+                            m_put.emplace_back(id, clone(*current));
+                            copy = m_put.back().second.get();
+                        }
+                        fn(*copy);
+                    }
+            };
+
+            /**
+             * \brief Read-only view of one version.
+             *
+             * The version and its figures stay valid until the snapshot is
+             * destroyed. A reader handle holds at most one snapshot at a time.
+             */
+            class Snapshot {
+                private:
+                    friend class SnapshotCollection;
+
+                    /**
+                     * \brief Epoch slot of the reader, cleared on destruction.
+                     */
+                    std::atomic<std::uint64_t> *m_epoch;
+
+                    /**
+                     * \brief Pinned version.
+                     */
+                    const Version *m_version;
+
+                    Snapshot(std::atomic<std::uint64_t> *epoch, const Version *version) : m_epoch(epoch), m_version(version) {}
+
+                public:
+                    Snapshot(const Snapshot&) = delete;
+                    Snapshot &operator=(const Snapshot&) = delete;
+
+                    /**
+                     * \brief Takes over another snapshot.
+                     *
+                     * \param other Snapshot to move from; it becomes empty.
+                     */
+                    Snapshot(Snapshot &&other) noexcept : m_epoch(other.m_epoch), m_version(other.m_version) {
+                        other.m_epoch = nullptr;
+                    }
+
+                    /**
+                     * \brief Releases the version.
+                     */
+                    ~Snapshot() {
+                        if (m_epoch != nullptr) {
+                            m_epoch->store(0, std::memory_order_release);
+                        }
+                    }
+
+                    /**
+                     * \brief Returns the version number.
+                     *
+                     * \return Number of publishes before this version.
+                     */
+                    std::uint64_t version() const {
+                        return m_version->number;
+                    }
+
+                    /**
+                     * \brief Returns the number of figures.
+                     *
+                     * \return Number of figures in the version.
+                     */
+                    std::size_t size() const {
+                        return m_version->entries.size();
+                    }
+
+                    /**
+                     * \brief Returns a figure by position.
+                     *
+                     * \param i Position, figures are ordered by id.
+                     * \return Constant reference to the figure.
+                     */
+                    const Figure &operator[](std::size_t i) const {
+                        return *m_version->entries[i].figure;
+                    }
+
+                    /**
+                     * \brief Returns the id of the figure at a position.
+                     *
+                     * \param i Position.
+                     * \return Id of the figure.
+                     */
+                    std::uint64_t id(std::size_t i) const {
+                        return m_version->entries[i].id;
+                    }
+
+                    /**
+                     * \brief Finds a figure by id.
+                     *
+                     * \param id Id of the figure.
+                     * \return Pointer to the figure or nullptr if the version does not contain it.
+                     */
+                    const Figure *find(std::uint64_t id) const {
+                        return SnapshotCollection::find(*m_version, id);
+                    }
+            };
+
+            /**
+             * \brief Registration of one reader thread.
+             *
+             * Create one handle per reader thread and take snapshots through it.
+             */
+            class Reader {
+                private:
+                    friend class SnapshotCollection;
+
+                    /**
+                     * \brief Collection being read.
+                     */
+                    const SnapshotCollection *m_owner;
+
+                    /**
+                     * \brief Claimed slot.
+                     */
+                    Slot *m_slot;
+
+                    Reader(const SnapshotCollection *owner, Slot *slot) : m_owner(owner), m_slot(slot) {}
+
+                public:
+                    Reader(const Reader&) = delete;
+                    Reader &operator=(const Reader&) = delete;
+
+                    /**
+                     * \brief Takes over another handle.
+                     *
+                     * \param other Handle to move from; it becomes empty.
+                     */
+                    Reader(Reader &&other) noexcept : m_owner(other.m_owner), m_slot(other.m_slot) {
+                        other.m_slot = nullptr;
+                    }
+
+                    /**
+                     * \brief Frees the slot.
+                     */
+                    ~Reader() {
+                        if (m_slot != nullptr) {
+                            m_slot->used.store(false);
+                        }
+                    }
+
+                    /**
+                     * \brief Takes a snapshot of the current version. Wait-free.
+                     *
+                     * \return Snapshot pinning the current version.
+                     */
+                    Snapshot snapshot() const {
+                        // Announce the epoch before reading the version, so the
+                        // writer cannot free what is about to be read
+                        m_slot->epoch.store(m_owner->m_epoch.load());
+                        return Snapshot(&m_slot->epoch, m_owner->m_current.load());
+                    }
+            };
+
+            /**
+             * \brief Creates an empty collection.
+             */
+            SnapshotCollection() : m_current(new Version {0, {}}) {}
+
+            SnapshotCollection(const SnapshotCollection&) = delete;
+            SnapshotCollection &operator=(const SnapshotCollection&) = delete;
+
+            /**
+             * \brief Frees all versions and figures. No snapshot may be alive.
+             */
+            ~SnapshotCollection() {
+                for (Slot &s : m_slot) {
+                    s.epoch.store(0);
+                }
+                reclaim();
+                const Version *v = m_current.load();
+                for (const Entry &e : v->entries) {
+                    delete e.figure;
+                }
+                delete v;
+            }
+
+            /**
+             * \brief Registers a reader.
+             *
+             * \return Handle to take snapshots with.
+             *
+             * \throws const char* If there are already maxReaders handles.
+             */
+            Reader reader() const {
+                for (const Slot &s : m_slot) {
+                    Slot &slot = const_cast<Slot&>(s);
+                    bool expected = false;
+                    if (slot.used.compare_exchange_strong(expected, true)) {
+                        return Reader(this, &slot);
+                    }
+                }
+                throw "Too many readers";
+            }
+
+            /**
+             * \brief Starts a batch of changes.
+             *
+             * \return Empty batch.
+             */
+            Batch batch() {
+                return Batch(this);
+            }
+
+            /**
+             * \brief Publishes a batch as a new version.
+             *
+             * Frees the versions and figures that no reader can see any more.
+             *
+             * \param batch Changes to apply; emptied.
+             * \return Number of the new version.
+             */
+            std::uint64_t publish(Batch &batch) {
+                std::lock_guard<std::mutex> lock(m_writer);
+                const Version *old = m_current.load();
+                Version *next = new Version {old->number + 1, {}};
+                next->entries.reserve(old->entries.size() + batch.m_put.size());
+                Retired retired {0, old, {}};
+
+                std::sort(batch.m_put.begin(), batch.m_put.end(), [](const auto &a, const auto &b) {
+                    return a.first < b.first;
+                });
+                std::sort(batch.m_removed.begin(), batch.m_removed.end());
+
+                // Merge the sorted changes into the sorted entries
+                auto put = batch.m_put.begin();
+                for (const Entry &e : old->entries) {
+                    while (put != batch.m_put.end() && put->first < e.id) {
+                        next->entries.push_back({put->first, put->second.release()});
+                        ++put;
+                    }
+                    bool removed = std::binary_search(batch.m_removed.begin(), batch.m_removed.end(), e.id);
+                    if (put != batch.m_put.end() && put->first == e.id) {
+                        retired.figures.push_back(e.figure);
+                        if (!removed) {
+                            next->entries.push_back({e.id, put->second.release()});
+                        }
+                        ++put;
+                    }
+                    else if (removed) {
+                        retired.figures.push_back(e.figure);
+                    }
+                    else {
+                        next->entries.push_back(e);
+                    }
+                }
+                for (; put != batch.m_put.end(); ++put) {
+                    if (!std::binary_search(batch.m_removed.begin(), batch.m_removed.end(), put->first)) {
+                        next->entries.push_back({put->first, put->second.release()});
+                    }
+                }
+                batch.m_put.clear();
+                batch.m_removed.clear();
+
+                m_current.store(next);
+                retired.epoch = m_epoch.fetch_add(1);
+                m_retired.push_back(std::move(retired));
+                reclaim();
+                return next->number;
+            }
+
+            /**
+             * \brief Returns the number of retired versions that are not freed yet.
+             *
+             * \return Versions still pinned by readers.
+             */
+            std::size_t pending() {
+                std::lock_guard<std::mutex> lock(m_writer);
+                reclaim();
+                return m_retired.size();
+            }
+
+        private:
+            /**
+             * \brief Finds a figure by id in a version.
+             */
+            static const Figure *find(const Version &v, std::uint64_t id) {
+                auto it = std::lower_bound(v.entries.begin(), v.entries.end(), id, [](const Entry &e, std::uint64_t key) {
+                    return e.id < key;
+                });
+                return it != v.entries.end() && it->id == id ? it->figure : nullptr;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -10,9 +10,19 @@ namespace mw{
  * This class models a square as a special case of a rectangle where all
  * sides are equal. It inherits from the Rectangle class and enforces the
  * constraint that side A and side B have the same length.
+ *
+ * \tparam Coord Coordinate type of the center point and corners.
+ * \tparam Scalar Type of the side length and computed values.
  */
-    class Square : public Rectangle {
+    template <typename Coord, typename Scalar>
+    class BasicSquare : public BasicRectangle<Coord, Scalar> {
         public:
+            /**
+             * \brief Makes the precision overloads of area() and perimeter() visible.
+             */
+            using BasicRectangle<Coord, Scalar>::area;
+            using BasicRectangle<Coord, Scalar>::perimeter;
+
             /**
              * \brief Represents a square.
              *
@@ -20,7 +30,7 @@ namespace mw{
              * sides are equal. It inherits from the Rectangle class and enforces the
              * constraint that side A and side B have the same length.
              */
-            Square(double a, const Point &p) : Rectangle(a, a, p, "Square") {}
+            BasicSquare(Scalar a, const BasicPoint<Coord> &p) : BasicRectangle<Coord, Scalar>(a, a, p, "Square") {}
 
             /**
              * \brief Creates a square from four corner points.
@@ -32,8 +42,8 @@ namespace mw{
              *
              * \throws const char* If the points do not form a square.
              */
-            Square(const std::array<Point, 4> corners) : Rectangle(corners, "Squere") {
-                if(abs(getA() - getB()) > 0.000001){
+            BasicSquare(const std::array<BasicPoint<Coord>, 4>& corners) : BasicRectangle<Coord, Scalar>(corners, "Squere") {
+                if(std::abs(this->getA() - this->getB()) > Scalar(0.000001)){
                     throw "This is not a Square";
                 }  
             }
@@ -43,7 +53,7 @@ namespace mw{
              *
              * Default destructor for the Square class.
              */
-            ~Square() = default;
+            ~BasicSquare() = default;
 
             /**
              * \brief Calculates the area of the square.
@@ -52,8 +62,8 @@ namespace mw{
              *
              * \return The area of the square.
              */
-            double area() const override{
-                return getA() * getA();
+            Scalar area() const override{
+                return this->getA() * this->getA();
             }
 
             /**
@@ -63,9 +73,28 @@ namespace mw{
              *
              * \return The perimeter of the square.
              */
-            double perimeter() const override{
-                return 4 * getA();
+            Scalar perimeter() const override{
+                return 4 * this->getA();
+            }
+
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return ShapeType::Square.
+             */
+            ShapeType type() const override{
+                return ShapeType::Square;
             }
 
     };
+
+/**
+ * \brief Square with integer corners and double side, the default used across the library.
+ */
+    using Square = BasicSquare<int, double>;
+
+/**
+ * \brief Square with float corners and side for bulk work.
+ */
+    using SquareF = BasicSquare<float, float>;
 } //namespace mw
\ No newline at end of file
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "Parallel.hpp"
+#include "Workload.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+
+namespace mw{
+
+/**
+ * \brief Limits of a streaming run.
+ */
+    struct StreamConfig {
+        /**
+         * \brief Number of figures per block.
+         */
+        std::size_t blockShapes = 1 << 16;
+
+        /**
+         * \brief Largest amount of memory for block buffers, in bytes; at least two blocks.
+         */
+        std::size_t memoryBytes = 64 << 20;
+
+        /**
+         * \brief Number of compute threads besides the reader, 0 means one per hardware thread.
+         */
+        unsigned threads = 0;
+    };
+
+/**
+ * \brief Merged results and throughput of a streaming run.
+ */
+    struct StreamReport {
+        /**
+         * \brief Number of figures read.
+         */
+        std::uint64_t shapes = 0;
+
+        /**
+         * \brief Number of figures the constructors accepted.
+         */
+        std::uint64_t valid = 0;
+
+        /**
+         * \brief Number of figures the constructors rejected.
+         */
+        std::uint64_t invalid = 0;
+
+        /**
+         * \brief Number of valid figures of every type, indexed by ShapeType.
+         */
+        std::array<std::uint64_t, 5> types {};
+
+        /**
+         * \brief Total area of the valid figures.
+         */
+        double area = 0;
+
+        /**
+         * \brief Total perimeter of the valid figures.
+         */
+        double perimeter = 0;
+
+        /**
+         * \brief Number of blocks.
+         */
+        std::uint64_t blocks = 0;
+
+        /**
+         * \brief Bytes read from the file.
+         */
+        std::uint64_t bytes = 0;
+
+        /**
+         * \brief Memory used by block buffers, in bytes.
+         */
+        std::size_t bufferBytes = 0;
+
+        /**
+         * \brief Wall-clock time of the run.
+         */
+        double seconds = 0;
+
+        /**
+         * \brief Figures processed per second.
+         */
+        double shapesPerSecond = 0;
+
+        /**
+         * \brief Megabytes (10^6 bytes) read per second.
+         */
+        double megabytesPerSecond = 0;
+    };
+
+/**
+ * \brief Processes workload files larger than memory in fixed-size blocks.
+ *
+ * A reader thread reads blocks of ShapeSpec records into a ring of buffers
+ * while compute threads process the blocks read before, so reading overlaps
+ * with computing. The ring holds as many blocks as fit into the memory
+ * budget; the reader waits for a free buffer and the compute threads for a
+ * full one, so memory use never grows with the file.
+ *
+ * Every figure is validated by running its constructor on a figure on the
+ * stack, then measured; every block yields counts and compensated sums that
+ * are merged in block order, so the results do not depend on the number of
+ * threads. A processed block keeps its buffer until all blocks before it are
+ * merged, so there is one partial result per ring buffer, not per block.
+ */
+    class StreamProcessor {
+        private:
+            /**
+             * \brief Sum of doubles with a running compensation of the rounding error.
+             */
+            struct Sum {
+                double sum = 0;
+                double compensation = 0;
+
+                void add(double x) {
+                    double t = sum + x;
+                    if (std::abs(sum) >= std::abs(x)) {
+                        compensation += (sum - t) + x;
+                    }
+                    else {
+                        compensation += (x - t) + sum;
+                    }
+                    sum = t;
+                }
+
+                double value() const {
+                    return sum + compensation;
+                }
+            };
+
+            /**
+             * \brief Results of one block.
+             */
+            struct Partial {
+                std::uint64_t valid = 0;
+                std::uint64_t invalid = 0;
+                std::array<std::uint64_t, 5> types {};
+                Sum area;
+                Sum perimeter;
+
+                /**
+                 * \brief Adds the results of a later block.
+                 */
+                void merge(const Partial &p) {
+                    valid += p.valid;
+                    invalid += p.invalid;
+                    for (std::size_t t = 0; t < types.size(); ++t) {
+                        types[t] += p.types[t];
+                    }
+                    area.add(p.area.sum);
+                    area.add(p.area.compensation);
+                    perimeter.add(p.perimeter.sum);
+                    perimeter.add(p.perimeter.compensation);
+                }
+            };
+
+            /**
+             * \brief State of a ring buffer.
+             */
+            enum class State {
+                Empty,
+                Full,
+                Processing,
+                Processed
+            };
+
+            /**
+             * \brief Processes one block.
+             */
+            static void process(const ShapeSpec *specs, std::size_t n, Partial &p) {
+                double area, perimeter;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (measure(specs[i], area, perimeter)) {
+                        ++p.valid;
+                        ++p.types[static_cast<int>(specs[i].type)];
+                        p.area.add(area);
+                        p.perimeter.add(perimeter);
+                    }
+                    else {
+                        ++p.invalid;
+                    }
+                }
+            }
+
+        public:
+            /**
+             * \brief Validates and measures one figure without allocating it on the heap.
+             *
+             * \param s Constructor arguments.
+             * \param area Receives the area of a valid figure.
+             * \param perimeter Receives the perimeter of a valid figure.
+             * \return True if the constructor accepted the arguments.
+             */
+            static bool measure(const ShapeSpec &s, double &area, double &perimeter) {
+                auto point = [&](int k) {
+                    return Point(s.corner[2 * k], s.corner[2 * k + 1]);
+                };
+                try {
+                    switch (s.type) {
+                        case ShapeType::Circle: {
+                            Circle f(s.size, point(0));
+                            area = f.area();
+                            perimeter = f.perimeter();
+                            return true;
+                        }
+                        case ShapeType::Triangle: {
+                            Triangle f({point(0), point(1), point(2)});
+                            area = f.area();
+                            perimeter = f.perimeter();
+                            return true;
+                        }
+                        case ShapeType::Rectangle: {
+                            Rectangle f(std::array<Point, 4> {point(0), point(1), point(2), point(3)});
+                            area = f.area();
+                            perimeter = f.perimeter();
+                            return true;
+                        }
+                        case ShapeType::Square: {
+                            Square f(std::array<Point, 4> {point(0), point(1), point(2), point(3)});
+                            area = f.area();
+                            perimeter = f.perimeter();
+                            return true;
+                        }
+                        case ShapeType::Rhombus: {
+                            Rhombus f(s.size, s.angle, point(0));
+                            area = f.area();
+                            perimeter = f.perimeter();
+                            return true;
+                        }
+                    }
+                }
+                catch (const char*) {
+                }
+                return false;
+            }
+
+            /**
+             * \brief Streams a whole workload file.
+             *
+             * \param file File to process.
+             * \param config Block size, memory budget and threads.
+             * \return Merged results and throughput.
+             *
+             * \throws const char* If the memory budget holds fewer than two blocks or reading fails.
+             */
+            static StreamReport run(const WorkloadFile &file, const StreamConfig &config = StreamConfig {}) {
+                const auto start = std::chrono::steady_clock::now();
+                const std::size_t blockShapes = std::max<std::size_t>(config.blockShapes, 1);
+                const std::size_t blockBytes = blockShapes * sizeof(ShapeSpec);
+                if (config.memoryBytes / blockBytes < 2) {
+                    throw "Memory budget must hold at least two blocks";
+                }
+                const std::uint64_t blocks = (file.size() + blockShapes - 1) / blockShapes;
+                const std::size_t slots = static_cast<std::size_t>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(config.memoryBytes / blockBytes, blocks)));
+
+                std::vector<std::vector<ShapeSpec>> buffer(slots, std::vector<ShapeSpec>(blockShapes));
+                std::vector<State> state(slots, State::Empty);
+                std::vector<std::size_t> filled(slots, 0);
+                std::vector<Partial> partial(slots);
+                Partial total;
+                std::mutex mutex;
+                std::condition_variable changed;
+                std::uint64_t nextBlock = 0;
+                std::uint64_t nextMerge = 0;
+                bool failed = false;
+                std::exception_ptr error;
+
+                auto fail = [&](std::exception_ptr e) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failed) {
+                        failed = true;
+                        error = e;
+                    }
+                    changed.notify_all();
+                };
+
+                posix_fadvise(file.descriptor(), 0, 0, POSIX_FADV_SEQUENTIAL);
+                std::thread reader([&]() {
+                    try {
+                        for (std::uint64_t b = 0; b < blocks; ++b) {
+                            const std::size_t slot = b % slots;
+                            {
+                                std::unique_lock<std::mutex> lock(mutex);
+                                changed.wait(lock, [&]() { return failed || state[slot] == State::Empty; });
+                                if (failed) {
+                                    return;
+                                }
+                            }
+                            std::size_t n = file.read(b * blockShapes, buffer[slot].data(), blockShapes);
+                            std::lock_guard<std::mutex> lock(mutex);
+                            filled[slot] = n;
+                            state[slot] = State::Full;
+                            changed.notify_all();
+                        }
+                    }
+                    catch (...) {
+                        fail(std::current_exception());
+                    }
+                });
+
+                const unsigned workers = threadCount(config.threads);
+                std::vector<std::thread> pool;
+                for (unsigned w = 0; w < workers; ++w) {
+                    pool.emplace_back([&]() {
+                        try {
+                            for (;;) {
+                                std::uint64_t b;
+                                std::size_t slot;
+                                {
+                                    std::unique_lock<std::mutex> lock(mutex);
+                                    changed.wait(lock, [&]() {
+                                        return failed || nextBlock >= blocks || state[nextBlock % slots] == State::Full;
+                                    });
+                                    if (failed || nextBlock >= blocks) {
+                                        return;
+                                    }
+                                    b = nextBlock++;
+                                    slot = b % slots;
+                                    state[slot] = State::Processing;
+                                }
+                                process(buffer[slot].data(), filled[slot], partial[slot]);
+                                std::lock_guard<std::mutex> lock(mutex);
+                                state[slot] = State::Processed;
+                                // Merge every block whose predecessors are merged and hand its buffer back
+                                while (nextMerge < blocks && state[nextMerge % slots] == State::Processed) {
+                                    const std::size_t done = nextMerge++ % slots;
+                                    total.merge(partial[done]);
+                                    partial[done] = Partial {};
+                                    state[done] = State::Empty;
+                                }
+                                changed.notify_all();
+                            }
+                        }
+                        catch (...) {
+                            fail(std::current_exception());
+                        }
+                    });
+                }
+                reader.join();
+                for (std::thread &t : pool) {
+                    t.join();
+                }
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+
+                StreamReport report;
+                report.valid = total.valid;
+                report.invalid = total.invalid;
+                report.types = total.types;
+                report.shapes = file.size();
+                report.area = total.area.value();
+                report.perimeter = total.perimeter.value();
+                report.blocks = blocks;
+                report.bytes = file.size() * sizeof(ShapeSpec);
+                report.bufferBytes = slots * blockBytes;
+                report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                report.shapesPerSecond = report.shapes / std::max(report.seconds, 1e-9);
+                report.megabytesPerSecond = report.bytes / 1e6 / std::max(report.seconds, 1e-9);
+                return report;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cmath>
 #include "Figure.hpp"
 
 namespace mw{
@@ -11,8 +12,12 @@ namespace mw{
  * This class models a triangle defined by three corner points. It provides
  * methods to compute the triangle's area and perimeter, as well as access
  * to its vertices.
+ *
+ * \tparam Coord Coordinate type of the corners.
+ * \tparam Scalar Type of computed values.
  */
-    class Triangle : public Figure{
+    template <typename Coord, typename Scalar>
+    class BasicTriangle : public BasicFigure<Coord, Scalar>{
         private:
             /**
              * \brief Represents a triangle.
@@ -21,9 +26,15 @@ namespace mw{
              * methods to compute the triangle's area and perimeter, as well as access
              * to its vertices.
              */
-            std::array<Point, 3> m_corner {};
+            std::array<BasicPoint<Coord>, 3> m_corner {};
 
         public:
+            /**
+             * \brief Makes the precision overloads of area() and perimeter() visible.
+             */
+            using BasicFigure<Coord, Scalar>::area;
+            using BasicFigure<Coord, Scalar>::perimeter;
+
             /**
              * \brief Creates a triangle from three corner points.
              *
@@ -34,7 +45,7 @@ namespace mw{
              *
              * \throws const char* If the points are collinear.
              */
-            Triangle(const std::array<Point, 3>& corners) : m_corner(corners), Figure(corners[0], "Triangle"){
+            BasicTriangle(const std::array<BasicPoint<Coord>, 3>& corners) : m_corner(corners), BasicFigure<Coord, Scalar>(corners[0], "Triangle"){
                 setCorners(corners);
             }
 
@@ -43,14 +54,14 @@ namespace mw{
              *
              * Creates a triangle with default-initialized values.
              */
-            Triangle() = default;
+            BasicTriangle() = default;
 
             /**
              * \brief Destructor.
              *
              * Default destructor for the Triangle class.
              */
-            ~Triangle() = default;
+            ~BasicTriangle() = default;
 
             /**
              * \brief Sets the corner points of the triangle.
@@ -62,7 +73,7 @@ namespace mw{
              *
              * \throws const char* If the points are collinear.
              */
-            void setCorners(const std::array<Point, 3>& corners){
+            void setCorners(const std::array<BasicPoint<Coord>, 3>& corners){
                 if (((m_corner[0].getX() == m_corner[1].getX()) && (m_corner[1].getX() == m_corner[2].getX()))
                 || ((m_corner[0].getY() == m_corner[1].getY()) && (m_corner[1].getY() == m_corner[2].getY()))){
                     throw "Point cannot be in one line";
@@ -75,7 +86,7 @@ namespace mw{
              *
              * \return Constant reference to the array of corner points.
              */
-            const std::array<Point, 3>& getCorners() const {
+            const std::array<BasicPoint<Coord>, 3>& getCorners() const {
                 return m_corner;
             }
 
@@ -86,7 +97,7 @@ namespace mw{
              *
              * \return Reference to the array of corner points.
              */
-            std::array<Point, 3>& getCorners(){
+            std::array<BasicPoint<Coord>, 3>& getCorners(){
                 return m_corner;
             }
 
@@ -97,12 +108,12 @@ namespace mw{
              *
              * \return The area of the triangle.
              */
-            double area() const override
+            Scalar area() const override
             {
-                return (0.5) * abs((m_corner[1].getX() - m_corner[0].getX()) * 
-                (m_corner[2].getY() - m_corner[0].getY()) -
-                (m_corner[1].getY() - m_corner[0].getY()) *
-                (m_corner[2].getX() - m_corner[0].getX()));
+                return Scalar(0.5) * std::abs(Scalar(m_corner[1].getX() - m_corner[0].getX()) *
+                Scalar(m_corner[2].getY() - m_corner[0].getY()) -
+                Scalar(m_corner[1].getY() - m_corner[0].getY()) *
+                Scalar(m_corner[2].getX() - m_corner[0].getX()));
             }
 
             /**
@@ -112,20 +123,75 @@ namespace mw{
              *
              * \return The perimeter of the triangle.
              */
-            double perimeter() const override
+            Scalar perimeter() const override
             {
-                double sideA = sqrt(((m_corner[1].getX() - m_corner[0].getX()) * (m_corner[1].getX() - m_corner[0].getX())) 
-                + ((m_corner[1].getY() - m_corner[0].getY()) * (m_corner[1].getY() - m_corner[0].getY())));
+                // Differences are converted before squaring, like in area(), so large coordinates do not overflow Coord
+                auto side = [](const BasicPoint<Coord> &a, const BasicPoint<Coord> &b) {
+                    Scalar dx = Scalar(b.getX() - a.getX());
+                    Scalar dy = Scalar(b.getY() - a.getY());
+                    return std::sqrt(dx * dx + dy * dy);
+                };
+                Scalar sideA = side(m_corner[0], m_corner[1]);
+                Scalar sideB = side(m_corner[1], m_corner[2]);
+                Scalar sideC = side(m_corner[2], m_corner[0]);
 
-                double sideB = sqrt(((m_corner[2].getX() - m_corner[1].getX()) * (m_corner[2].getX() - m_corner[1].getX())) 
-                + ((m_corner[2].getY() - m_corner[1].getY()) * (m_corner[2].getY() - m_corner[1].getY())));
+                return sideA + sideB + sideC;
+            }
 
-                double sideC = sqrt(((m_corner[0].getX() - m_corner[2].getX()) * (m_corner[0].getX() - m_corner[2].getX())) 
-                + ((m_corner[0].getY() - m_corner[2].getY()) * (m_corner[0].getY() - m_corner[2].getY())));
+            /**
+             * \brief Calculates the perimeter of the triangle with a selected precision.
+             *
+             * The fast path replaces the three square roots by FastMath::sqrt,
+             * so the relative error is below FastMath::sqrtError.
+             *
+             * \param precision Exact or fast approximate computation.
+             * \return The perimeter of the triangle.
+             */
+            Scalar perimeter(Precision precision) const override
+            {
+                if (precision == Precision::Exact) {
+                    return perimeter();
+                }
+                auto side = [](const BasicPoint<Coord> &a, const BasicPoint<Coord> &b) {
+                    double dx = double(b.getX()) - double(a.getX());
+                    double dy = double(b.getY()) - double(a.getY());
+                    return FastMath::sqrt(dx * dx + dy * dy);
+                };
+                return Scalar(side(m_corner[0], m_corner[1]) + side(m_corner[1], m_corner[2]) + side(m_corner[2], m_corner[0]));
+            }
 
-                return sideA + sideB + sideC;
+            /**
+             * \brief Returns the type of the figure.
+             *
+             * \return ShapeType::Triangle.
+             */
+            ShapeType type() const override{
+                return ShapeType::Triangle;
+            }
+
+            /**
+             * \brief Returns the outline of the triangle.
+             *
+             * \return Polygon outline built from the three corners.
+             */
+            Outline outline() const override{
+                std::array<Vec2, 4> v {};
+                for (int i = 0; i < 3; ++i) {
+                    v[i] = {double(m_corner[i].getX()), double(m_corner[i].getY())};
+                }
+                return Outline::polygon(v, 3);
             }
 
     };
 
+/**
+ * \brief Triangle with integer corners and double values, the default used across the library.
+ */
+    using Triangle = BasicTriangle<int, double>;
+
+/**
+ * \brief Triangle with float corners and values for bulk work.
+ */
+    using TriangleF = BasicTriangle<float, float>;
+
 } //namespace mw
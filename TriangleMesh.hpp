@@ -0,0 +1,304 @@
+#pragma once
+
+#include "Parallel.hpp"
+#include "Point.hpp"
+#include "Triangle.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mw{
+
+/**
+ * \brief Represents a set of triangles sharing their vertices.
+ *
+ * Vertices are stored once in a vertex buffer and every triangle is three
+ * indices into it, so a triangle costs 12 bytes instead of a whole Triangle
+ * object with its own corners, center and name. Batch functions convert the
+ * vertex buffer once to contiguous coordinate arrays and then process all
+ * triangles in parallel.
+ */
+    class TriangleMesh {
+        private:
+            /**
+             * \brief Shared vertices.
+             */
+            std::vector<Point> m_vertex;
+
+            /**
+             * \brief Vertex indices of every triangle.
+             */
+            std::vector<std::array<std::uint32_t, 3>> m_index;
+
+            /**
+             * \brief Returns twice the signed area of the triangle a, b, c.
+             */
+            static std::int64_t cross(const Point &a, const Point &b, const Point &c) {
+                return std::int64_t(b.getX() - a.getX()) * (c.getY() - a.getY())
+                     - std::int64_t(b.getY() - a.getY()) * (c.getX() - a.getX());
+            }
+
+            /**
+             * \brief Vertex coordinates converted to double, one array per axis.
+             */
+            void coordinates(std::vector<double> &x, std::vector<double> &y) const {
+                x.resize(m_vertex.size());
+                y.resize(m_vertex.size());
+                for (std::size_t i = 0; i < m_vertex.size(); ++i) {
+                    x[i] = m_vertex[i].getX();
+                    y[i] = m_vertex[i].getY();
+                }
+            }
+
+        public:
+            /**
+             * \brief Creates an empty mesh.
+             */
+            TriangleMesh() = default;
+
+            /**
+             * \brief Creates a mesh from vertex and index buffers.
+             *
+             * \param vertices Shared vertices.
+             * \param triangles Vertex indices of every triangle.
+             *
+             * \throws const char* If an index is out of range or a triangle is degenerate.
+             */
+            TriangleMesh(std::vector<Point> vertices, std::vector<std::array<std::uint32_t, 3>> triangles)
+                : m_vertex(std::move(vertices)) {
+                m_index.reserve(triangles.size());
+                for (const std::array<std::uint32_t, 3> &t : triangles) {
+                    addTriangle(t[0], t[1], t[2]);
+                }
+            }
+
+            /**
+             * \brief Creates a mesh from separate triangles.
+             *
+             * Equal corners of different triangles are merged into one vertex.
+             *
+             * \param triangles Triangles to convert.
+             * \return Mesh holding the same triangles.
+             */
+            static TriangleMesh fromTriangles(const std::vector<Triangle> &triangles) {
+                TriangleMesh mesh;
+                std::unordered_map<Point, std::uint32_t> lookup;
+                mesh.m_index.reserve(triangles.size());
+                for (const Triangle &t : triangles) {
+                    std::array<std::uint32_t, 3> index;
+                    for (int i = 0; i < 3; ++i) {
+                        auto found = lookup.emplace(t.getCorners()[i], static_cast<std::uint32_t>(mesh.m_vertex.size()));
+                        if (found.second) {
+                            mesh.m_vertex.push_back(t.getCorners()[i]);
+                        }
+                        index[i] = found.first->second;
+                    }
+                    mesh.m_index.push_back(index);
+                }
+                return mesh;
+            }
+
+            /**
+             * \brief Adds a vertex.
+             *
+             * \param p Vertex to add.
+             * \return Index of the new vertex.
+             */
+            std::uint32_t addVertex(const Point &p) {
+                m_vertex.push_back(p);
+                return static_cast<std::uint32_t>(m_vertex.size() - 1);
+            }
+
+            /**
+             * \brief Adds a triangle over existing vertices.
+             *
+             * \param a Index of the first corner.
+             * \param b Index of the second corner.
+             * \param c Index of the third corner.
+             * \return Index of the new triangle.
+             *
+             * \throws const char* If an index is out of range or the corners lie on one line.
+             */
+            std::size_t addTriangle(std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+                if (a >= m_vertex.size() || b >= m_vertex.size() || c >= m_vertex.size()) {
+                    throw "Vertex index out of range";
+                }
+                if (cross(m_vertex[a], m_vertex[b], m_vertex[c]) == 0) {
+                    throw "Point cannot be in one line";
+                }
+                m_index.push_back({a, b, c});
+                return m_index.size() - 1;
+            }
+
+            /**
+             * \brief Returns the number of triangles.
+             *
+             * \return Number of triangles.
+             */
+            std::size_t size() const {
+                return m_index.size();
+            }
+
+            /**
+             * \brief Returns the number of vertices.
+             *
+             * \return Number of vertices.
+             */
+            std::size_t vertexCount() const {
+                return m_vertex.size();
+            }
+
+            /**
+             * \brief Returns the shared vertices.
+             *
+             * \return Constant reference to the vertex buffer.
+             */
+            const std::vector<Point>& getVertices() const {
+                return m_vertex;
+            }
+
+            /**
+             * \brief Returns the vertex indices of all triangles.
+             *
+             * \return Constant reference to the index buffer.
+             */
+            const std::vector<std::array<std::uint32_t, 3>>& getIndices() const {
+                return m_index;
+            }
+
+            /**
+             * \brief Creates a standalone Triangle from one triangle of the mesh.
+             *
+             * \param i Index of the triangle.
+             * \return Triangle with copies of the corners.
+             */
+            Triangle toTriangle(std::size_t i) const {
+                const std::array<std::uint32_t, 3> &t = m_index[i];
+                return Triangle({m_vertex[t[0]], m_vertex[t[1]], m_vertex[t[2]]});
+            }
+
+            /**
+             * \brief Calculates the area of one triangle.
+             *
+             * \param i Index of the triangle.
+             * \return The area of the triangle.
+             */
+            double area(std::size_t i) const {
+                const std::array<std::uint32_t, 3> &t = m_index[i];
+                return 0.5 * std::abs(double(cross(m_vertex[t[0]], m_vertex[t[1]], m_vertex[t[2]])));
+            }
+
+            /**
+             * \brief Calculates the perimeter of one triangle.
+             *
+             * \param i Index of the triangle.
+             * \return The perimeter of the triangle.
+             */
+            double perimeter(std::size_t i) const {
+                const std::array<std::uint32_t, 3> &t = m_index[i];
+                double sum = 0;
+                for (int k = 0; k < 3; ++k) {
+                    const Point &a = m_vertex[t[k]];
+                    const Point &b = m_vertex[t[(k + 1) % 3]];
+                    double dx = b.getX() - a.getX();
+                    double dy = b.getY() - a.getY();
+                    sum += std::sqrt(dx * dx + dy * dy);
+                }
+                return sum;
+            }
+
+            /**
+             * \brief Calculates the areas of all triangles.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Area of every triangle, indexed like the triangles.
+             */
+            std::vector<double> areas(unsigned threads = 0) const {
+                std::vector<double> x, y, out(m_index.size());
+                coordinates(x, y);
+                parallelFor(m_index.size(), 16384, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const std::array<std::uint32_t, 3> &t = m_index[i];
+                        double x0 = x[t[0]], y0 = y[t[0]];
+                        out[i] = 0.5 * std::abs((x[t[1]] - x0) * (y[t[2]] - y0) - (y[t[1]] - y0) * (x[t[2]] - x0));
+                    }
+                }, threads);
+                return out;
+            }
+
+            /**
+             * \brief Calculates the perimeters of all triangles.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Perimeter of every triangle, indexed like the triangles.
+             */
+            std::vector<double> perimeters(unsigned threads = 0) const {
+                std::vector<double> x, y, out(m_index.size());
+                coordinates(x, y);
+                parallelFor(m_index.size(), 16384, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const std::array<std::uint32_t, 3> &t = m_index[i];
+                        double x0 = x[t[0]], y0 = y[t[0]];
+                        double x1 = x[t[1]], y1 = y[t[1]];
+                        double x2 = x[t[2]], y2 = y[t[2]];
+                        out[i] = std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0))
+                               + std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1))
+                               + std::sqrt((x0 - x2) * (x0 - x2) + (y0 - y2) * (y0 - y2));
+                    }
+                }, threads);
+                return out;
+            }
+
+            /**
+             * \brief Calculates the total area of all triangles.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Sum of the triangle areas.
+             */
+            double totalArea(unsigned threads = 0) const {
+                double total = 0;
+                for (double a : areas(threads)) {
+                    total += a;
+                }
+                return total;
+            }
+
+            /**
+             * \brief Finds the neighbors of every triangle.
+             *
+             * Edge k of a triangle runs from its corner k to corner (k + 1) % 3.
+             * Two triangles are neighbors if they share an edge.
+             *
+             * \return For every triangle and edge, the index of the triangle on the other side or -1.
+             */
+            std::vector<std::array<std::int64_t, 3>> adjacency() const {
+                std::vector<std::array<std::int64_t, 3>> out(m_index.size(), {-1, -1, -1});
+                std::unordered_map<std::uint64_t, std::uint64_t> open;
+                open.reserve(m_index.size() * 2);
+
+                for (std::size_t i = 0; i < m_index.size(); ++i) {
+                    for (int k = 0; k < 3; ++k) {
+                        std::uint32_t a = m_index[i][k];
+                        std::uint32_t b = m_index[i][(k + 1) % 3];
+                        std::uint64_t key = (std::uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+                        std::uint64_t mine = std::uint64_t(i) * 3 + k;
+
+                        auto found = open.find(key);
+                        if (found == open.end()) {
+                            open.emplace(key, mine);
+                        }
+                        else {
+                            std::uint64_t other = found->second;
+                            out[i][k] = static_cast<std::int64_t>(other / 3);
+                            out[other / 3][other % 3] = static_cast<std::int64_t>(i);
+                            open.erase(found);
+                        }
+                    }
+                }
+                return out;
+            }
+    };
+
+} // namespace mw
\ No newline at end of file
@@ -0,0 +1,677 @@
+#pragma once
+
+#include "Circle.hpp"
+#include "Figure.hpp"
+#include "Parallel.hpp"
+#include "Rectangle.hpp"
+#include "Rhombus.hpp"
+#include "Square.hpp"
+#include "Triangle.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mw{
+
+/**
+ * \brief Spatial distribution of generated figure centers.
+ */
+    enum class Distribution {
+        /**
+         * \brief Uniform over the whole world.
+         */
+        Uniform,
+
+        /**
+         * \brief Normally distributed around a few cluster centers.
+         */
+        Clustered,
+
+        /**
+         * \brief Cells of a 64 x 64 grid chosen with Zipf-distributed popularity, uniform inside a cell.
+         */
+        Zipf
+    };
+
+/**
+ * \brief Parameters of a synthetic scene.
+ */
+    struct WorkloadConfig {
+        /**
+         * \brief Seed; the same seed and parameters give the same scene.
+         */
+        std::uint64_t seed = 1;
+
+        /**
+         * \brief Number of figures.
+         */
+        std::uint64_t count = 1000000;
+
+        /**
+         * \brief Relative frequency of every type, indexed by ShapeType.
+         */
+        std::array<double, 5> mix {1, 1, 1, 1, 1};
+
+        /**
+         * \brief Distribution of the centers.
+         */
+        Distribution distribution = Distribution::Uniform;
+
+        /**
+         * \brief Width of the world; coordinates lie in [0, width].
+         */
+        int width = 1 << 20;
+
+        /**
+         * \brief Height of the world; coordinates lie in [0, height].
+         */
+        int height = 1 << 20;
+
+        /**
+         * \brief Expected number of figures covering a point, which sets the average figure size.
+         */
+        double overlap = 1;
+
+        /**
+         * \brief Share of figures, from 0 to 1, generated so that their constructor rejects them.
+         */
+        double invalidShare = 0;
+
+        /**
+         * \brief Number of clusters for Distribution::Clustered.
+         */
+        unsigned clusters = 16;
+
+        /**
+         * \brief Standard deviation of a cluster as a share of the world size.
+         */
+        double spread = 0.02;
+
+        /**
+         * \brief Exponent of the Zipf distribution; larger values concentrate figures in fewer cells.
+         */
+        double zipfExponent = 1;
+    };
+
+/**
+ * \brief Constructor arguments of one generated figure, 44 bytes without pointers or padding.
+ *
+ * Triangles, rectangles and squares are given by their corners and built
+ * with the corner constructors; circles by center and radius; rhombi by
+ * center, side and angle, so the angle is drawn directly and the side is
+ * stretched to keep the area in the scene's size distribution.
+ */
+    struct ShapeSpec {
+        /**
+         * \brief Type of the figure.
+         */
+        ShapeType type;
+
+        /**
+         * \brief Angle of a rhombus in degrees.
+         */
+        std::int16_t angle;
+
+        /**
+         * \brief 1 if the constructor accepts the arguments, 0 if they were made to be rejected.
+         */
+        std::uint8_t valid;
+
+        /**
+         * \brief Zero, fills the record so it has no padding.
+         */
+        std::uint8_t reserved;
+
+        /**
+         * \brief Radius of a circle or side of a rhombus.
+         */
+        std::int32_t size;
+
+        /**
+         * \brief Corners as x0, y0, x1, y1, ...; the center of circles and rhombi is corner 0.
+         */
+        std::array<std::int32_t, 8> corner;
+    };
+
+/**
+ * \brief Seeded generator of large synthetic scenes.
+ *
+ * Every figure is computed from the seed and its index alone with a
+ * counter-based random generator, so any range of a scene can be produced
+ * independently, in any order and on any number of threads, and the result
+ * is always the same. The average figure size is chosen so that the total
+ * figure area is about overlap times the world area, up to 4096 units.
+ *
+ * Invalid figures break exactly the rule their constructor checks: circles
+ * get a negative radius, triangles three corners on one horizontal or
+ * vertical line, rectangles the corners of a slanted parallelogram, squares
+ * the corners of a rectangle with unequal sides, and rhombi an angle of 90
+ * degrees or more.
+ *
+ * Scenes go to memory as figures or specs, or to a file of fixed-size
+ * ShapeSpec records that WorkloadFile reads back in any range.
+ */
+    class WorkloadGenerator {
+        private:
+            /**
+             * \brief Number of cells on each side of the Zipf grid.
+             */
+            static constexpr int zipfGrid = 64;
+
+            /**
+             * \brief Largest average figure size.
+             */
+            static constexpr double maxSize = 4096;
+
+            /**
+             * \brief Random numbers for one figure: SplitMix64 seeded from the seed and the index.
+             */
+            struct Random {
+                std::uint64_t state;
+
+                std::uint64_t next() {
+                    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    return z ^ (z >> 31);
+                }
+
+                double uniform() {
+                    return (next() >> 11) * 0x1.0p-53;
+                }
+
+                int between(int low, int high) {
+                    return low + static_cast<int>(uniform() * (high - low + 1));
+                }
+
+                double normal() {
+                    double u = 1 - uniform(), v = uniform();
+                    return std::sqrt(-2 * std::log(u)) * std::cos(2 * M_PI * v);
+                }
+            };
+
+            /**
+             * \brief Scene parameters.
+             */
+            WorkloadConfig m_config;
+
+            /**
+             * \brief Cumulative type frequencies.
+             */
+            std::array<double, 5> m_mix;
+
+            /**
+             * \brief Side of a square with the average figure area.
+             */
+            double m_size;
+
+            /**
+             * \brief Cluster centers.
+             */
+            std::vector<std::array<double, 2>> m_cluster;
+
+            /**
+             * \brief Cumulative Zipf probabilities of the cell ranks.
+             */
+            std::vector<double> m_zipf;
+
+            /**
+             * \brief Grid cell of every Zipf rank.
+             */
+            std::vector<int> m_cell;
+
+            /**
+             * \brief Returns a center according to the distribution.
+             */
+            std::array<double, 2> center(Random &r) const {
+                const double w = m_config.width, h = m_config.height;
+                switch (m_config.distribution) {
+                    case Distribution::Uniform:
+                        return {r.uniform() * w, r.uniform() * h};
+                    case Distribution::Clustered: {
+                        const std::array<double, 2> &c = m_cluster[r.next() % m_cluster.size()];
+                        double x = c[0] + r.normal() * m_config.spread * w, y = c[1] + r.normal() * m_config.spread * h;
+                        return {std::min(w, std::max(0.0, x)), std::min(h, std::max(0.0, y))};
+                    }
+                    case Distribution::Zipf: {
+                        int rank = static_cast<int>(std::upper_bound(m_zipf.begin(), m_zipf.end() - 1, r.uniform()) - m_zipf.begin());
+                        int cell = m_cell[rank];
+                        return {(cell % zipfGrid + r.uniform()) * w / zipfGrid, (cell / zipfGrid + r.uniform()) * h / zipfGrid};
+                    }
+                }
+                return {0, 0};
+            }
+
+            /**
+             * \brief Shifts corners so that none is negative or beyond the world, if the figure fits.
+             */
+            void place(ShapeSpec &s, int corners) const {
+                int minX = s.corner[0], minY = s.corner[1], maxX = minX, maxY = minY;
+                for (int k = 1; k < corners; ++k) {
+                    minX = std::min(minX, s.corner[2 * k]);
+                    maxX = std::max(maxX, s.corner[2 * k]);
+                    minY = std::min(minY, s.corner[2 * k + 1]);
+                    maxY = std::max(maxY, s.corner[2 * k + 1]);
+                }
+                // Staying non-negative matters more than staying inside, as Point rejects negative coordinates
+                int dx = std::max(-minX, std::min(0, m_config.width - maxX));
+                int dy = std::max(-minY, std::min(0, m_config.height - maxY));
+                for (int k = 0; k < corners; ++k) {
+                    s.corner[2 * k] += dx;
+                    s.corner[2 * k + 1] += dy;
+                }
+            }
+
+        public:
+            /**
+             * \brief Prepares a generator.
+             *
+             * \param config Scene parameters.
+             *
+             * \throws const char* If the parameters are out of range.
+             */
+            explicit WorkloadGenerator(const WorkloadConfig &config) : m_config(config) {
+                double total = 0;
+                for (std::size_t t = 0; t < m_mix.size(); ++t) {
+                    if (config.mix[t] < 0) {
+                        throw "Type frequencies cannot be negative";
+                    }
+                    total += config.mix[t];
+                    m_mix[t] = total;
+                }
+                if (total <= 0) {
+                    throw "At least one type must have a frequency";
+                }
+                for (double &m : m_mix) {
+                    m /= total;
+                }
+                if (config.width <= 0 || config.height <= 0 || config.overlap <= 0
+                    || config.invalidShare < 0 || config.invalidShare > 1 || config.clusters == 0) {
+                    throw "Invalid workload parameters";
+                }
+                m_size = std::sqrt(config.overlap * double(config.width) * config.height / std::max<std::uint64_t>(config.count, 1));
+                // Beyond a few thousand units the tolerances of the corner checks no longer hold
+                m_size = std::max(2.0, std::min({m_size, std::min(config.width, config.height) / 4.0, maxSize}));
+
+                Random r {config.seed ^ 0x5bd1e995c0ffeeULL};
+                for (unsigned c = 0; c < config.clusters; ++c) {
+                    m_cluster.push_back({r.uniform() * config.width, r.uniform() * config.height});
+                }
+                double sum = 0;
+                for (int k = 1; k <= zipfGrid * zipfGrid; ++k) {
+                    sum += 1 / std::pow(k, config.zipfExponent);
+                    m_zipf.push_back(sum);
+                    m_cell.push_back(k - 1);
+                }
+                for (double &z : m_zipf) {
+                    z /= sum;
+                }
+                for (std::size_t k = m_cell.size(); k > 1; --k) {
+                    std::swap(m_cell[k - 1], m_cell[r.next() % k]);
+                }
+            }
+
+            /**
+             * \brief Returns the parameters.
+             *
+             * \return Scene parameters.
+             */
+            const WorkloadConfig &config() const {
+                return m_config;
+            }
+
+            /**
+             * \brief Computes one figure of the scene.
+             *
+             * \param index Index of the figure, from 0 to count - 1.
+             * \return Constructor arguments of the figure.
+             */
+            ShapeSpec spec(std::uint64_t index) const {
+                Random r {m_config.seed * 0x9e3779b97f4a7c15ULL + index * 0xd1b54a32d192ed03ULL};
+                r.next();
+                ShapeSpec s {};
+                double pick = r.uniform();
+                int type = 0;
+                while (type < 4 && pick >= m_mix[type]) {
+                    ++type;
+                }
+                s.type = static_cast<ShapeType>(type);
+                s.valid = r.uniform() >= m_config.invalidShare;
+
+                std::array<double, 2> c = center(r);
+                const int cx = static_cast<int>(c[0]), cy = static_cast<int>(c[1]);
+                const double size = m_size * (0.5 + r.uniform());
+                switch (s.type) {
+                    case ShapeType::Circle: {
+                        int radius = std::max(1, static_cast<int>(std::lround(size / std::sqrt(M_PI))));
+                        s.size = s.valid ? radius : -radius;
+                        s.corner[0] = std::max(radius, std::min(cx, m_config.width - radius));
+                        s.corner[1] = std::max(radius, std::min(cy, m_config.height - radius));
+                        s.corner[0] = std::max(0, s.corner[0]);
+                        s.corner[1] = std::max(0, s.corner[1]);
+                        break;
+                    }
+                    case ShapeType::Triangle: {
+                        int a = std::max(1, static_cast<int>(size * (0.5 + r.uniform())));
+                        int b = std::max(1, static_cast<int>(size * (0.5 + r.uniform())));
+                        s.corner = {cx, cy, cx + a, cy, cx, cy + b, 0, 0};
+                        if (s.valid) {
+                            // Offsets below half the legs keep the corners off one line
+                            s.corner[3] += static_cast<int>(r.uniform() * a / 2);
+                            s.corner[4] += static_cast<int>(r.uniform() * b / 2);
+                        }
+                        else {
+                            s.corner[4] = cx + 2 * a;
+                            s.corner[5] = cy;
+                        }
+                        place(s, 3);
+                        break;
+                    }
+                    case ShapeType::Rectangle:
+                    case ShapeType::Square: {
+                        // Integer direction vectors of integer length keep the corners exact when rotated
+                        static const int direction[6][3] = {{1, 0, 1}, {0, 1, 1}, {3, 4, 5}, {4, 3, 5}, {5, 12, 13}, {12, 5, 13}};
+                        const int *d = direction[r.next() % 6];
+                        if (size < 2 * d[2]) {
+                            d = direction[0];
+                        }
+                        int a = std::max(1, static_cast<int>(std::lround(size / d[2])));
+                        int b = s.type == ShapeType::Square ? a : std::max(1, static_cast<int>(std::lround(a * (0.5 + r.uniform()))));
+                        if (!s.valid && s.type == ShapeType::Square) {
+                            b = a + 1;
+                        }
+                        int ux = a * d[0], uy = a * d[1], vx = -b * d[1], vy = b * d[0];
+                        if (!s.valid && s.type == ShapeType::Rectangle) {
+                            vx += d[0];
+                            vy += d[1];
+                        }
+                        int px = cx - (ux + vx) / 2, py = cy - (uy + vy) / 2;
+                        s.corner = {px, py, px + ux, py + uy, px + ux + vx, py + uy + vy, px + vx, py + vy};
+                        place(s, 4);
+                        break;
+                    }
+                    case ShapeType::Rhombus: {
+                        s.angle = static_cast<std::int16_t>(s.valid ? r.between(5, 89) : r.between(90, 179));
+                        double stretch = 1 / std::sqrt(std::sin(std::min<int>(s.angle, 180 - s.angle) * M_PI / 180));
+                        s.size = std::max(1, static_cast<int>(std::lround(size * stretch)));
+                        s.corner[0] = std::max(0, std::min(cx, m_config.width));
+                        s.corner[1] = std::max(0, std::min(cy, m_config.height));
+                        break;
+                    }
+                }
+                return s;
+            }
+
+            /**
+             * \brief Builds a figure with the library's constructors.
+             *
+             * \param s Constructor arguments.
+             * \return The new figure.
+             *
+             * \throws const char* The constructor's error if the arguments are invalid.
+             */
+            static std::unique_ptr<Figure> build(const ShapeSpec &s) {
+                auto point = [&](int k) {
+                    return Point(s.corner[2 * k], s.corner[2 * k + 1]);
+                };
+                switch (s.type) {
+                    case ShapeType::Circle:
+                        return std::unique_ptr<Figure>(new Circle(s.size, point(0)));
+                    case ShapeType::Triangle:
+                        return std::unique_ptr<Figure>(new Triangle({point(0), point(1), point(2)}));
+                    case ShapeType::Rectangle:
+                        return std::unique_ptr<Figure>(new Rectangle(std::array<Point, 4> {point(0), point(1), point(2), point(3)}));
+                    case ShapeType::Square:
+                        return std::unique_ptr<Figure>(new Square(std::array<Point, 4> {point(0), point(1), point(2), point(3)}));
+                    case ShapeType::Rhombus:
+                        return std::unique_ptr<Figure>(new Rhombus(s.size, s.angle, point(0)));
+                }
+                throw "Unknown figure type";
+            }
+
+            /**
+             * \brief Streams a range of the scene in parallel chunks.
+             *
+             * \param begin First index.
+             * \param end One past the last index.
+             * \param fn Called as fn(first, specs, n) for every chunk of n specs starting at index first; concurrently from several threads.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             */
+            template <typename Fn>
+            void generate(std::uint64_t begin, std::uint64_t end, Fn fn, unsigned threads = 0) const {
+                const std::size_t chunk = 4096;
+                parallelFor(static_cast<std::size_t>(end - begin), chunk, [&](std::size_t first, std::size_t last) {
+                    ShapeSpec buffer[chunk];
+                    for (std::size_t i = first; i < last; ++i) {
+                        buffer[i - first] = spec(begin + i);
+                    }
+                    fn(begin + first, static_cast<const ShapeSpec*>(buffer), last - first);
+                }, threads);
+            }
+
+            /**
+             * \brief Computes the whole scene.
+             *
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Specs of all figures in index order.
+             */
+            std::vector<ShapeSpec> specs(unsigned threads = 0) const {
+                std::vector<ShapeSpec> out(m_config.count);
+                generate(0, m_config.count, [&](std::uint64_t first, const ShapeSpec *s, std::size_t n) {
+                    std::copy(s, s + n, out.begin() + first);
+                }, threads);
+                return out;
+            }
+
+            /**
+             * \brief Builds the whole scene as figures.
+             *
+             * \param rejected Receives the number of specs the constructors rejected, if not null.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Accepted figures in index order.
+             */
+            std::vector<std::unique_ptr<Figure>> figures(std::size_t *rejected = nullptr, unsigned threads = 0) const {
+                std::vector<std::unique_ptr<Figure>> all(m_config.count);
+                generate(0, m_config.count, [&](std::uint64_t first, const ShapeSpec *s, std::size_t n) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        try {
+                            all[first + i] = build(s[i]);
+                        }
+                        catch (const char*) {
+                        }
+                    }
+                }, threads);
+                std::size_t kept = 0;
+                for (std::unique_ptr<Figure> &f : all) {
+                    if (f != nullptr) {
+                        all[kept++] = std::move(f);
+                    }
+                }
+                if (rejected != nullptr) {
+                    *rejected = all.size() - kept;
+                }
+                all.resize(kept);
+                return all;
+            }
+
+            /**
+             * \brief Writes the whole scene to a file of ShapeSpec records.
+             *
+             * Chunks are generated in parallel and written to their own place in the file.
+             *
+             * \param path File to create or overwrite.
+             * \param threads Number of threads, 0 means one per hardware thread.
+             * \return Size of the file in bytes.
+             *
+             * \throws const char* If the file cannot be written.
+             */
+            std::uint64_t write(const std::string &path, unsigned threads = 0) const;
+    };
+
+/**
+ * \brief File of ShapeSpec records written by WorkloadGenerator::write().
+ *
+ * A 64-byte header with the magic "MWSHAPES", the record size and the number
+ * of records and the generator's seed is followed by the records in index order.
+ */
+    class WorkloadFile {
+        public:
+            /**
+             * \brief File header, 64 bytes.
+             */
+            struct Header {
+                std::uint64_t magic;
+                std::uint32_t version;
+                std::uint32_t recordBytes;
+                std::uint64_t count;
+                std::uint64_t seed;
+                std::uint64_t reserved[4];
+            };
+
+            /**
+             * \brief Marks a workload file ("MWSHAPES").
+             */
+            static constexpr std::uint64_t magic = 0x5345504148535747ULL;
+
+            static_assert(sizeof(Header) == 64, "Header must be 64 bytes");
+            static_assert(sizeof(ShapeSpec) == 44, "Records must be 44 bytes");
+
+        private:
+            /**
+             * \brief Open file.
+             */
+            int m_fd = -1;
+
+            /**
+             * \brief Header read from the file.
+             */
+            Header m_header {};
+
+        public:
+            /**
+             * \brief Opens a workload file.
+             *
+             * \param path File to read.
+             *
+             * \throws const char* If the file cannot be opened or is not a workload file.
+             */
+            explicit WorkloadFile(const std::string &path) {
+                m_fd = ::open(path.c_str(), O_RDONLY);
+                if (m_fd < 0) {
+                    throw "Cannot open workload file";
+                }
+                struct stat info;
+                if (pread(m_fd, &m_header, sizeof(m_header), 0) != sizeof(m_header) || fstat(m_fd, &info) != 0
+                    || m_header.magic != magic || m_header.recordBytes != sizeof(ShapeSpec)
+                    || static_cast<std::uint64_t>(info.st_size) < sizeof(Header) + m_header.count * sizeof(ShapeSpec)) {
+                    close(m_fd);
+                    throw "Not a workload file";
+                }
+            }
+
+            WorkloadFile(const WorkloadFile&) = delete;
+            WorkloadFile &operator=(const WorkloadFile&) = delete;
+
+            /**
+             * \brief Closes the file.
+             */
+            ~WorkloadFile() {
+                close(m_fd);
+            }
+
+            /**
+             * \brief Returns the number of records.
+             *
+             * \return Number of figures in the file.
+             */
+            std::uint64_t size() const {
+                return m_header.count;
+            }
+
+            /**
+             * \brief Returns the file descriptor, for reading records directly.
+             *
+             * \return Descriptor open for reading.
+             */
+            int descriptor() const {
+                return m_fd;
+            }
+
+            /**
+             * \brief Returns the file offset of a record.
+             *
+             * \param index Record index.
+             * \return Offset in bytes.
+             */
+            static std::uint64_t offset(std::uint64_t index) {
+                return sizeof(Header) + index * sizeof(ShapeSpec);
+            }
+
+            /**
+             * \brief Reads a range of records. Safe to call from several threads.
+             *
+             * \param first Index of the first record.
+             * \param out Buffer filled with up to n records.
+             * \param n Largest number of records to read.
+             * \return Number of records read, less than n at the end of the file.
+             *
+             * \throws const char* If reading fails.
+             */
+            std::size_t read(std::uint64_t first, ShapeSpec *out, std::size_t n) const {
+                if (first >= m_header.count) {
+                    return 0;
+                }
+                n = static_cast<std::size_t>(std::min<std::uint64_t>(n, m_header.count - first));
+                char *target = reinterpret_cast<char*>(out);
+                std::size_t bytes = n * sizeof(ShapeSpec), done = 0;
+                while (done < bytes) {
+                    ssize_t got = pread(m_fd, target + done, bytes - done, static_cast<off_t>(offset(first) + done));
+                    if (got <= 0) {
+                        throw "Cannot read workload file";
+                    }
+                    done += static_cast<std::size_t>(got);
+                }
+                return n;
+            }
+    };
+
+    inline std::uint64_t WorkloadGenerator::write(const std::string &path, unsigned threads) const {
+        int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0) {
+            throw "Cannot create workload file";
+        }
+        const std::uint64_t bytes = WorkloadFile::offset(m_config.count);
+        WorkloadFile::Header header {0, 1, sizeof(ShapeSpec), m_config.count, m_config.seed, {0, 0, 0, 0}};
+        bool failed = ftruncate(fd, static_cast<off_t>(bytes)) != 0;
+        try {
+            if (!failed) {
+                generate(0, m_config.count, [&](std::uint64_t first, const ShapeSpec *s, std::size_t n) {
+                    std::size_t length = n * sizeof(ShapeSpec);
+                    if (pwrite(fd, s, length, static_cast<off_t>(WorkloadFile::offset(first))) != static_cast<ssize_t>(length)) {
+                        throw "Cannot write workload file";
+                    }
+                }, threads);
+            }
+        }
+        catch (...) {
+            close(fd);
+            throw;
+        }
+        // The magic goes in last, so an interrupted write leaves no valid file
+        header.magic = WorkloadFile::magic;
+        failed = failed || pwrite(fd, &header, sizeof(header), 0) != sizeof(header);
+        close(fd);
+        if (failed) {
+            throw "Cannot write workload file";
+        }
+        return bytes;
+    }
+
+} // namespace mw
\ No newline at end of file
@@ -4,10 +4,138 @@
 #include "Circle.hpp"
 #include "Square.hpp"
 #include "Rectangle.hpp"
+#include "Rasterizer.hpp"
+#include "KDTree.hpp"
+#include "Deduplicate.hpp"
+#include "DynamicBVH.hpp"
+#include "TriangleMesh.hpp"
+#include "Delaunay.hpp"
+#include "FigureView.hpp"
+#include "Ranking.hpp"
+#include "CircleIntersection.hpp"
+#include "Clipping.hpp"
+#include "Aggregates.hpp"
+#include "SharedStore.hpp"
+#include "QueryServer.hpp"
+#include "SnapshotCollection.hpp"
+#include "FigureQuery.hpp"
+#include "QuadTree.hpp"
+#include "ColumnarExport.hpp"
+#include "Workload.hpp"
+#include "Streaming.hpp"
+#include "ConvexHull.hpp"
+#include "Distance.hpp"
+#include "AxisRect.hpp"
+#include <unordered_set>
 #include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 using namespace mw;
 
+// Counts heap allocations, so tests can check that loops do not allocate.
+// Every form of the global operator new and delete is replaced, so all of
+// them agree on malloc and free.
+std::atomic<std::size_t> allocations {0};
+
+void* countedAllocate(std::size_t size, std::size_t alignment) noexcept {
+    ++allocations;
+    size = size == 0 ? 1 : size;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+}
+
+void* countedAllocateOrThrow(std::size_t size, std::size_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
 void describe(const Figure& block)
 {
     std::cout << "My name: " << block.getName() << std::endl;
@@ -176,12 +304,1577 @@ void test_figure() {
     std::cout << "\n=== All Figure Operator Tests Complete ===" << std::endl;
 }
 
+void test_rasterizer() {
+    std::cout << "\n=== Testing Rasterizer ===" << std::endl;
+
+    Rectangle rectangle({Point(1,5), Point(1,2), Point(6,5), Point(6,2)});
+    Triangle triangle({Point(0,0), Point(8,0), Point(0,8)});
+    Circle circle(3, Point(10, 10));
+    std::vector<const Figure*> figures {&rectangle, &triangle, &circle};
+
+    // Small tiles so figures span several of them
+    Rasterizer rasterizer(16, 16, 4);
+    std::vector<std::uint32_t> counts = rasterizer.countMap(figures);
+
+    std::uint32_t rectangleCells = 0;
+    for (int y = 2; y < 5; ++y) {
+        for (int x = 1; x < 6; ++x) {
+            rectangleCells += counts[y * 16 + x] >= 1;
+        }
+    }
+    std::cout << "Rectangle cells: " << rectangleCells << std::endl;
+    if (rectangleCells != 15) {
+        throw "Rectangle should cover 15 cells";
+    }
+
+    if (counts[3 * 16 + 2] != 2 || counts[15 * 16 + 15] != 0) {
+        throw "Overlapping cells should be counted twice";
+    }
+
+    std::vector<std::uint8_t> occupied = rasterizer.occupancyMap(figures);
+    std::size_t total = 0;
+    for (std::uint8_t cell : occupied) {
+        total += cell;
+    }
+    std::cout << "Occupied cells: " << total << std::endl;
+    if (total == 0 || total > 16 * 16) {
+        throw "Occupancy map is invalid";
+    }
+
+    std::cout << "\n=== All Rasterizer Tests Complete ===" << std::endl;
+}
+
+void test_kdtree() {
+    std::cout << "\n=== Testing KDTree ===" << std::endl;
+
+    Circle circle1(1, Point(0, 0));
+    Circle circle2(1, Point(10, 0));
+    Circle circle3(8, Point(30, 30));
+    Square square(2, Point(4, 4));
+    std::vector<const Figure*> figures {&circle1, &circle2, &circle3, &square};
+
+    KDTree tree(figures);
+
+    std::vector<Neighbor> nearest = tree.nearest(Point(9, 1), 2);
+    std::cout << "Nearest to (9,1): " << nearest[0].index << ", " << nearest[1].index << std::endl;
+    if (nearest.size() != 2 || nearest[0].index != 1 || nearest[1].index != 3) {
+        throw "Nearest centers should be circle2 and square";
+    }
+
+    std::vector<Neighbor> within = tree.withinRadius(Point(2, 2), 3);
+    std::cout << "Centers within 3 of (2,2): " << within.size() << std::endl;
+    if (within.size() != 2) {
+        throw "Two centers should lie within radius 3";
+    }
+
+    // circle3 has a distant center but the closest boundary
+    std::vector<Neighbor> boundary = tree.nearestByBoundary(Point(20, 20), 1);
+    std::cout << "Nearest boundary to (20,20): " << boundary[0].index << " at " << boundary[0].distance << std::endl;
+    if (boundary[0].index != 2) {
+        throw "Nearest boundary should belong to circle3";
+    }
+
+    std::cout << "\n=== All KDTree Tests Complete ===" << std::endl;
+}
+
+void test_deduplicate() {
+    std::cout << "\n=== Testing Deduplicate ===" << std::endl;
+
+    std::unordered_set<Point> points {Point(1, 2), Point(1, 2), Point(2, 1)};
+    if (points.size() != 2) {
+        throw "Equal points should hash equally";
+    }
+
+    Rectangle rectangle1({Point(1,5), Point(1,2), Point(6,5), Point(6,2)});
+    Rectangle rectangle2({Point(6,2), Point(1,5), Point(6,5), Point(1,2)});
+    Square square({Point(1,2), Point(4,2), Point(4,5), Point(1,5)});
+    Triangle triangle1({Point(6,3), Point(2,4), Point(1,10)});
+    Triangle triangle2({Point(1,10), Point(6,3), Point(2,4)});
+    Circle circle1(3, Point(1, 1));
+    Circle circle2(3, Point(1, 1));
+    std::vector<const Figure*> figures {&rectangle1, &triangle1, &rectangle2, &circle1, &square, &triangle2, &circle2};
+
+    if (canonical(rectangle1) != canonical(rectangle2) || canonical(rectangle1).hash() != canonical(rectangle2).hash()) {
+        throw "Rectangles with reordered corners should be equal";
+    }
+
+    std::vector<std::size_t> unique = deduplicate(figures);
+    std::cout << "Unique figures: " << unique.size() << std::endl;
+    if (unique != std::vector<std::size_t>{0, 1, 3, 4}) {
+        throw "Deduplicate should keep the first occurrence of each figure";
+    }
+
+    std::cout << "\n=== All Deduplicate Tests Complete ===" << std::endl;
+}
+
+void test_dynamic_bvh() {
+    std::cout << "\n=== Testing DynamicBVH ===" << std::endl;
+
+    std::vector<Circle> circles;
+    for (int i = 0; i < 100; ++i) {
+        circles.emplace_back(1, Point(10 * (i % 10) + 5, 10 * (i / 10) + 5));
+    }
+    // No movement prediction, so fat boxes stay close to the figures
+    DynamicBVH bvh(1.0, 0.0);
+    std::vector<int> ids;
+    for (Circle &circle : circles) {
+        ids.push_back(bvh.insert(circle));
+    }
+    std::cout << "Height: " << bvh.height() << std::endl;
+    if (bvh.size() != 100 || bvh.height() > 10) {
+        throw "Tree should hold 100 balanced leaves";
+    }
+
+    auto count = [&bvh](const BoundingBox &box) {
+        int found = 0;
+        bvh.query(box, [&found](int, const Figure&) { ++found; return true; });
+        return found;
+    };
+    if (count({0, 0, 20, 20}) != 4) {
+        throw "Query should find the four circles in the corner";
+    }
+
+    // A small move stays inside the fat box, a large one reinserts the leaf
+    if (bvh.setCenter(ids[0], Point(5, 6))) {
+        throw "Small move should not reinsert";
+    }
+    if (!bvh.setCenter(ids[0], Point(500, 500))) {
+        throw "Large move should reinsert";
+    }
+    if (count({0, 0, 20, 20}) != 3 || count({490, 490, 510, 510}) != 1) {
+        throw "Moved circle should be found at its new position";
+    }
+
+    circles[1].setCenter(Point(700, 700));
+    std::size_t moved = bvh.updateAll();
+    bvh.remove(ids[2]);
+    bvh.rebuild();
+    std::cout << "Moved: " << moved << ", size after remove: " << bvh.size() << std::endl;
+    if (moved != 1 || bvh.size() != 99 || count({690, 690, 710, 710}) != 1) {
+        throw "updateAll should reinsert the moved circle";
+    }
+
+    std::cout << "\n=== All DynamicBVH Tests Complete ===" << std::endl;
+}
+
+void test_float_figures() {
+    std::cout << "\n=== Testing Float Figures ===" << std::endl;
+
+    CircleF circle(3.5f, PointF(1.5f, 1.5f));
+    TriangleF triangle({PointF(6,3), PointF(2,4), PointF(1,10)});
+    RectangleF rectangle({PointF(1,5), PointF(1,2), PointF(6,5), PointF(6,2)});
+    SquareF square(3, PointF(1, 1));
+    RhombusF rhombus(5, 60, PointF(1, 1));
+
+    std::cout << "Circle area: " << circle.area() << std::endl;
+    if (std::abs(triangle.area() - 11.5f) > 1e-5f || std::abs(rectangle.area() - 15.0f) > 1e-5f
+        || std::abs(square.perimeter() - 12.0f) > 1e-5f) {
+        throw "Float figures should match the default precision";
+    }
+    if (std::abs(rhombus.area() - Rhombus(5, 60, Point(1, 1)).area()) > 1e-4) {
+        throw "Float rhombus area differs too much";
+    }
+
+    std::cout << "sizeof(Rectangle): " << sizeof(Rectangle) << ", sizeof(RectangleF): " << sizeof(RectangleF) << std::endl;
+    if (sizeof(RectangleF) >= sizeof(Rectangle)) {
+        throw "Float rectangle should be smaller";
+    }
+
+    std::cout << "\n=== All Float Figure Tests Complete ===" << std::endl;
+}
+
+void test_triangle_mesh() {
+    std::cout << "\n=== Testing TriangleMesh ===" << std::endl;
+
+    // Unit square split along its diagonal plus one triangle on top
+    std::vector<Triangle> triangles {
+        Triangle({Point(0,0), Point(2,0), Point(2,2)}),
+        Triangle({Point(0,0), Point(2,2), Point(0,2)}),
+        Triangle({Point(0,2), Point(2,2), Point(1,4)})
+    };
+    TriangleMesh mesh = TriangleMesh::fromTriangles(triangles);
+
+    std::cout << "Vertices: " << mesh.vertexCount() << ", total area: " << mesh.totalArea() << std::endl;
+    if (mesh.vertexCount() != 5 || mesh.size() != 3) {
+        throw "Shared corners should be stored once";
+    }
+    if (std::abs(mesh.totalArea() - 6) > 1e-9) {
+        throw "Total area should be 6";
+    }
+
+    std::vector<double> perimeters = mesh.perimeters();
+    for (std::size_t i = 0; i < triangles.size(); ++i) {
+        if (std::abs(perimeters[i] - triangles[i].perimeter()) > 1e-9 || std::abs(mesh.area(i) - triangles[i].area()) > 1e-9) {
+            throw "Mesh triangles should match the original triangles";
+        }
+    }
+
+    std::vector<std::array<std::int64_t, 3>> adjacency = mesh.adjacency();
+    if (adjacency[0][2] != 1 || adjacency[1][0] != 0 || adjacency[1][1] != 2 || adjacency[2][0] != 1) {
+        throw "Triangles sharing an edge should be neighbors";
+    }
+
+    bool rejected = false;
+    try{
+        mesh.addTriangle(mesh.addVertex(Point(5,5)), mesh.addVertex(Point(6,6)), mesh.addVertex(Point(7,7)));
+    }
+    catch(const char* s) {
+        std::cout << "Error:" << s << std::endl;
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Collinear triangle should be rejected";
+    }
+
+    std::cout << "\n=== All TriangleMesh Tests Complete ===" << std::endl;
+}
+
+void test_delaunay() {
+    std::cout << "\n=== Testing Delaunay ===" << std::endl;
+
+    // 4x4 lattice (cocircular everywhere) with a duplicate point
+    std::vector<Point> points;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            points.emplace_back(x, y);
+        }
+    }
+    points.emplace_back(2, 2);
+
+    TriangleMesh mesh = Delaunay::triangulate(points);
+    std::cout << "Triangles: " << mesh.size() << ", area: " << mesh.totalArea() << std::endl;
+    if (mesh.vertexCount() != 16 || mesh.size() != 18) {
+        throw "Lattice should give 18 triangles over 16 vertices";
+    }
+    if (std::abs(mesh.totalArea() - 9) > 1e-9) {
+        throw "Triangles should cover the convex hull";
+    }
+
+    TriangleMesh line = Delaunay::triangulate({Point(0,0), Point(1,1), Point(2,2)});
+    if (line.size() != 0) {
+        throw "Collinear points should give no triangles";
+    }
+
+    std::cout << "\n=== All Delaunay Tests Complete ===" << std::endl;
+}
+
+void test_figure_view() {
+    std::cout << "\n=== Testing FigureView ===" << std::endl;
+
+    Rectangle rectangle({Point(1,5), Point(1,2), Point(6,5), Point(6,2)});
+    Rhombus rhombus(5, 60, Point(1, 1));
+    Circle circle(3, Point(1, 1));
+    // Names longer than the small string buffer, so copying them would allocate
+    rectangle.setName("Rectangle with a long name");
+    rhombus.setName("Rhombus with a long name");
+    circle.setName("Circle with a long name");
+    std::vector<FigureView> views {rectangle, rhombus, &circle};
+
+    std::size_t before = allocations;
+    double total = 0;
+    std::size_t nameLength = 0;
+    int x = 0;
+    for (int i = 0; i < 1000; ++i) {
+        for (const FigureView &view : views) {
+            total += view.area() + view.perimeter();
+            nameLength += view.getName().size() + view.get().getName().size();
+            x += view.getCenter().getX();
+        }
+        x += rectangle.getCorner()[0].getX() + rhombus.getCorner()[0].getX();
+    }
+    std::size_t made = allocations - before;
+
+    std::cout << "Allocations in loop: " << made << " (total " << total << ", " << nameLength << ", " << x << ")" << std::endl;
+    if (made != 0) {
+        throw "Reading figures through views should not allocate";
+    }
+
+    std::cout << "\n=== All FigureView Tests Complete ===" << std::endl;
+}
+
+void test_ranking() {
+    std::cout << "\n=== Testing Ranking ===" << std::endl;
+
+    Circle circle(1, Point(1, 1));
+    Square square1(3, Point(1, 1));
+    Rectangle rectangle(9, 1, Point(1, 1));
+    Square square2(2, Point(1, 1));
+    Triangle triangle({Point(0,0), Point(4,0), Point(0,2)});
+    std::vector<const Figure*> figures {&circle, &square1, &rectangle, &square2, &triangle};
+
+    // Areas: 3.14, 9, 9, 4, 4 - equal areas keep their input order
+    std::vector<std::size_t> ascending = Ranking::order(figures, RankKey::Area);
+    if (ascending != std::vector<std::size_t>{0, 3, 4, 1, 2}) {
+        throw "Ascending area order is wrong";
+    }
+    std::vector<std::size_t> descending = Ranking::order(figures, RankKey::Perimeter, true);
+    std::cout << "Largest perimeter: " << figures[descending[0]]->getName() << std::endl;
+    if (descending[0] != 2 || descending[4] != 0) {
+        throw "Descending perimeter order is wrong";
+    }
+
+    std::vector<std::size_t> top = Ranking::top(figures, RankKey::Area, 2, true);
+    if (top != std::vector<std::size_t>{1, 2}) {
+        throw "Top two areas should be the square and the rectangle";
+    }
+    std::vector<std::size_t> smallest = Ranking::top(figures, RankKey::Area, 3);
+    if (smallest != std::vector<std::size_t>(ascending.begin(), ascending.begin() + 3)) {
+        throw "Top with default direction must be a prefix of the default order";
+    }
+
+    Ranking::apply(figures, ascending);
+    if (figures[0] != &circle || figures[4] != &rectangle) {
+        throw "Permutation was not applied";
+    }
+
+    std::cout << "\n=== All Ranking Tests Complete ===" << std::endl;
+}
+
+void test_circle_intersection() {
+    std::cout << "\n=== Testing Circle Intersection ===" << std::endl;
+
+    Circle big(10, Point(20, 20));
+    Circle inside(2, Point(22, 22));
+    Circle side(5, Point(35, 20));
+    Circle far(1, Point(60, 60));
+    if (!intersects(big, side) || intersects(big, far) || !contains(big, inside) || contains(inside, big)) {
+        throw "Circle-circle predicates are wrong";
+    }
+
+    Square square(4, Point(20, 20));
+    Triangle triangle({Point(40,40), Point(50,40), Point(40,50)});
+    if (!contains(big, square) || !contains(square, Circle(2, Point(20, 20))) || contains(square, inside)) {
+        throw "Circle-square containment is wrong";
+    }
+    if (!intersects(Circle(1, Point(41, 39)), triangle) || intersects(Circle(1, Point(48, 48)), triangle)) {
+        throw "Circle-triangle intersection is wrong";
+    }
+
+    std::vector<Circle> circles {big, inside, side, far};
+    CircleBlock block(circles);
+    std::vector<std::uint8_t> hits = touching(block, Circle(1, Point(30, 20)));
+    if (hits != std::vector<std::uint8_t>{1, 0, 1, 0}) {
+        throw "Batch kernel result is wrong";
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs = touchingPairs(block);
+    std::cout << "Touching pairs: " << pairs.size() << std::endl;
+    if (pairs != std::vector<std::pair<std::size_t, std::size_t>>{{0, 1}, {0, 2}}) {
+        throw "All-pairs query is wrong";
+    }
+
+    std::cout << "\n=== All Circle Intersection Tests Complete ===" << std::endl;
+}
+
+void test_clipping() {
+    std::cout << "\n=== Testing Clipping ===" << std::endl;
+
+    Square square(10, Point(10, 10));
+    Rectangle rectangle(4, 20, Point(15, 10));
+    Triangle triangle({Point(0,0), Point(20,0), Point(0,20)});
+    Rhombus rhombus(6, 30, Point(40, 40));
+    BoundingBox window {10, 10, 50, 50};
+
+    ClippedPolygon part = Clipping::clip(square, window);
+    std::cout << "Square in window: " << part.size << " vertices, area " << part.area() << std::endl;
+    if (part.size != 4 || std::abs(part.area() - 25) > 1e-9) {
+        throw "Square clipped to window is wrong";
+    }
+    if (std::abs(Clipping::intersectionArea(square, rectangle) - 20) > 1e-9) {
+        throw "Square-rectangle overlap is wrong";
+    }
+    if (std::abs(Clipping::intersectionArea(square, triangle) - 50) > 1e-9) {
+        throw "Square-triangle overlap is wrong";
+    }
+    if (Clipping::clip(square, rhombus).size != 0 || Clipping::intersectionArea(rhombus, rhombus) <= 0) {
+        throw "Rhombus overlap is wrong";
+    }
+
+    // A self-intersecting outline crosses the window edges more often than a convex one
+    Outline zigzag;
+    zigzag.size = 4;
+    zigzag.vertex = {Vec2{3, 0}, Vec2{11, 13}, Vec2{5, 0}, Vec2{20, 7}};
+    Outline quad;
+    quad.size = 4;
+    quad.vertex = {Vec2{8, 6}, Vec2{11, 4}, Vec2{16, 5}, Vec2{8, 17}};
+    ClippedPolygon crossed = Clipping::clip(zigzag, quad);
+    std::cout << "Self-intersecting outline clipped to " << crossed.size << " vertices" << std::endl;
+    if (crossed.size <= 8 || crossed.size > static_cast<int>(crossed.vertex.size())) {
+        throw "Clipping a self-intersecting outline must keep every vertex";
+    }
+
+    std::vector<const Figure*> figures {&square, &rectangle, &triangle, &rhombus};
+    std::vector<double> areas = Clipping::areas(figures, window);
+    std::vector<ClippedPolygon> parts = Clipping::clipAll(figures, window);
+    for (std::size_t i = 0; i < figures.size(); ++i) {
+        if (std::abs(areas[i] - parts[i].area()) > 1e-9) {
+            throw "Batch clip area differs from the clipped polygon";
+        }
+    }
+    if (std::abs(areas[2] - 0) > 1e-9 || std::abs(areas[3] - rhombus.area()) > 1e-9) {
+        throw "Batch clip area is wrong";
+    }
+    // Windows without area: a point inside the square and a line across it
+    for (const BoundingBox &flat : {BoundingBox {12, 12, 12, 12}, BoundingBox {12, 0, 12, 30}}) {
+        std::vector<ClippedPolygon> none = Clipping::clipAll(figures, flat);
+        std::vector<double> zero = Clipping::areas(figures, flat);
+        for (std::size_t i = 0; i < figures.size(); ++i) {
+            if (none[i].size != 0 || zero[i] != 0) {
+                throw "Clipping to a window without area must be empty";
+            }
+        }
+    }
+
+    Circle circle(3, Point(15, 15));
+    bool rejected = false;
+    try {
+        Clipping::clip(circle, window);
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Circle must not be clipped";
+    }
+
+    std::cout << "\n=== All Clipping Tests Complete ===" << std::endl;
+}
+
+void test_precision() {
+    std::cout << "\n=== Testing Precision ===" << std::endl;
+
+    double worst = 0;
+    for (int angle = 1; angle < 90; ++angle) {
+        Rhombus rhombus(7, angle, Point(0, 0));
+        const Figure &figure = rhombus;
+        double exact = figure.area(Precision::Exact);
+        worst = std::max(worst, std::abs(figure.area(Precision::Fast) - exact) / exact);
+    }
+    std::cout << "Rhombus area relative error: " << worst << std::endl;
+    if (worst > 1e-15) {
+        throw "Rhombus table area exceeds its error bound";
+    }
+
+    worst = 0;
+    for (int i = 1; i < 200; ++i) {
+        Triangle triangle({Point(0, 0), Point(i * 7919 % 1000, i), Point(500 + i, i * 104729 % 997)});
+        double exact = triangle.perimeter();
+        worst = std::max(worst, std::abs(triangle.perimeter(Precision::Fast) - exact) / exact);
+    }
+    std::cout << "Triangle perimeter relative error: " << worst << std::endl;
+    if (worst > FastMath::sqrtError) {
+        throw "Triangle fast perimeter exceeds its error bound";
+    }
+    Triangle large({Point(0, 0), Point(60000, 0), Point(0, 80000)});
+    if (large.perimeter() != 240000 || std::abs(large.perimeter(Precision::Fast) - 240000) > 240000 * FastMath::sqrtError) {
+        throw "Triangle perimeter overflows for large coordinates";
+    }
+
+    worst = 0;
+    for (int i = -1000; i <= 1000; ++i) {
+        double x = i / 1000.0;
+        worst = std::max(worst, std::abs(FastMath::acosDegrees(x) - std::acos(x) * 180 / M_PI));
+    }
+    std::cout << "acos error in degrees: " << worst << std::endl;
+    if (worst > FastMath::acosError) {
+        throw "Fast acos exceeds its error bound";
+    }
+
+    // Rhombi from corners in any order, with angles above and below 60 degrees
+    std::array<Point, 4> wide {Point(0,0), Point(5,0), Point(8,4), Point(3,4)};
+    std::array<Point, 4> narrow {Point(9,3), Point(0,0), Point(4,3), Point(5,0)};
+    for (Precision precision : {Precision::Exact, Precision::Fast}) {
+        Rhombus a(wide, precision), b(narrow, precision);
+        if (a.getAngle() != 53 || b.getAngle() != 37 || std::abs(a.getA() - 5) > 1e-12 || std::abs(b.getA() - 5) > 1e-12) {
+            throw "Rhombus from corners has wrong side or angle";
+        }
+        // The angle is rounded to whole degrees, the area comes from the corners
+        Rhombus sliver({Point(200, 300), Point(201, 180), Point(202, 300), Point(201, 420)}, precision);
+        Rhombus kite({Point(1, 2), Point(2, 0), Point(3, 2), Point(2, 4)}, precision);
+        if (sliver.getAngle() != 1 || sliver.area() != 240 || sliver.area(precision) != 240 || kite.area() != 4) {
+            throw "Rhombus from corners has wrong angle or area";
+        }
+    }
+    std::cout << "Rhombus from corners: angles " << Rhombus(wide).getAngle() << " and " << Rhombus(narrow).getAngle() << std::endl;
+    for (const std::array<Point, 4> &invalid : {std::array<Point, 4> {Point(0,0), Point(4,0), Point(4,4), Point(0,4)},
+                                                std::array<Point, 4> {Point(0,0), Point(6,0), Point(8,4), Point(3,4)},
+                                                std::array<Point, 4> {Point(1,1), Point(1,1), Point(1,1), Point(1,1)},
+                                                std::array<Point, 4> {Point(300,250), Point(301,0), Point(302,250), Point(301,500)}}) {
+        bool rejected = false;
+        try {
+            Rhombus rhombus(invalid, Precision::Fast);
+        }
+        catch (const char*) {
+            rejected = true;
+        }
+        if (!rejected) {
+            throw "Squares, non-rhombi, degenerate corners and angles below half a degree must be rejected";
+        }
+    }
+
+    Circle circle(2, Point(0, 0));
+    if (circle.area(Precision::Fast) != circle.area()) {
+        throw "Figures without approximations must ignore the precision";
+    }
+
+    std::cout << "\n=== All Precision Tests Complete ===" << std::endl;
+}
+
+void test_aggregates() {
+    std::cout << "\n=== Testing Aggregates ===" << std::endl;
+
+    Circle circle(2, Point(5, 5));
+    Rectangle rectangle(3, 4, Point(10, 10));
+    Square square(5, Point(20, 20));
+    Rhombus rhombus(4, 30, Point(30, 30));
+
+    FigureAggregates totals;
+    int c = totals.insert(circle);
+    int r = totals.insert(rectangle);
+    int s = totals.insert(square);
+    totals.insert(rhombus);
+
+    auto expectTotals = [&](double area, double perimeter) {
+        if (std::abs(totals.totalArea() - area) > 1e-9 || std::abs(totals.totalPerimeter() - perimeter) > 1e-9) {
+            throw "Aggregates do not match the figures";
+        }
+    };
+    expectTotals(circle.area() + 12 + 25 + 8, circle.perimeter() + 14 + 20 + 16);
+    if (totals.size() != 4 || totals.count(ShapeType::Square) != 1 || totals.count(ShapeType::Triangle) != 0) {
+        throw "Aggregate counts are wrong";
+    }
+
+    // Changes show up only after the commit
+    circle.setRadius(3);
+    totals.markDirty(c);
+    totals.modify(r, [](Figure &f) { static_cast<Rectangle&>(f).setA(6); });
+    totals.markDirty(c);
+    if (totals.dirtyCount() != 2) {
+        throw "Dirty figures are tracked twice";
+    }
+    expectTotals(circle.area() - M_PI * 5 + 12 + 25 + 8, 2 * M_PI * 2 + 14 + 20 + 16);
+    std::cout << "Committed: " << totals.commit() << std::endl;
+    expectTotals(circle.area() + 24 + 25 + 8, circle.perimeter() + 20 + 20 + 16);
+
+    // Removing drops pending changes and frees the id for the next figure
+    square.setA(1);
+    totals.markDirty(s);
+    totals.remove(s);
+    Triangle triangle({Point(0,0), Point(4,0), Point(0,3)});
+    if (totals.insert(triangle) != s || totals.dirtyCount() != 0) {
+        throw "Removed figure is still tracked";
+    }
+    expectTotals(circle.area() + 24 + 6 + 8, circle.perimeter() + 20 + 12 + 16);
+    if (totals.count(ShapeType::Square) != 0 || totals.count(ShapeType::Triangle) != 1) {
+        throw "Aggregate counts are wrong after removal";
+    }
+
+    // Changes without markDirty are picked up by a full recomputation
+    rhombus.setA(2);
+    totals.recompute();
+    expectTotals(circle.area() + 24 + 6 + 2, circle.perimeter() + 20 + 12 + 8);
+
+    std::cout << "\n=== All Aggregates Tests Complete ===" << std::endl;
+}
+
+void test_shared_store() {
+    std::cout << "\n=== Testing Shared Store ===" << std::endl;
+
+    const std::string name = "/mw_test_" + std::to_string(getpid());
+    SharedFigureStore::unlink(name);
+    SharedFigureStore writer = SharedFigureStore::create(name, 1 << 16);
+    SharedFigureStore reader = SharedFigureStore::open(name);
+
+    bool rejected = false;
+    try {
+        reader.snapshot();
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected || reader.version() != 0) {
+        throw "Snapshot before the first version must fail";
+    }
+
+    Circle circle(2, Point(5, 5));
+    Square square(4, Point(20, 20));
+    Triangle triangle({Point(0,0), Point(4,0), Point(0,3)});
+    writer.publish({&circle, &square, &triangle});
+
+    SharedFigureStore::Snapshot first = reader.snapshot();
+    std::cout << "Version " << first.version() << " with " << first.size() << " figures" << std::endl;
+    if (first.size() != 3 || first[1].type != ShapeType::Square || first[1].area != 16 || first.name(0) != "Circle") {
+        throw "Shared records are wrong";
+    }
+
+    // A new version does not change a snapshot that is still held
+    Square bigger(10, Point(20, 20));
+    writer.publish({&circle, &bigger});
+    SharedFigureStore::Snapshot second = reader.snapshot();
+    if (second.version() != 2 || second.size() != 2 || second[1].area != 100 || first.size() != 3 || first[1].area != 16) {
+        throw "Versions are not isolated";
+    }
+
+    std::size_t found = 0;
+    second.query(BoundingBox {14, 14, 16, 16}, [&](std::size_t i, const SharedRecord &r) {
+        found += r.outline.contains(Vec2 {15, 15}) && i == 1;
+    });
+    if (found != 1) {
+        throw "Shared query is wrong";
+    }
+
+    SharedFigureStore::unlink(name);
+    std::cout << "\n=== All Shared Store Tests Complete ===" << std::endl;
+}
+
+void test_query_server() {
+    std::cout << "\n=== Testing Query Server ===" << std::endl;
+
+    Circle circle(5, Point(10, 10));
+    Square square(10, Point(30, 10));
+    Triangle triangle({Point(0,20), Point(20,20), Point(0,40)});
+    std::vector<const Figure*> scene {&circle, &square, &triangle};
+
+    const std::string path = "/tmp/mw_query_" + std::to_string(getpid()) + ".sock";
+    QueryServer server(scene, path, 2);
+    QueryClient client(path);
+
+    QueryResult result = client.call(QueryRequest::measure(7, 1));
+    if (result.header.id != 7 || result.header.status != 0 || result.header.value[0] != 100 || result.header.value[1] != 40) {
+        throw "Measure response is wrong";
+    }
+    if (client.call(QueryRequest::measure(8, 3)).header.status != 2) {
+        throw "Out of range index must be rejected";
+    }
+
+    result = client.call(QueryRequest::hitTest(9, {26, 12}));
+    if (result.header.count != 1 || result.items != std::vector<std::uint32_t>{1}) {
+        throw "Hit test response is wrong";
+    }
+    if (client.call(QueryRequest::hitTest(10, {19, 39})).header.count != 0) {
+        throw "Hit test outside every figure must be empty";
+    }
+
+    result = client.call(QueryRequest::range(11, {12, 0, 40, 22}));
+    if (result.header.count != 3) {
+        throw "Range response is wrong";
+    }
+
+    // Windows reaching far past the scene, or not numbers at all, are clamped to the grid
+    std::vector<std::unique_ptr<Figure>> tiles;
+    std::vector<const Figure*> tiled;
+    for (int i = 0; i < 400; ++i) {
+        tiles.emplace_back(new Square(20, Point(25 + 50 * (i % 20), 25 + 50 * (i / 20))));
+        tiled.push_back(tiles.back().get());
+    }
+    QueryScene large(tiled);
+    QueryResponse bounded, unbounded, invalid;
+    large.answer(QueryRequest::range(1, {500, 0, 1100, 1100}), bounded, nullptr, 0);
+    large.answer(QueryRequest::range(2, {500, 0, 1e12, 1e12}), unbounded, nullptr, 0);
+    large.answer(QueryRequest::range(3, {std::nan(""), 0, 1e300, std::nan("")}), invalid, nullptr, 0);
+    if (bounded.count != 200 || unbounded.count != bounded.count || invalid.count != 0) {
+        throw "Range over an unbounded window is wrong";
+    }
+
+    result = client.call(QueryRequest::aggregate(12));
+    if (result.header.count != 3 || result.items.size() != 5 || result.items[static_cast<int>(ShapeType::Square)] != 1
+        || std::abs(result.header.value[0] - (circle.area() + 100 + 200)) > 1e-9) {
+        throw "Aggregate response is wrong";
+    }
+
+    // Pipelined requests come back in order
+    for (std::uint32_t i = 0; i < 50; ++i) {
+        client.send(QueryRequest::measure(i, i % 3));
+    }
+    client.flush();
+    for (std::uint32_t i = 0; i < 50; ++i) {
+        client.receive(result);
+        if (result.header.id != i) {
+            throw "Pipelined responses are out of order";
+        }
+    }
+
+    // A pipeline far larger than the socket buffers: responses are read while the requests are sent
+    const std::uint32_t deep = 200000;
+    for (std::uint32_t i = 0; i < deep; ++i) {
+        client.send(QueryRequest::measure(i, i % 3));
+    }
+    client.flush();
+    for (std::uint32_t i = 0; i < deep; ++i) {
+        client.receive(result);
+        if (result.header.id != i) {
+            throw "Deeply pipelined responses are out of order";
+        }
+    }
+
+    LoadReport report = runLoad(path, server.scene().bounds(), scene.size(), 2, 2000, 16);
+    std::cout << "Load: " << report.requests << " requests, p50 " << report.p50 << " us, p99 " << report.p99
+              << " us, " << server.batches() << " batches" << std::endl;
+    if (report.requests != 4000 || report.p50 > report.p99) {
+        throw "Load report is wrong";
+    }
+
+    server.stop();
+    std::cout << "\n=== All Query Server Tests Complete ===" << std::endl;
+}
+
+void test_snapshot_collection() {
+    std::cout << "\n=== Testing Snapshot Collection ===" << std::endl;
+
+    SnapshotCollection collection;
+    SnapshotCollection::Reader reader = collection.reader();
+
+    SnapshotCollection::Batch batch = collection.batch();
+    std::uint64_t c = batch.add(Circle(2, Point(5, 5)));
+    std::uint64_t s = batch.add(Square(4, Point(20, 20)));
+    batch.add(Triangle({Point(0,0), Point(4,0), Point(0,3)}));
+    if (reader.snapshot().size() != 0) {
+        throw "Unpublished batch is visible";
+    }
+    std::cout << "Published version " << collection.publish(batch) << std::endl;
+
+    // A held snapshot keeps its version while the writer moves on
+    {
+        SnapshotCollection::Snapshot first = reader.snapshot();
+        if (first.version() != 1 || first.size() != 3 || first.find(s)->area() != 16) {
+            throw "Snapshot contents are wrong";
+        }
+
+        batch.modify(c, [](Figure &f) { static_cast<Circle&>(f).setRadius(3); });
+        batch.remove(s);
+        collection.publish(batch);
+        if (first.size() != 3 || static_cast<const Circle*>(first.find(c))->getRadius() != 2 || collection.pending() != 1) {
+            throw "Published batch changed a held snapshot";
+        }
+    }
+    SnapshotCollection::Snapshot second = reader.snapshot();
+    if (second.version() != 2 || second.size() != 2 || second.find(s) != nullptr
+        || static_cast<const Circle&>(second[0]).getRadius() != 3 || collection.pending() != 0) {
+        throw "New version is wrong or old version was not reclaimed";
+    }
+
+    bool rejected = false;
+    try {
+        batch.modify(s, [](Figure&) {});
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Modifying a removed figure must fail";
+    }
+
+    // Readers see every batch either completely or not at all
+    std::vector<std::uint64_t> circles;
+    for (int i = 0; i < 10; ++i) {
+        circles.push_back(batch.add(Circle(1, Point(i, i))));
+    }
+    collection.publish(batch);
+    std::atomic<bool> done {false};
+    std::atomic<int> torn {0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&]() {
+            SnapshotCollection::Reader own = collection.reader();
+            std::uint64_t last = 0;
+            while (!done.load()) {
+                SnapshotCollection::Snapshot snap = own.snapshot();
+                double radius = static_cast<const Circle*>(snap.find(circles[0]))->getRadius();
+                for (std::uint64_t id : circles) {
+                    torn += static_cast<const Circle*>(snap.find(id))->getRadius() != radius;
+                }
+                torn += snap.version() < last;
+                last = snap.version();
+            }
+        });
+    }
+    for (int v = 2; v < 300; ++v) {
+        for (std::uint64_t id : circles) {
+            batch.modify(id, [v](Figure &f) { static_cast<Circle&>(f).setRadius(v); });
+        }
+        collection.publish(batch);
+    }
+    done = true;
+    for (std::thread &t : readers) {
+        t.join();
+    }
+    if (torn != 0) {
+        throw "Reader saw a partially published batch";
+    }
+
+    std::cout << "\n=== All Snapshot Collection Tests Complete ===" << std::endl;
+}
+
+void test_figure_query() {
+    std::cout << "\n=== Testing Figure Query ===" << std::endl;
+
+    std::vector<std::unique_ptr<Figure>> owned;
+    for (int i = 0; i < 3000; ++i) {
+        Point center(10 + (i * 37) % 1000, 10 + (i * 91) % 1000);
+        switch (i % 5) {
+            case 0: owned.emplace_back(new Circle(1 + i % 7, center)); break;
+            case 1: owned.emplace_back(new Square(1 + i % 5, center)); break;
+            case 2: owned.emplace_back(new Rectangle(1 + i % 4, 2 + i % 3, center)); break;
+            case 3: owned.emplace_back(new Rhombus(2 + i % 3, static_cast<short>(10 + i % 70), center)); break;
+            default: owned.emplace_back(new Triangle({center, Point(center.getX() + 3, center.getY()), Point(center.getX(), center.getY() + 1 + i % 4)}));
+        }
+    }
+    std::vector<const Figure*> figures;
+    for (const auto &f : owned) {
+        figures.push_back(f.get());
+    }
+
+    FigureTable table(figures);
+    const BoundingBox window {100, 100, 300, 200};
+    Predicate bigCircles = isType(ShapeType::Circle) && field(Attribute::Area) > 20 && centerWithin(window);
+    Predicate thinRhombi = isType(ShapeType::Rhombus) && field(Attribute::Angle) < 30 && field(Attribute::Perimeter).between(8, 12);
+    Predicate mixed = (field(Attribute::Radius) >= 5 || !(field(Attribute::SideA) != 3)) && overlapping(window);
+
+    auto expect = [&](const Predicate &p, auto reference, const char *error) {
+        Selection s = table.select(p);
+        std::size_t matches = 0;
+        for (std::size_t i = 0; i < figures.size(); ++i) {
+            if (s.contains(i) != reference(*figures[i])) {
+                throw error;
+            }
+            matches += s.contains(i);
+        }
+        if (s.count() != matches || s.indices().size() != matches) {
+            throw "Selection count is wrong";
+        }
+        return s;
+    };
+    auto inWindow = [&](const Figure &f) {
+        return window.contains(Vec2 {double(f.getCenter().getX()), double(f.getCenter().getY())});
+    };
+    auto checkAll = [&]() {
+        Selection s = expect(bigCircles, [&](const Figure &f) {
+            return f.type() == ShapeType::Circle && f.area() > 20 && inWindow(f);
+        }, "Circle query is wrong");
+        expect(thinRhombi, [](const Figure &f) {
+            return f.type() == ShapeType::Rhombus && static_cast<const Rhombus&>(f).getAngle() < 30
+                && f.perimeter() >= 8 && f.perimeter() <= 12;
+        }, "Rhombus query is wrong");
+        expect(mixed, [&](const Figure &f) {
+            bool radius = f.type() == ShapeType::Circle && static_cast<const Circle&>(f).getRadius() >= 5;
+            bool side = (f.type() == ShapeType::Rectangle || f.type() == ShapeType::Square) && static_cast<const Rectangle&>(f).getA() == 3;
+            side |= f.type() == ShapeType::Rhombus && static_cast<const Rhombus&>(f).getA() == 3;
+            // The first side of every test triangle is 3 long, and ! also matches circles, which have no sides
+            side |= f.type() == ShapeType::Triangle || f.type() == ShapeType::Circle;
+            return (radius || side) && f.outline().bounds().overlaps(window);
+        }, "Combined query is wrong");
+        return s;
+    };
+
+    Selection scanned = checkAll();
+    table.buildIndex();
+    Selection pruned = checkAll();
+    std::cout << "Circles found: " << pruned.count() << ", rows scanned " << scanned.scanned() << " -> " << pruned.scanned() << std::endl;
+    if (!table.indexed() || pruned.scanned() >= scanned.scanned() || scanned.scanned() != figures.size()) {
+        throw "Box predicate was not pushed into the index";
+    }
+    if (table.select(centerWithin({0, 0, 5, 5}) && centerWithin({6, 6, 9, 9})).count() != 0) {
+        throw "Disjoint windows must select nothing";
+    }
+
+    // One long figure overlaps two windows that do not meet
+    std::vector<std::unique_ptr<Figure>> small;
+    std::vector<const Figure*> tallScene;
+    for (int i = 0; i < 400; ++i) {
+        small.push_back(std::make_unique<Rectangle>(2, 2, Point(10 + (i % 20) * 10, 110 + (i / 20) * 10)));
+        tallScene.push_back(small.back().get());
+    }
+    Rectangle tall(2, 200, Point(50, 150));
+    tallScene.push_back(&tall);
+    FigureTable tallTable(tallScene);
+    Predicate apart = overlapping({49, 50, 51, 51}) && overlapping({49, 240, 51, 241});
+    Predicate centerAndTop = centerWithin({45, 145, 55, 155}) && overlapping({49, 240, 51, 241});
+    std::size_t apartScan = tallTable.select(apart).count(), mixedScan = tallTable.select(centerAndTop).count();
+    tallTable.buildIndex();
+    if (apartScan != 1 || mixedScan != 1 || tallTable.select(apart).count() != 1 || tallTable.select(centerAndTop).count() != 1) {
+        throw "Overlap windows that do not meet must still select the figure overlapping both";
+    }
+
+    std::cout << "\n=== All Figure Query Tests Complete ===" << std::endl;
+}
+
+void test_quadtree() {
+    std::cout << "\n=== Testing Aggregate Quadtree ===" << std::endl;
+
+    AggregateQuadTree tree(BoundingBox {0, 0, 100, 100}, 4);
+    std::vector<std::unique_ptr<Circle>> circles;
+    std::vector<std::unique_ptr<Square>> squares;
+    std::vector<int> ids;
+    std::vector<Figure*> live;
+    for (int i = 0; i < 400; ++i) {
+        Point center((i * 37) % 100, (i * 53) % 100);
+        Figure *f;
+        if (i % 3 == 0) {
+            squares.emplace_back(new Square(1 + i % 4, center));
+            f = squares.back().get();
+        }
+        else {
+            circles.emplace_back(new Circle(1 + i % 5, center));
+            f = circles.back().get();
+        }
+        ids.push_back(tree.insert(*f));
+        live.push_back(f);
+    }
+
+    auto check = [&](const BoundingBox &box) {
+        RegionTotals expected;
+        for (Figure *f : live) {
+            if (f != nullptr && box.contains(Vec2 {double(f->getCenter().getX()), double(f->getCenter().getY())})) {
+                ++expected.count;
+                expected.area += f->area();
+                ++expected.types[static_cast<int>(f->type())];
+            }
+        }
+        RegionTotals actual = tree.query(box);
+        if (actual.count != expected.count || actual.types != expected.types || std::abs(actual.area - expected.area) > 1e-6) {
+            throw "Quadtree totals do not match the figures";
+        }
+        return actual;
+    };
+    auto checkWindows = [&]() {
+        for (int i = 0; i < 50; ++i) {
+            double x = (i * 13) % 90, y = (i * 29) % 90;
+            check(BoundingBox {x, y, x + 5 + i % 40, y + 3 + i % 50});
+        }
+        check(BoundingBox {-1000, -1000, 1000, 1000});
+    };
+
+    checkWindows();
+    RegionTotals all = check(BoundingBox {0, 0, 99, 99});
+    std::cout << "Figures: " << all.count << ", squares: " << all.types[static_cast<int>(ShapeType::Square)] << std::endl;
+    if (all.count != 400 || tree.size() != 400 || tree.totals().count != 400) {
+        throw "Quadtree lost figures";
+    }
+
+    // Moves within and across leaves, resizing, removals and growth beyond the initial bounds
+    for (int i = 0; i < 400; i += 3) {
+        Figure &f = tree.get(ids[i]);
+        f.setCenter(Point(f.getCenter().getX() + (i % 2), (f.getCenter().getY() * 7) % 100));
+        tree.update(ids[i]);
+    }
+    for (std::size_t i = 1; i < circles.size(); i += 4) {
+        circles[i]->setRadius(10);
+    }
+    for (int i = 0; i < 400; ++i) {
+        tree.update(ids[i]);
+    }
+    for (int i = 0; i < 400; i += 2) {
+        tree.remove(ids[i]);
+        live[i] = nullptr;
+    }
+    checkWindows();
+    tree.get(ids[1]).setCenter(Point(250, 300));
+    tree.update(ids[1]);
+    checkWindows();
+    if (tree.query(BoundingBox {200, 200, 300, 300}).count != 1 || tree.size() != 200) {
+        throw "Quadtree did not grow";
+    }
+
+    std::cout << "\n=== All Aggregate Quadtree Tests Complete ===" << std::endl;
+}
+
+void test_columnar_export() {
+    std::cout << "\n=== Testing Columnar Export ===" << std::endl;
+
+    std::vector<std::unique_ptr<Figure>> owned;
+    std::vector<const Figure*> figures;
+    for (int i = 0; i < 1003; ++i) {
+        if (i % 3 == 0) {
+            owned.emplace_back(new Circle(1 + i % 5, Point(i, 2 * i)));
+        }
+        else {
+            owned.emplace_back(new Rectangle(1 + i % 4, 2, Point(i, i % 7)));
+        }
+        figures.push_back(owned.back().get());
+    }
+
+    const std::string path = "/tmp/mw_columns_" + std::to_string(getpid()) + ".bin";
+    std::uint64_t bytes = ColumnarExport::write(path, figures, 2);
+    ColumnarFile file(path);
+    std::cout << "Exported " << file.rows() << " rows in " << file.columns() << " columns, " << bytes << " bytes" << std::endl;
+    if (file.rows() != figures.size() || file.columns() != 6 || bytes % 64 != 0) {
+        throw "Export header is wrong";
+    }
+
+    const std::uint8_t *type = file.column("type").values<std::uint8_t>();
+    const double *x = file.column("x").values<double>();
+    const double *area = file.column("area").values<double>();
+    const double *perimeter = file.column("perimeter").values<double>();
+    ColumnView radius = file.column("radius");
+    for (std::size_t i = 0; i < figures.size(); ++i) {
+        const Figure &f = *figures[i];
+        if (type[i] != static_cast<std::uint8_t>(f.type()) || x[i] != f.getCenter().getX() || area[i] != f.area()
+            || perimeter[i] != f.perimeter() || !file.column("area").valid(i)) {
+            throw "Exported values do not match the figures";
+        }
+        bool circle = f.type() == ShapeType::Circle;
+        if (radius.valid(i) != circle || (circle && radius.values<double>()[i] != static_cast<const Circle&>(f).getRadius())) {
+            throw "Radius column is wrong";
+        }
+    }
+    if (radius.nullCount() != 668 || reinterpret_cast<std::uintptr_t>(area) % 64 != 0) {
+        throw "Radius nulls or buffer alignment are wrong";
+    }
+
+    // Several chunks and a last chunk that ends inside a bitmap byte
+    Circle round(2, Point(5, 5));
+    Square block(3, Point(5, 5));
+    std::vector<const Figure*> many;
+    for (std::size_t i = 0; i < 2 * ColumnarExport::chunkRows + 5; ++i) {
+        many.push_back(i % 3 == 0 ? static_cast<const Figure*>(&round) : &block);
+    }
+    const std::string chunkedPath = path + ".chunks";
+    ColumnarExport::write(chunkedPath, many, 4);
+    ColumnarFile chunked(chunkedPath);
+    ColumnView chunkedArea = chunked.column("area");
+    ColumnView chunkedRadius = chunked.column("radius");
+    for (std::size_t boundary : {ColumnarExport::chunkRows, 2 * ColumnarExport::chunkRows, many.size()}) {
+        for (std::size_t i = boundary - 9; i < std::min(boundary + 9, many.size()); ++i) {
+            if (!chunkedArea.valid(i) || chunkedRadius.valid(i) != (i % 3 == 0)) {
+                throw "Validity bitmap is wrong at a chunk boundary";
+            }
+        }
+    }
+    if (chunkedArea.validity()[many.size() / 8] != 0x1f || chunkedRadius.nullCount() != many.size() - (many.size() + 2) / 3) {
+        throw "Validity bitmap of the last rows is wrong";
+    }
+    std::remove(chunkedPath.c_str());
+
+    bool rejected = false;
+    try {
+        radius.values<std::uint8_t>();
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Reading a column as the wrong type must fail";
+    }
+
+    std::remove(path.c_str());
+    std::cout << "\n=== All Columnar Export Tests Complete ===" << std::endl;
+}
+
+void test_workload() {
+    std::cout << "\n=== Testing Workload Generator ===" << std::endl;
+
+    WorkloadConfig config;
+    config.seed = 42;
+    config.count = 20000;
+    config.width = 10000;
+    config.height = 10000;
+    config.overlap = 2;
+    config.invalidShare = 0.1;
+
+    for (Distribution d : {Distribution::Uniform, Distribution::Clustered, Distribution::Zipf}) {
+        config.distribution = d;
+        WorkloadGenerator generator(config);
+        std::vector<ShapeSpec> specs = generator.specs(1);
+
+        // Every spec is accepted by its constructor exactly when it is marked valid
+        std::size_t invalid = 0;
+        for (const ShapeSpec &s : specs) {
+            bool built = true;
+            try {
+                WorkloadGenerator::build(s);
+            }
+            catch (const char*) {
+                built = false;
+            }
+            if (built != (s.valid != 0)) {
+                throw "Generated figure does not match its validity";
+            }
+            invalid += !built;
+        }
+        std::cout << "Distribution " << static_cast<int>(d) << ": " << invalid << " invalid of " << specs.size() << std::endl;
+        if (invalid < 1600 || invalid > 2400) {
+            throw "Share of invalid figures is wrong";
+        }
+
+        // The same scene comes out on any number of threads
+        std::vector<ShapeSpec> parallel(config.count);
+        WorkloadGenerator(config).generate(0, config.count, [&](std::uint64_t first, const ShapeSpec *s, std::size_t n) {
+            std::copy(s, s + n, parallel.begin() + first);
+        }, 3);
+        if (std::memcmp(specs.data(), parallel.data(), specs.size() * sizeof(ShapeSpec)) != 0) {
+            throw "Generated scene depends on the thread count";
+        }
+    }
+
+    config.mix = {1, 0, 0, 3, 0};
+    config.invalidShare = 0;
+    std::size_t rejected = 0;
+    std::vector<std::unique_ptr<Figure>> figures = WorkloadGenerator(config).figures(&rejected);
+    std::size_t squares = 0;
+    double area = 0;
+    for (const auto &f : figures) {
+        squares += f->type() == ShapeType::Square;
+        area += f->area();
+        if (f->type() != ShapeType::Circle && f->type() != ShapeType::Square) {
+            throw "Type mix is not respected";
+        }
+    }
+    std::cout << "Squares: " << squares << ", coverage " << area / 1e8 << std::endl;
+    if (rejected != 0 || figures.size() != config.count || squares < 14500 || squares > 15500 || area < 1e8 || area > 3e8) {
+        throw "Generated scene does not follow the parameters";
+    }
+
+    const std::string path = "/tmp/mw_workload_" + std::to_string(getpid()) + ".bin";
+    WorkloadGenerator generator(config);
+    generator.write(path, 2);
+    WorkloadFile file(path);
+    std::vector<ShapeSpec> block(1000);
+    if (file.size() != config.count || file.read(19500, block.data(), block.size()) != 500) {
+        throw "Workload file has the wrong size";
+    }
+    for (std::size_t i = 0; i < 500; ++i) {
+        ShapeSpec expected = generator.spec(19500 + i);
+        if (std::memcmp(&expected, &block[i], sizeof(ShapeSpec)) != 0) {
+            throw "Workload file records are wrong";
+        }
+    }
+    std::remove(path.c_str());
+
+    std::cout << "\n=== All Workload Generator Tests Complete ===" << std::endl;
+}
+
+void test_streaming() {
+    std::cout << "\n=== Testing Streaming ===" << std::endl;
+
+    WorkloadConfig workload;
+    workload.seed = 7;
+    workload.count = 25001;
+    workload.width = 5000;
+    workload.height = 5000;
+    workload.invalidShare = 0.2;
+    WorkloadGenerator generator(workload);
+    const std::string path = "/tmp/mw_stream_" + std::to_string(getpid()) + ".bin";
+    generator.write(path);
+    WorkloadFile file(path);
+
+    // Reference computed in memory
+    std::uint64_t valid = 0;
+    std::array<std::uint64_t, 5> types {};
+    double area = 0, perimeter = 0;
+    for (const ShapeSpec &s : generator.specs()) {
+        try {
+            std::unique_ptr<Figure> f = WorkloadGenerator::build(s);
+            ++valid;
+            ++types[static_cast<int>(f->type())];
+            area += f->area();
+            perimeter += f->perimeter();
+        }
+        catch (const char*) {
+        }
+    }
+
+    StreamConfig config;
+    config.blockShapes = 1000;
+    config.memoryBytes = 3 * 1000 * sizeof(ShapeSpec);
+    config.threads = 2;
+    StreamReport report = StreamProcessor::run(file, config);
+    std::cout << "Streamed " << report.shapes << " shapes in " << report.blocks << " blocks, "
+              << report.shapesPerSecond / 1e6 << " M shapes/s, " << report.megabytesPerSecond << " MB/s" << std::endl;
+    if (report.shapes != workload.count || report.blocks != 26 || report.valid != valid || report.invalid != workload.count - valid
+        || report.types != types || report.bufferBytes > config.memoryBytes) {
+        throw "Streamed counts are wrong";
+    }
+    if (std::abs(report.area - area) > 1e-9 * area || std::abs(report.perimeter - perimeter) > 1e-9 * perimeter) {
+        throw "Streamed sums are wrong";
+    }
+
+    // One thread gives bit-identical results
+    config.threads = 1;
+    StreamReport single = StreamProcessor::run(file, config);
+    if (single.area != report.area || single.perimeter != report.perimeter) {
+        throw "Streamed results depend on the thread count";
+    }
+    // More threads than buffers: finished blocks wait for earlier ones before they are merged
+    config.threads = 4;
+    config.memoryBytes = 2 * 1000 * sizeof(ShapeSpec);
+    StreamReport crowded = StreamProcessor::run(file, config);
+    if (crowded.valid != report.valid || crowded.types != report.types || crowded.area != report.area
+        || crowded.perimeter != report.perimeter || crowded.bufferBytes != config.memoryBytes) {
+        throw "Streamed results depend on the number of buffers";
+    }
+
+    bool rejected = false;
+    try {
+        config.memoryBytes = 1000 * sizeof(ShapeSpec);
+        StreamProcessor::run(file, config);
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Memory budget below two blocks must be rejected";
+    }
+
+    std::remove(path.c_str());
+    std::cout << "\n=== All Streaming Tests Complete ===" << std::endl;
+}
+
+void test_convex_hull() {
+    std::cout << "\n=== Testing Convex Hull ===" << std::endl;
+
+    // Square with interior, duplicate and collinear boundary points
+    std::vector<HullPoint> square = {{0, 0}, {10, 0}, {10, 10}, {0, 10}, {5, 5}, {5, 0}, {10, 10}, {0, 5}, {3, 7}};
+    HullPolygon hull = ConvexHull::chain(square);
+    if (hull.vertex.size() != 4 || hull.area() != 100 || hull.perimeter() != 40) {
+        throw "Convex hull of a square is wrong";
+    }
+    if (!(hull.vertex[0] == HullPoint{0, 0}) || !(hull.vertex[1] == HullPoint{10, 0})) {
+        throw "Convex hull vertices are not counter-clockwise from the lowest point";
+    }
+    std::vector<HullPoint> line = {{4, 4}, {0, 0}, {2, 2}, {8, 8}};
+    HullPolygon segment = ConvexHull::chain(line);
+    if (segment.vertex.size() != 2 || segment.area() != 0 || !segment.contains({2, 2}) || segment.contains({2, 3})) {
+        throw "Convex hull of collinear points must be a segment";
+    }
+    std::cout << "Square: " << hull.vertex.size() << " vertices, area " << hull.area() << std::endl;
+
+    // Parallel hull with the Akl-Toussaint filter against the serial chain
+    std::vector<HullPoint> points(300000);
+    std::uint64_t state = 42;
+    for (HullPoint &p : points) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::int64_t x = static_cast<std::int64_t>(state >> 40) % 200001 - 100000;
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::int64_t y = static_cast<std::int64_t>(state >> 40) % 200001 - 100000;
+        p = x * x + y * y <= 100000LL * 100000 ? HullPoint{x * 1000000, y * 1000000} : HullPoint{0, 0};
+    }
+    std::vector<HullPoint> serial = points;
+    HullPolygon reference = ConvexHull::chain(serial);
+    for (unsigned threads : {1u, 4u}) {
+        std::vector<HullPoint> copy = points;
+        if (ConvexHull::of(copy, threads).vertex != reference.vertex) {
+            throw "Parallel convex hull differs from the serial one";
+        }
+    }
+    std::vector<HullPoint> filtered = points;
+    std::size_t dropped = ConvexHull::filter(filtered);
+    for (std::size_t i = 0; i < reference.vertex.size(); ++i) {
+        const HullPoint &a = reference.vertex[i];
+        const HullPoint &b = reference.vertex[(i + 1) % reference.vertex.size()];
+        const HullPoint &c = reference.vertex[(i + 2) % reference.vertex.size()];
+        if (HullPolygon::cross(a, b, c) <= 0) {
+            throw "Convex hull is not strictly convex";
+        }
+        if (std::find(filtered.begin(), filtered.end(), a) == filtered.end()) {
+            throw "Akl-Toussaint filter dropped a hull vertex";
+        }
+    }
+    for (std::size_t i = 0; i < points.size(); i += 97) {
+        if (!reference.contains(points[i])) {
+            throw "Convex hull does not contain an input point";
+        }
+    }
+    std::cout << "Random: " << reference.vertex.size() << " vertices, filter dropped " << dropped << " of " << points.size() << std::endl;
+
+    // Envelope of figures: circle extents and polygon corners
+    Circle circle(5, Point(10, 10));
+    Square box(4, Point(30, 10));
+    Triangle triangle({Point(10, 30), Point(14, 30), Point(10, 34)});
+    std::vector<const Figure*> figures = {&circle, &box, &triangle};
+    HullPolygon envelope = ConvexHull::of(figures);
+    std::vector<HullPoint> expected = {{5, 7}, {7, 5}, {13, 5}, {32, 8}, {32, 12}, {10, 34}, {5, 13}};
+    if (envelope.vertex != expected) {
+        throw "Convex hull of figures is wrong";
+    }
+    // Every figure lies inside: a disc of the given radius stays left of every counter-clockwise edge
+    auto encloses = [](const HullPolygon &hull, const Vec2 &c, double radius) {
+        for (std::size_t i = 0; i < hull.vertex.size(); ++i) {
+            const HullPoint &a = hull.vertex[i];
+            const HullPoint &b = hull.vertex[(i + 1) % hull.vertex.size()];
+            double ex = double(b.x - a.x), ey = double(b.y - a.y);
+            if ((ex * (c.y - a.y) - ey * (c.x - a.x)) / std::sqrt(ex * ex + ey * ey) < radius - 1e-9) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (const Figure *f : figures) {
+        Outline o = f->outline();
+        if (o.isCircle && !encloses(envelope, o.center, o.radius)) {
+            throw "Convex hull of figures cuts off a circle";
+        }
+        for (int i = 0; i < o.size; ++i) {
+            if (!encloses(envelope, o.vertex[i], 0)) {
+                throw "Convex hull of figures cuts off a corner";
+            }
+        }
+    }
+    if (!encloses(envelope, {6.5, 6.5}, 0)) {
+        throw "Convex hull of figures misses a point of the circle";
+    }
+    // Slanted corners off the integer grid
+    for (int side = 1; side <= 60; ++side) {
+        for (short angle = 1; angle < 90; ++angle) {
+            Rhombus rhombus(side, angle, Point(100, 100));
+            HullPolygon hullOfRhombus = ConvexHull::of(std::vector<const Figure*> {&rhombus}, 1);
+            Outline o = rhombus.outline();
+            for (int i = 0; i < o.size; ++i) {
+                if (!encloses(hullOfRhombus, o.vertex[i], 0)) {
+                    throw "Convex hull of a rhombus cuts off a corner";
+                }
+            }
+        }
+    }
+    std::cout << "Figures: " << envelope.vertex.size() << " vertices, area " << envelope.area() << ", perimeter " << envelope.perimeter() << std::endl;
+
+    std::cout << "\n=== All Convex Hull Tests Complete ===" << std::endl;
+}
+
+void test_distance() {
+    std::cout << "\n=== Testing Figure Distance ===" << std::endl;
+
+    Circle small(2, Point(10, 10));
+    Circle large(3, Point(16, 18));
+    Square left(4, Point(30, 10));
+    Square right(2, Point(40, 11));
+    Triangle triangle({Point(50, 50), Point(60, 50), Point(50, 60)});
+    Square corner(2, Point(60, 60));
+    Rectangle wide(20, 2, Point(100, 100));
+    Rectangle tall(2, 20, Point(100, 100));
+    Circle inside(1, Point(100, 108));
+    auto near = [](double a, double b) { return std::abs(a - b) < 1e-9; };
+    if (!near(distance(small, large), 5) || !near(distance(left, right), 7) || !near(distance(small, left), 16)) {
+        throw "Distance between circles or squares is wrong";
+    }
+    if (!near(distance(triangle, corner), 8 / std::sqrt(2.0)) || !near(distance(corner, triangle), 8 / std::sqrt(2.0))) {
+        throw "Distance between triangle and square is wrong";
+    }
+    if (distance(wide, tall) != 0 || distance(tall, inside) != 0 || distance(wide, inside) != 6) {
+        throw "Distance between overlapping figures must be 0";
+    }
+    std::cout << "Triangle to square: " << distance(triangle, corner) << std::endl;
+
+    // Nearest other figure against brute force
+    WorkloadConfig workload;
+    workload.seed = 11;
+    workload.count = 3000;
+    workload.width = 20000;
+    workload.height = 20000;
+    workload.overlap = 0.02;
+    std::vector<std::unique_ptr<Figure>> owned = WorkloadGenerator(workload).figures();
+    std::vector<const Figure*> figures;
+    for (const std::unique_ptr<Figure> &f : owned) {
+        figures.push_back(f.get());
+    }
+    ProximityGrid grid(figures, 4);
+    std::vector<Neighbor> nearest = grid.allNearest(4);
+    std::size_t touching = 0;
+    for (std::size_t i = 0; i < figures.size(); ++i) {
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < figures.size(); ++j) {
+            if (j != i) {
+                best = std::min(best, distance(*figures[i], *figures[j]));
+            }
+        }
+        if (nearest[i].distance != best || nearest[i].index == i || distance(*figures[i], *nearest[i].figure) != best) {
+            throw "Nearest other figure differs from brute force";
+        }
+        touching += best == 0;
+    }
+    double smallest = std::numeric_limits<double>::infinity();
+    for (const Figure *f : figures) {
+        smallest = std::min(smallest, distance(small, *f));
+    }
+    if (grid.nearest(small).distance != smallest || grid.nearestOther(0).index != nearest[0].index) {
+        throw "Single nearest query differs from the batch";
+    }
+    std::cout << "Nearest other figure matches brute force for " << figures.size() << " figures, " << touching << " touching" << std::endl;
+
+    std::vector<const Figure*> single = {&small};
+    if (ProximityGrid(single).nearestOther(0).figure != nullptr || ProximityGrid({}).nearest(small).index != 0) {
+        throw "Figure without neighbors must have no nearest figure";
+    }
+    if (ProximityGrid(single).nearest(Circle(1, Point(10, 10))).distance != 0) {
+        throw "Single figure grid must find its figure";
+    }
+
+    // A figure across the first 2x2 cells is measured like any other
+    std::vector<std::unique_ptr<Figure>> dots;
+    std::vector<const Figure*> corner2x2;
+    for (int i = 0; i < 100; ++i) {
+        dots.emplace_back(new Square(2, Point(16 + 5 * (i % 10), 16 + 5 * (i / 10))));
+        corner2x2.push_back(dots.back().get());
+    }
+    Square big(12, Point(15, 15));
+    corner2x2.push_back(&big);
+    ProximityGrid cornerGrid(corner2x2);
+    Neighbor hit = cornerGrid.nearest(Circle(1, Point(11, 11)));
+    if (hit.index != 100 || hit.distance != 0) {
+        throw "Figure in the first grid cells was skipped";
+    }
+    std::vector<Neighbor> cornerNearest = cornerGrid.allNearest();
+    for (std::size_t i = 0; i < corner2x2.size(); ++i) {
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < corner2x2.size(); ++j) {
+            if (j != i) {
+                best = std::min(best, distance(*corner2x2[i], *corner2x2[j]));
+            }
+        }
+        if (cornerNearest[i].distance != best) {
+            throw "Nearest other figure near the grid corner differs from brute force";
+        }
+    }
+    bool rejected = false;
+    try {
+        grid.nearestOther(figures.size());
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    if (!rejected) {
+        throw "Index out of range must be rejected";
+    }
+
+    std::cout << "\n=== All Figure Distance Tests Complete ===" << std::endl;
+}
+
+void test_axis_rect() {
+    std::cout << "\n=== Testing Axis-Aligned Rectangles ===" << std::endl;
+
+    Rectangle fromCorners({Point(6,2), Point(1,5), Point(1,2), Point(6,5)});
+    AxisRect box {0, 0, 0, 0};
+    if (!fromCorners.isAxisAligned() || !fromCorners.toAxisRect(box) || box.minX != 1 || box.minY != 2 || box.maxX != 6 || box.maxY != 5) {
+        throw "Axis-aligned corners were not recognized";
+    }
+    Rectangle vertical({Point(1,5), Point(1,2), Point(6,5), Point(6,2)});
+    if (vertical.getA() != 3 || vertical.getB() != 5 || fromCorners.getA() != 5 || fromCorners.getB() != 3) {
+        throw "Axis-aligned sides must match the general corner check";
+    }
+    Outline a = box.outline(), b = fromCorners.outline();
+    for (int i = 0; i < 4; ++i) {
+        if (a.vertex[i].x != b.vertex[i].x || a.vertex[i].y != b.vertex[i].y) {
+            throw "Axis-aligned outline differs from the rectangle outline";
+        }
+    }
+    Rectangle rotated({Point(2,0), Point(4,2), Point(2,4), Point(0,2)});
+    if (rotated.isAxisAligned() || rotated.toAxisRect(box) || std::abs(rotated.area() - 8) > 1e-9) {
+        throw "Rotated rectangle must not be axis-aligned";
+    }
+    Rectangle centered(4, 6, Point(10, 10));
+    if (!centered.toAxisRect(box) || box.minX != 8 || box.minY != 7 || box.maxX != 12 || box.maxY != 13) {
+        throw "Rectangle from sides has wrong axis-aligned corners";
+    }
+    if (Rectangle(3, 5, Point(10, 10)).toAxisRect(box) || !Rectangle(3, 5, Point(10, 10)).isAxisAligned()) {
+        throw "Rectangle with half-integer corners has no integer representation";
+    }
+    bool rejected = false;
+    try {
+        Square notSquare({Point(1,1), Point(5,1), Point(5,3), Point(1,3)});
+    }
+    catch (const char*) {
+        rejected = true;
+    }
+    AxisRect duplicate {0, 0, 0, 0};
+    if (!rejected || AxisRect::fromCorners({Point(1,1), Point(1,1), Point(5,5), Point(1,5)}, duplicate)
+        || AxisRect::fromCorners({Point(1,1), Point(3,1), Point(5,1), Point(7,1)}, duplicate)) {
+        throw "Invalid axis-aligned corners must be rejected";
+    }
+
+    AxisRect window {10, 10, 20, 20};
+    if (!window.contains(Point(10, 20)) || window.contains(Point(21, 15)) || !window.overlaps({20, 0, 30, 10})
+        || window.overlaps({21, 0, 30, 30}) || !window.contains(AxisRect {12, 12, 20, 15}) || window.area() != 100) {
+        throw "Axis-aligned containment or overlap is wrong";
+    }
+    std::cout << "sizeof(Rectangle): " << sizeof(Rectangle) << ", sizeof(AxisRect): " << sizeof(AxisRect) << std::endl;
+    if (2 * sizeof(AxisRect) >= sizeof(Rectangle)) {
+        throw "Axis-aligned rectangle should take less than half the memory";
+    }
+
+    // Batch kernels against the scalar checks
+    std::vector<AxisRect> rects;
+    std::uint64_t state = 9;
+    auto next = [&state](int range) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((state >> 33) % range);
+    };
+    std::int64_t total = 0;
+    for (int i = 0; i < 10000; ++i) {
+        int x = next(1000), y = next(1000);
+        rects.push_back({x, y, x + 1 + next(50), y + 1 + next(50)});
+        total += std::int64_t(rects.back().width()) * rects.back().height();
+    }
+    AxisRectBlock block(rects);
+    std::vector<std::uint8_t> inside = containing(block, Point(500, 500));
+    std::vector<std::uint8_t> hit = overlapping(block, window);
+    std::size_t hits = 0;
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        if (inside[i] != rects[i].contains(Point(500, 500)) || hit[i] != rects[i].overlaps(window)) {
+            throw "Axis-aligned batch kernel differs from the scalar check";
+        }
+        hits += hit[i];
+    }
+    if (area(block, 0, block.size()) != total) {
+        throw "Axis-aligned batch area is wrong";
+    }
+    std::cout << "Block of " << block.size() << " rectangles, " << hits << " overlapping the window" << std::endl;
+
+    std::cout << "\n=== All Axis-Aligned Rectangle Tests Complete ===" << std::endl;
+}
+
 int main() {
 
     test_point_operators();
 
     test_figure();
 
+    test_float_figures();
+
+    test_rasterizer();
+
+    test_kdtree();
+
+    test_deduplicate();
+
+    test_dynamic_bvh();
+
+    test_triangle_mesh();
+
+    test_delaunay();
+
+    test_figure_view();
+
+    test_ranking();
+
+    test_circle_intersection();
+
+    test_clipping();
+
+    test_precision();
+
+    test_aggregates();
+
+    test_shared_store();
+
+    test_query_server();
+
+    test_snapshot_collection();
+
+    test_figure_query();
+
+    test_quadtree();
+
+    test_columnar_export();
+
+    test_workload();
+
+    test_streaming();
+
+    test_convex_hull();
+
+    test_distance();
+
+    test_axis_rect();
+
     return 0;
         
 }